@@ -2,143 +2,605 @@
 // Based on getreuer's achordion but simplified to avoid module system conflicts
 
 #include "achordion.h"
+#include "deadline.h"
+#ifdef KEY_TIMING_ENABLE
+#include "key_timing.h"
+#endif
+#ifdef CHORD_EXCEPTIONS_ENABLE
+#include "chord_exceptions.h"
+#endif
 
 #ifdef ACHORDION_TESTING
 #include "achordion_test.h"
 #endif
 
-// Internal state tracking
-static keyrecord_t tap_hold_record;
-static uint16_t tap_hold_keycode = KC_NO;
-static uint16_t hold_timer = 0;
-static bool pressed_another_key_before_release = false;
-
+// How a buffered event is replayed.
 enum {
-  STATE_RELEASED,
-  STATE_UNSETTLED,
-  STATE_RECURSING,
-} achordion_state = STATE_RELEASED;
-
-// Returns true if `pos` is on the left hand of the keyboard, false if right.
-static bool on_left_hand(keypos_t pos) {
-#ifdef SPLIT_KEYBOARD
-  return pos.row < MATRIX_ROWS / 2;
+  EVENT_PASS,     // Replayed as received.
+  EVENT_PENDING,  // Unsettled tap-hold press. Replay stops here.
+  EVENT_TAP,      // Tap-hold press settled as tap: tap press and release.
+  EVENT_HOLD,     // Tap-hold press settled as hold.
+};
+
+// Pointer-free copy of a keyrecord_t, as stored in the event buffer.
+typedef struct {
+  uint16_t time;
+#if defined(COMBO_ENABLE) || defined(REPEAT_KEY_ENABLE)
+  uint16_t keycode;
+#endif
+  uint8_t row;
+  uint8_t col;
+  uint8_t type : 3;
+  bool pressed : 1;
+  bool interrupted : 1;
+  uint8_t replay : 2;  // EVENT_*
+  uint8_t tap_count : 4;
+} achordion_event_t;
+
+_Static_assert((ACHORDION_EVENT_BUFFER_SIZE &
+                (ACHORDION_EVENT_BUFFER_SIZE - 1)) == 0 &&
+               ACHORDION_EVENT_BUFFER_SIZE <= 128,
+               "ACHORDION_EVENT_BUFFER_SIZE must be a power of 2, <= 128");
+
+// Events deferred to the main loop, oldest first. Indices run freely and are
+// masked on access.
+static achordion_event_t events[ACHORDION_EVENT_BUFFER_SIZE];
+static uint8_t events_head = 0;
+static uint8_t events_tail = 0;
+
+#define EVENT_AT(i) (&events[(uint8_t)(i) & (ACHORDION_EVENT_BUFFER_SIZE - 1)])
+
+// A tap-hold key that Achordion has intercepted and not yet settled.
+typedef struct {
+  uint8_t event;      // Index of its EVENT_PENDING press in the buffer.
+  uint16_t keycode;
+  deadline_token_t timeout;  // Settles the key as hold when it fires.
+  uint8_t eager_mods; // Mods applied on press, withdrawn if it settles as tap.
+  uint8_t policy;     // ACHORDION_SETTLE_ON_*
+} pending_key_t;
+
+// Pending keys in press order.
+static pending_key_t pending[ACHORDION_MAX_PENDING];
+static uint8_t pending_count = 0;
+static bool replaying = false;
+
+// Time of the last key press that counts as typing: not a tap-hold press,
+// or one settled as tap. Cleared by a hold.
+static uint16_t last_press_time = 0;
+static bool streak = false;
+
+static achordion_counters_t counters;
+
+// Keys settled as tap while still down. Their press is replayed with its
+// release, so the physical release must not follow as a hold release.
+static matrix_row_t tapped[MATRIX_ROWS];
+
+static void set_tapped(uint8_t row, uint8_t col) {
+  if (row < MATRIX_ROWS && col < MATRIX_COLS) {
+    tapped[row] |= (matrix_row_t)1 << col;
+  }
+}
+
+// Returns true, and forgets it, if the key at `pos` was settled as tap.
+static bool take_tapped(keypos_t pos) {
+  if (pos.row >= MATRIX_ROWS || pos.col >= MATRIX_COLS ||
+      !((tapped[pos.row] >> pos.col) & 1)) {
+    return false;
+  }
+  tapped[pos.row] &= ~((matrix_row_t)1 << pos.col);
+  return true;
+}
+
+#ifndef CHORD_EXCEPTIONS_ENABLE
+// Hand of the key at `pos`: 'L', 'R' or '*' ('*' in chordal_hold_layout:
+// thumbs, usable with either hand). Keys outside the matrix, like combos,
+// are on neither.
+static char hand_of(keypos_t pos) {
+  if (pos.row >= MATRIX_ROWS || pos.col >= MATRIX_COLS) {
+    return '*';
+  }
+#ifdef CHORDAL_HOLD
+  return (char)pgm_read_byte(&chordal_hold_layout[pos.row][pos.col]);
+#elif defined(SPLIT_KEYBOARD)
+  return pos.row < MATRIX_ROWS / 2 ? 'L' : 'R';
 #else
-  return (MATRIX_COLS > MATRIX_ROWS) ? pos.col < MATRIX_COLS / 2
-                                     : pos.row < MATRIX_ROWS / 2;
+  return ((MATRIX_COLS > MATRIX_ROWS) ? pos.col < MATRIX_COLS / 2
+                                      : pos.row < MATRIX_ROWS / 2)
+             ? 'L'
+             : 'R';
 #endif
 }
+#endif
 
+// With CHORD_EXCEPTIONS_ENABLE, hands come from the generated chord_hands,
+// where keys may go with either hand for Achordion only.
 bool achordion_opposite_hands(const keyrecord_t* tap_hold_record,
                               const keyrecord_t* other_record) {
-  return on_left_hand(tap_hold_record->event.key) !=
-         on_left_hand(other_record->event.key);
+  const keypos_t a = tap_hold_record->event.key;
+  const keypos_t b = other_record->event.key;
+#ifdef CHORD_EXCEPTIONS_ENABLE
+  return !chord_same_hand(a, b);
+#else
+  const char hand = hand_of(a);
+  return hand == '*' || hand != hand_of(b);
+#endif
 }
 
-// Default chord function - hold only if opposite hands
+// Default chord function - hold only if opposite hands, or if the chord is
+// one of the same-hand exceptions in chord_exceptions.json
 __attribute__((weak)) bool achordion_chord(uint16_t tap_hold_keycode,
                                            keyrecord_t* tap_hold_record,
                                            uint16_t other_keycode,
                                            keyrecord_t* other_record) {
+  (void)tap_hold_keycode;
+  (void)other_keycode;
+#ifdef CHORD_EXCEPTIONS_ENABLE
+  if (chord_exception(tap_hold_record->event.key, other_record->event.key)) {
+    return true;
+  }
+#endif
   return achordion_opposite_hands(tap_hold_record, other_record);
 }
 
 // Default timeout
 __attribute__((weak)) uint16_t achordion_timeout(uint16_t tap_hold_keycode) {
+  (void)tap_hold_keycode;
   return 1000;
 }
 
+// Default settle policy: decide on the next key press
+__attribute__((weak)) uint8_t achordion_settle_policy(
+    uint16_t tap_hold_keycode) {
+  (void)tap_hold_keycode;
+  return ACHORDION_SETTLE_ON_PRESS;
+}
+
+// Default typing streak window, the same on every layer
+__attribute__((weak)) uint16_t achordion_streak_timeout(
+    uint16_t tap_hold_keycode, uint8_t layer) {
+  (void)tap_hold_keycode;
+  (void)layer;
+  return ACHORDION_STREAK_TIMEOUT;
+}
+
 // Default eager mod behavior
 __attribute__((weak)) bool achordion_eager_mod(uint8_t mod) {
   return (mod & (MOD_LALT | MOD_LGUI)) == 0;
 }
 
+// Per-key timing. With KEY_TIMING_ENABLE it comes from the tables generated
+// from key_timing.json, by position and layer, instead of the callbacks.
+static uint16_t timeout_of(uint16_t keycode, const keyrecord_t* record) {
+#ifdef KEY_TIMING_ENABLE
+  (void)keycode;
+  return key_timing_achordion_timeout(record->event);
+#else
+  (void)record;
+  return achordion_timeout(keycode);
+#endif
+}
+
+static uint8_t settle_policy_of(uint16_t keycode, const keyrecord_t* record) {
+#ifdef KEY_TIMING_ENABLE
+  (void)keycode;
+  return key_timing_achordion_settle_policy(record->event);
+#else
+  (void)record;
+  return achordion_settle_policy(keycode);
+#endif
+}
+
+static uint16_t streak_timeout_of(uint16_t keycode, const keyrecord_t* record) {
+#ifdef KEY_TIMING_ENABLE
+  (void)keycode;
+  return key_timing_achordion_streak_timeout(record->event);
+#else
+  (void)record;
+  return achordion_streak_timeout(
+      keycode, get_highest_layer(layer_state | default_layer_state));
+#endif
+}
+
+static void pack_event(achordion_event_t* event, const keyrecord_t* record,
+                       uint8_t replay) {
+  event->time = record->event.time;
+#if defined(COMBO_ENABLE) || defined(REPEAT_KEY_ENABLE)
+  event->keycode = record->keycode;
+#endif
+  event->row = record->event.key.row;
+  event->col = record->event.key.col;
+  event->type = record->event.type;
+  event->pressed = record->event.pressed;
+  event->interrupted = record->tap.interrupted;
+  event->tap_count = record->tap.count;
+  event->replay = replay;
+}
+
+static keyrecord_t unpack_event(const achordion_event_t* event) {
+  keyrecord_t record = {
+      .event =
+          {
+              .key = {.col = event->col, .row = event->row},
+              .time = event->time,
+              .type = event->type,
+              .pressed = event->pressed,
+          },
+      .tap =
+          {
+              .interrupted = event->interrupted,
+              .count = event->tap_count,
+          },
+#if defined(COMBO_ENABLE) || defined(REPEAT_KEY_ENABLE)
+      .keycode = event->keycode,
+#endif
+  };
+  return record;
+}
+
+static bool events_full(void) {
+  return (uint8_t)(events_tail - events_head) == ACHORDION_EVENT_BUFFER_SIZE;
+}
+
+// Sends buffered events through the rest of QMK, oldest first, stopping at
+// the first tap-hold press that is still unsettled.
+static void replay_events(void) {
+  replaying = true;
+  while (events_head != events_tail) {
+    const achordion_event_t* event = EVENT_AT(events_head);
+    if (event->replay == EVENT_PENDING) {
+      break;
+    }
+
+    keyrecord_t record = unpack_event(event);
+    if (event->replay == EVENT_TAP) {
+      record.tap.count = 1;
+      process_record(&record);
+      record.event.pressed = false;
+    }
+    process_record(&record);
+    ++events_head;
+  }
+  replaying = false;
+}
+
+_Static_assert(DEADLINE_MAX > ACHORDION_MAX_PENDING,
+               "DEADLINE_MAX must leave room for every pending key");
+
+static void remove_pending(uint8_t i) {
+  --pending_count;
+  memmove(pending + i, pending + i + 1,
+          (pending_count - i) * sizeof(pending_key_t));
+}
+
+// Histogram bucket of a settle `latency` ms after the press: its number of
+// significant bits. One CLZ instruction on ARM. Counted in unsigned long,
+// which is 32 bits even where int is 16, as on AVR.
+static uint8_t latency_bucket(uint16_t latency) {
+  const uint8_t bits =
+      latency ? 8 * sizeof(unsigned long) - __builtin_clzl(latency) : 0;
+  return bits < ACHORDION_LATENCY_BUCKETS ? bits
+                                          : ACHORDION_LATENCY_BUCKETS - 1;
+}
+
+// Counts a settle, `latency` ms after the press.
+static void count_settle(uint8_t replay, uint16_t latency) {
+  if (replay == EVENT_TAP) {
+    ++counters.taps;
+  } else {
+    ++counters.holds;
+  }
+
+  const uint8_t bucket = latency_bucket(latency);
+  if (counters.latency[bucket] == UINT16_MAX) {
+    for (uint8_t b = 0; b < ACHORDION_LATENCY_BUCKETS; ++b) {
+      counters.latency[b] >>= 1;
+    }
+  }
+  ++counters.latency[bucket];
+}
+
+// Counts a key press at `time` toward the typing streak.
+static void streak_press(uint16_t time) {
+  if (!streak || (int16_t)(time - last_press_time) > 0) {
+    last_press_time = time;
+  }
+  streak = true;
+}
+
+static void settle(uint8_t i, uint8_t replay, bool interrupted) {
+  achordion_event_t* event = EVENT_AT(pending[i].event);
+  count_settle(replay, timer_read() - event->time);
+  event->replay = replay;
+  event->interrupted = interrupted;
+  if (replay == EVENT_TAP && pending[i].eager_mods) {
+    unregister_mods(pending[i].eager_mods);
+  }
+  deadline_cancel(pending[i].timeout);
+  remove_pending(i);
+  if (replay == EVENT_HOLD) {
+    streak = false;  // Holding a mod or layer is not typing.
+  } else {
+    streak_press(event->time);
+  }
+}
+
+// Decides an unsettled key against another key press.
+static void settle_by_chord(uint8_t i, uint16_t other_keycode,
+                            keyrecord_t* other_record) {
+  keyrecord_t tap_hold_record = unpack_event(EVENT_AT(pending[i].event));
+  if (achordion_chord(pending[i].keycode, &tap_hold_record, other_keycode,
+                      other_record)) {
+    settle(i, EVENT_HOLD, false);
+  } else {
+    ++counters.same_hand;
+    const achordion_event_t* event = EVENT_AT(pending[i].event);
+    set_tapped(event->row, event->col);
+    settle(i, EVENT_TAP, true);
+  }
+}
+
+// Deadline callback: the key's timeout expired, settle as hold. `arg` holds
+// the buffer index of the key's press.
+static void on_timeout(uint32_t deadline, void* arg) {
+  (void)deadline;
+  const uint8_t event = (uint8_t)(uintptr_t)arg;
+  for (uint8_t i = 0; i < pending_count; ++i) {
+    if (pending[i].event == event) {
+      pending[i].timeout = DEADLINE_INVALID;  // Already fired.
+      ++counters.timeouts;
+      settle(i, EVENT_HOLD, false);
+      return;
+    }
+  }
+}
+
+static int8_t find_pending(keypos_t pos) {
+  for (uint8_t i = 0; i < pending_count; ++i) {
+    const achordion_event_t* event = EVENT_AT(pending[i].event);
+    if (event->row == pos.row && event->col == pos.col) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Returns true if the buffer still holds an event for the key at `pos`.
+static bool buffered(keypos_t pos) {
+  for (uint8_t i = events_head; i != events_tail; ++i) {
+    const achordion_event_t* event = EVENT_AT(i);
+    if (event->row == pos.row && event->col == pos.col) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Settles the keys waiting for a release that were pressed before the
+// buffered press of the key at `pos`, which is now being released. That key
+// may be a tap-hold key itself, already settled.
+static void settle_on_release(uint16_t keycode, keypos_t pos) {
+  uint8_t press = events_tail;
+  for (uint8_t i = events_head; i != events_tail; ++i) {
+    const achordion_event_t* event = EVENT_AT(i);
+    if (event->pressed && event->replay != EVENT_PENDING &&
+        event->row == pos.row && event->col == pos.col) {
+      press = i;
+    }
+  }
+  if (press == events_tail) {
+    return;
+  }
+
+  keyrecord_t other_record = unpack_event(EVENT_AT(press));
+  for (uint8_t i = 0; i < pending_count;) {
+    if ((uint8_t)(pending[i].event - events_head) <
+        (uint8_t)(press - events_head)) {
+      settle_by_chord(i, keycode, &other_record);
+    } else {
+      ++i;
+    }
+  }
+}
+
+// Settles as hold the keys waiting for a press that chord with a tap-hold
+// press, so a stack of mods across hands holds as each next one goes down.
+// The others stay pending: a same-hand key may be rolled or stacked, which
+// only the next key or a release tells apart.
+static void settle_held_by_press(uint16_t keycode, keyrecord_t* record) {
+  for (uint8_t i = 0; i < pending_count;) {
+    keyrecord_t tap_hold_record = unpack_event(EVENT_AT(pending[i].event));
+    if (pending[i].policy == ACHORDION_SETTLE_ON_PRESS &&
+        achordion_chord(pending[i].keycode, &tap_hold_record, keycode,
+                        record)) {
+      settle(i, EVENT_HOLD, false);
+    } else {
+      ++i;
+    }
+  }
+}
+
+// Settles pending key `i`, released before anything decided it, as tap. It
+// turns out to be an ordinary key, pressed and released while the keys
+// pending ahead of it were down, so it decides all of them: those settling
+// on press by its press, and those waiting for a release by this one.
+static void settle_tap_released(uint8_t i) {
+  keyrecord_t press = unpack_event(EVENT_AT(pending[i].event));
+  const uint16_t keycode = pending[i].keycode;
+  while (i > 0) {
+    settle_by_chord(0, keycode, &press);
+    --i;
+  }
+  settle(i, EVENT_TAP, false);
+}
+
+// Returns true if a tap-hold press comes within the typing streak window of
+// the previous key press.
+static bool in_typing_streak(uint16_t keycode, const keyrecord_t* record) {
+  if (!streak) {
+    return false;
+  }
+  const uint16_t window = streak_timeout_of(keycode, record);
+  return window > 0 &&
+         (uint16_t)(record->event.time - last_press_time) < window;
+}
+
+// Appends an event to the buffer. If it is full, which takes a long burst
+// of input while a key is unsettled, the oldest key is settled as hold and
+// the buffer is drained here rather than dropping anything.
+static uint8_t push_event(const keyrecord_t* record, uint8_t replay) {
+  while (events_full()) {
+    if (pending_count > 0) {
+      settle(0, EVENT_HOLD, false);
+    }
+    replay_events();
+  }
+  const uint8_t i = events_tail++;
+  pack_event(EVENT_AT(i), record, replay);
+  return i;
+}
+
 // Main processing function
 bool process_record_achordion(uint16_t keycode, keyrecord_t* record) {
-  // Don't process events that Achordion generated
-  if (achordion_state == STATE_RECURSING) {
+  // Don't process events that Achordion is replaying
+  if (replaying) {
     return true;
   }
 
   const bool is_tap_hold = IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode);
   const bool is_key_event = IS_KEYEVENT(record->event);
 
-  // Event while no tap-hold key is active
-  if (achordion_state == STATE_RELEASED) {
-    if (is_tap_hold && record->tap.count == 0 && record->event.pressed && is_key_event) {
-      const uint16_t timeout = achordion_timeout(keycode);
-      if (timeout > 0) {
-        achordion_state = STATE_UNSETTLED;
-        tap_hold_keycode = keycode;
-        tap_hold_record = *record;
-        hold_timer = record->event.time + timeout;
-        pressed_another_key_before_release = false;
-        return false;  // Skip default handling
+  if (!record->event.pressed) {
+    const int8_t i = find_pending(record->event.key);
+    if (i >= 0) {
+      // Released before anything decided it: a plain tap. The release is
+      // replayed as part of the tap.
+      settle_tap_released(i);
+      return false;
+    }
+    // A key settled as tap was released in its replay: drop this one. Keep
+    // any other release behind its own press if that is still buffered.
+    const bool was_tapped = take_tapped(record->event.key);
+    if (was_tapped || buffered(record->event.key)) {
+      settle_on_release(keycode, record->event.key);
+      if (!was_tapped) {
+        push_event(record, EVENT_PASS);
       }
+      return false;
     }
     return true;
   }
 
-  // Handle tap-hold key release
-  if (keycode == tap_hold_keycode && !record->event.pressed) {
-    achordion_state = STATE_RELEASED;
-    tap_hold_keycode = KC_NO;
-    return false;
+  // A tap-hold key that QMK considers held is intercepted.
+  const uint16_t timeout =
+      (is_tap_hold && record->tap.count == 0 && is_key_event)
+          ? timeout_of(keycode, record)
+          : 0;
+  const bool streak_tap = timeout > 0 && in_typing_streak(keycode, record);
+  // A tap-hold press that waits to be settled only counts once it settles
+  // as tap, so a held mod does not start a streak for the keys under it.
+  if (is_key_event && (timeout == 0 || streak_tap)) {
+    streak_press(record->event.time);
+  }
+
+  // The key joins the table, even while other keys are unsettled, so a roll
+  // or a stack of home row mods is tracked key by key instead of letting the
+  // second key skip the chord logic. Mid-word, it settles as tap right away
+  // and is handled like any other key.
+  if (timeout > 0 && !streak_tap) {
+    settle_held_by_press(keycode, record);
+    // Buffered first: a full buffer settles the oldest key, which moves the
+    // table down.
+    const uint8_t event = push_event(record, EVENT_PENDING);
+    if (pending_count == ACHORDION_MAX_PENDING) {
+      // Table is full: this press decides the oldest key, like any other
+      // key would, making room without dropping or delaying anything.
+      settle_by_chord(0, keycode, record);
+    }
+
+    pending_key_t* key = &pending[pending_count++];
+    key->event = event;
+    key->keycode = keycode;
+    // Count the timeout from the press, which QMK may have held back a while.
+    const uint16_t elapsed = timer_read() - record->event.time;
+    key->timeout = deadline_schedule(timer_read32() - elapsed + timeout,
+                                     on_timeout, (void*)(uintptr_t)key->event);
+    key->eager_mods = 0;
+    key->policy = settle_policy_of(keycode, record);
+
+    if (IS_QK_MOD_TAP(keycode)) {
+      // Apply mods immediately if they are "eager."
+      const uint8_t mod = mod_config(QK_MOD_TAP_GET_MODS(keycode));
+      if (achordion_eager_mod(mod)) {
+        key->eager_mods = (mod & 0x10) ? (mod & 0x0f) << 4 : mod;
+        register_mods(key->eager_mods);
+      }
+    }
+    return false;  // Skip default handling
   }
 
-  // Handle other key press while tap-hold is unsettled
-  if (achordion_state == STATE_UNSETTLED && record->event.pressed && keycode != tap_hold_keycode) {
-    pressed_another_key_before_release = true;
-    
-    if (achordion_chord(tap_hold_keycode, &tap_hold_record, keycode, record)) {
-      // Settle as hold
-      achordion_state = STATE_RECURSING;
-      process_record(&tap_hold_record);
-      achordion_state = STATE_RELEASED;
-      tap_hold_keycode = KC_NO;
+  if (streak_tap) {
+    ++counters.streak_taps;
+    set_tapped(record->event.key.row, record->event.key.col);
+  } else if (events_head == events_tail) {
+    return true;
+  }
+
+  // Another key is pressed: it decides every unsettled key, except those
+  // waiting for a release. Its press is buffered behind them meanwhile.
+  for (uint8_t i = 0; i < pending_count;) {
+    if (pending[i].policy == ACHORDION_SETTLE_ON_PRESS) {
+      settle_by_chord(i, keycode, record);
     } else {
-      // Settle as tap
-      achordion_state = STATE_RECURSING;
-      tap_hold_record.event.pressed = true;
-      tap_hold_record.tap.count = 1;
-      tap_hold_record.tap.interrupted = true;
-      process_record(&tap_hold_record);
-      
-      tap_hold_record.event.pressed = false;
-      process_record(&tap_hold_record);
-      achordion_state = STATE_RELEASED;
-      tap_hold_keycode = KC_NO;
-    }
-    
-    // Re-process the current event
-    achordion_state = STATE_RECURSING;
-    process_record(record);
-    achordion_state = STATE_RELEASED;
-    return false;
+      ++i;
+    }
   }
 
-  return true;
+  // Queue the current event behind the settled keys
+  push_event(record, streak_tap ? EVENT_TAP : EVENT_PASS);
+  return false;
 }
 
-// Housekeeping task for timeouts
+// Housekeeping task for replaying settled events. Timeouts are settled by
+// deadline_task(), which must run first in the same main loop iteration.
 void housekeeping_task_achordion(void) {
-  if (achordion_state == STATE_UNSETTLED &&
-      timer_expired(timer_read(), hold_timer)) {
-    // Timeout expired, settle as hold
-    achordion_state = STATE_RECURSING;
-    process_record(&tap_hold_record);
-    achordion_state = STATE_RELEASED;
-    tap_hold_keycode = KC_NO;
+  if (events_head != events_tail) {
+    replay_events();
   }
 }
 
+const achordion_counters_t* achordion_get_counters(void) {
+  return &counters;
+}
+
 #ifdef ACHORDION_TESTING
 // Test helper function to reset state
 void reset_achordion_state_for_testing(void) {
-    achordion_state = STATE_RELEASED;
-    tap_hold_keycode = KC_NO;
-    hold_timer = 0;
-    pressed_another_key_before_release = false;
-    memset(&tap_hold_record, 0, sizeof(tap_hold_record));
+    for (uint8_t i = 0; i < pending_count; ++i) {
+        deadline_cancel(pending[i].timeout);
+    }
+    pending_count = 0;
+    events_head = events_tail = 0;
+    replaying = false;
+    streak = false;
+    memset(&counters, 0, sizeof(counters));
+    memset(pending, 0, sizeof(pending));
+    memset(events, 0, sizeof(events));
+    memset(tapped, 0, sizeof(tapped));
+}
+
+uint8_t achordion_pending_count_for_testing(void) {
+    return pending_count;
+}
+
+uint16_t achordion_pending_keycode_for_testing(uint8_t index) {
+    return index < pending_count ? pending[index].keycode : KC_NO;
+}
+
+uint8_t achordion_buffered_events_for_testing(void) {
+    return (uint8_t)(events_tail - events_head);
+}
+
+uint8_t achordion_latency_bucket_for_testing(uint16_t latency) {
+    return latency_bucket(latency);
 }
 #endif
@@ -2,25 +2,82 @@
 
 #include "quantum.h"
 
+// Maximum number of tap-hold keys that can be unsettled at the same time.
+#ifndef ACHORDION_MAX_PENDING
+#define ACHORDION_MAX_PENDING 4
+#endif
+
+// Capacity of the buffer of events deferred to the main loop (power of 2).
+#ifndef ACHORDION_EVENT_BUFFER_SIZE
+#define ACHORDION_EVENT_BUFFER_SIZE 16
+#endif
+
+// Default typing streak window in ms: a tap-hold key pressed within this long
+// of the previous key press settles as tap immediately. 0 disables it.
+#ifndef ACHORDION_STREAK_TIMEOUT
+#define ACHORDION_STREAK_TIMEOUT 100
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// When an unsettled key is decided against another key
+enum achordion_settle_policy {
+  ACHORDION_SETTLE_ON_PRESS,    // As soon as another key is pressed
+  ACHORDION_SETTLE_ON_RELEASE,  // When that key, or the tap-hold key, is released
+};
+
+// Buckets of the settle latency histogram. Bucket 0 counts 0 ms, bucket b
+// counts [2^(b-1), 2^b) ms, and the last one everything above.
+#ifndef ACHORDION_LATENCY_BUCKETS
+#define ACHORDION_LATENCY_BUCKETS 12
+#endif
+
+// Decision counters, for tuning
+typedef struct {
+  uint32_t taps;         // Settled as tap
+  uint32_t holds;        // Settled as hold, including by timeout
+  uint32_t timeouts;     // Settled as hold by timeout
+  uint32_t same_hand;    // Settled as tap because achordion_chord() said no
+  uint32_t streak_taps;  // Tap-hold presses settled as tap by a typing streak
+  // Time from the tap-hold press to its settle, log2 buckets. All buckets are
+  // halved when one would overflow, which keeps the shape.
+  uint16_t latency[ACHORDION_LATENCY_BUCKETS];
+} achordion_counters_t;
+
 // Main Achordion processing function
 bool process_record_achordion(uint16_t keycode, keyrecord_t* record);
 
-// Housekeeping task for timeouts
+// Housekeeping task. Settled events are replayed from here, in the main
+// loop, rather than from inside process_record_achordion. Timeouts come from
+// the deadline scheduler: call deadline_task() before this.
 void housekeeping_task_achordion(void);
 
-// Callback functions (can be overridden in keymap.c)
+// Callback functions (can be overridden in keymap.c). With KEY_TIMING_ENABLE,
+// timeouts and settle policies come from key_timing.json instead.
 bool achordion_chord(uint16_t tap_hold_keycode, keyrecord_t* tap_hold_record,
                      uint16_t other_keycode, keyrecord_t* other_record);
 
 uint16_t achordion_timeout(uint16_t tap_hold_keycode);
 
+// Settle policy for `tap_hold_keycode`. Defaults to ACHORDION_SETTLE_ON_PRESS.
+uint8_t achordion_settle_policy(uint16_t tap_hold_keycode);
+
+// Typing streak window for `tap_hold_keycode` on `layer`, in ms. 0 disables.
+uint16_t achordion_streak_timeout(uint16_t tap_hold_keycode, uint8_t layer);
+
+// Returns true if `mod` (5-bit mod-tap encoding) is applied as soon as its
+// key goes down, before it settles. Withdrawn if the key settles as tap.
 bool achordion_eager_mod(uint8_t mod);
 
-// Utility function for opposite hands detection
+// Counters since power-up
+const achordion_counters_t* achordion_get_counters(void);
+
+// Returns false only if both keys are on the same hand, as declared by
+// chordal_hold_layout with CHORDAL_HOLD. Keys marked '*' go with either hand.
+// With CHORD_EXCEPTIONS_ENABLE, the hands come from the generated
+// chord_hands instead.
 bool achordion_opposite_hands(const keyrecord_t* tap_hold_record,
                               const keyrecord_t* other_record);
 
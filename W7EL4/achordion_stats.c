@@ -0,0 +1,52 @@
+// achordion_stats.c — Achordion counters over the Oryx raw HID channel
+
+#include "achordion_stats.h"
+#include "achordion.h"
+
+#ifdef RAW_ENABLE
+#include "raw_hid.h"
+#endif
+
+_Static_assert(3 + 2 * ACHORDION_LATENCY_BUCKETS <= ACHORDION_STATS_REPORT_SIZE,
+               "Latency histogram does not fit in one report");
+
+static uint8_t* put32(uint8_t* p, uint32_t value) {
+  p[0] = value;
+  p[1] = value >> 8;
+  p[2] = value >> 16;
+  p[3] = value >> 24;
+  return p + 4;
+}
+
+void achordion_stats_pack(uint8_t page, uint8_t* report) {
+  const achordion_counters_t* counters = achordion_get_counters();
+  memset(report, 0, ACHORDION_STATS_REPORT_SIZE);
+  report[0] = ACHORDION_STATS_EVENT;
+  report[1] = page;
+
+  uint8_t* p = report + 2;
+  if (page == ACHORDION_STATS_PAGE_COUNTERS) {
+    p = put32(p, counters->taps);
+    p = put32(p, counters->holds);
+    p = put32(p, counters->timeouts);
+    p = put32(p, counters->same_hand);
+    put32(p, counters->streak_taps);
+  } else if (page == ACHORDION_STATS_PAGE_LATENCY) {
+    *p++ = ACHORDION_LATENCY_BUCKETS;
+    for (uint8_t b = 0; b < ACHORDION_LATENCY_BUCKETS; ++b) {
+      *p++ = counters->latency[b];
+      *p++ = counters->latency[b] >> 8;
+    }
+  }
+}
+
+bool achordion_stats_receive(uint8_t* data, uint8_t length) {
+  if (length < ACHORDION_STATS_REPORT_SIZE || data[0] != ACHORDION_STATS_EVENT) {
+    return false;
+  }
+  achordion_stats_pack(data[1], data);
+#ifdef RAW_ENABLE
+  raw_hid_send(data, length);
+#endif
+  return true;
+}
@@ -0,0 +1,49 @@
+// achordion_stats.h — Achordion counters over the Oryx raw HID channel
+//
+// The counters and the settle latency histogram are read by a raw HID host
+// one page at a time: it sends a request and gets the page back as the
+// reply, in place, the way VIA answers its commands. Nothing is sent
+// unasked. No console needed.
+//
+// Request, 32 bytes:
+//   [0]  ACHORDION_STATS_EVENT
+//   [1]  Page
+//
+// Reply, 32 bytes, integers little-endian:
+//   [0]  ACHORDION_STATS_EVENT
+//   [1]  Page
+//   Page ACHORDION_STATS_PAGE_COUNTERS:
+//   [2]  taps, holds, timeouts, same_hand, streak_taps: 5 x uint32
+//   Page ACHORDION_STATS_PAGE_LATENCY:
+//   [2]  Number of buckets, N
+//   [3]  N x uint16 buckets, see achordion_counters_t
+
+#pragma once
+
+#include "quantum.h"
+
+// Event id, outside the range Oryx uses for its own events.
+#define ACHORDION_STATS_EVENT 0xAC
+#define ACHORDION_STATS_REPORT_SIZE 32
+
+enum achordion_stats_page {
+  ACHORDION_STATS_PAGE_COUNTERS,
+  ACHORDION_STATS_PAGE_LATENCY,
+  ACHORDION_STATS_PAGES,
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Fills `report` (ACHORDION_STATS_REPORT_SIZE bytes) with `page`.
+void achordion_stats_pack(uint8_t page, uint8_t* report);
+
+// raw_hid_receive_kb() hook: if `data` is a stats request, replaces it with
+// the page asked for, sends it back and returns true. An unknown page comes
+// back with no data.
+bool achordion_stats_receive(uint8_t* data, uint8_t length);
+
+#ifdef __cplusplus
+}
+#endif
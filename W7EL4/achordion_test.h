@@ -1,5 +1,5 @@
 // achordion_test.h — Test-specific declarations for Achordion unit tests
-// This header exposes internal state variables for testing purposes
+// This header exposes internal state for testing purposes
 
 #pragma once
 
@@ -7,21 +7,19 @@
 
 #ifdef ACHORDION_TESTING
 
-// Internal state enum (copy from achordion.c)
-enum achordion_state_t {
-  STATE_RELEASED,
-  STATE_UNSETTLED,
-  STATE_RECURSING,
-};
+// Number of tap-hold keys currently held back by Achordion
+uint8_t achordion_pending_count_for_testing(void);
 
-// Expose internal state variables for testing
-extern enum achordion_state_t achordion_state;
-extern keyrecord_t tap_hold_record;
-extern uint16_t tap_hold_keycode;
-extern uint16_t hold_timer;
-extern bool pressed_another_key_before_release;
+// Keycode of the pending key at `index` (0 = oldest), or KC_NO
+uint16_t achordion_pending_keycode_for_testing(uint8_t index);
+
+// Number of events waiting in the deferred event buffer
+uint8_t achordion_buffered_events_for_testing(void);
+
+// Latency histogram bucket of a settle `latency` ms after the press
+uint8_t achordion_latency_bucket_for_testing(uint16_t latency);
 
 // Test helper functions
 void reset_achordion_state_for_testing(void);
 
-#endif // ACHORDION_TESTING
\ No newline at end of file
+#endif // ACHORDION_TESTING
@@ -0,0 +1,340 @@
+// bench_achordion.c — Achordion microbenchmarks
+//
+// Replays synthetic keystroke streams through the real achordion.c with the
+// host harness and reports ns/event and events/s per scenario. Each is also
+// given relative to a reference run in the same process, generating and
+// sorting the streams, which does not depend on the code under test but
+// does on the machine. With --baseline, compares those ratios against a
+// stored baseline and fails if a scenario is slower by more than
+// --threshold percent, so the baseline holds on any host; with --write,
+// stores the ratios as the new baseline. Binary traces given as arguments,
+// such as recorded typing sessions, are benchmarked too, named after their
+// file.
+//
+// Usage: bench_achordion [--baseline FILE [--threshold PCT] [--write]] [TRACE.ktr...]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "harness.h"
+#include "trace_file.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define STREAM_KEYS 20000  // Key presses per stream, each with its release
+#define RUNS 7             // Best of
+#define MAX_TRACES 16
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Streams
+// ─────────────────────────────────────────────────────────────────────────────
+
+static harness_input_t stream[STREAM_KEYS * 2];
+static size_t stream_length = 0;
+
+// Deterministic xorshift, so every run replays the same stream
+static uint32_t rng_state;
+
+static uint32_t rng(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+static uint32_t between(uint32_t low, uint32_t high) {
+  return low + rng() % (high - low + 1);
+}
+
+static int compare_time(const void* a, const void* b) {
+  const uint32_t ta = ((const harness_input_t*)a)->time;
+  const uint32_t tb = ((const harness_input_t*)b)->time;
+  return ta < tb ? -1 : ta > tb;
+}
+
+static void add_key(uint32_t press, uint32_t release, uint8_t row, uint8_t col,
+                    uint16_t keycode) {
+  stream[stream_length++] = (harness_input_t){press, keycode, row, col, true};
+  stream[stream_length++] = (harness_input_t){release, keycode, row, col, false};
+}
+
+// Events are generated per key; sorting interleaves them into one stream.
+static void finish_stream(void) {
+  qsort(stream, stream_length, sizeof(stream[0]), compare_time);
+}
+
+// A letter key on either hand, never a home row mod
+static void random_letter(uint8_t* row, uint8_t* col, uint16_t* keycode) {
+  *row = (rng() & 1 ? 6 : 0) + between(1, 3);
+  *col = between(1, 5);
+  *keycode = KC_A + (*row * MATRIX_COLS + *col) % 26;
+}
+
+// Fast typing on plain keys: no Achordion decision at all.
+static void alpha_stream(void) {
+  uint32_t t = 1000;
+  for (int i = 0; i < STREAM_KEYS; ++i) {
+    uint8_t row, col;
+    uint16_t keycode;
+    random_letter(&row, &col, &keycode);
+    add_key(t, t + between(40, 90), row, col, keycode);
+    t += between(60, 180);
+  }
+  finish_stream();
+}
+
+// Prose typed on home row mods: one key in three is a mod-tap, rolled into
+// the next key. Outside the typing streak, each is decided by a chord.
+static void home_row_stream(void) {
+  static const uint8_t mods[] = {MOD_LCTL, MOD_LALT, MOD_LGUI, MOD_LSFT};
+  uint32_t t = 1000;
+  for (int i = 0; i < STREAM_KEYS; ++i) {
+    uint8_t row, col;
+    uint16_t keycode;
+    random_letter(&row, &col, &keycode);
+    if (rng() % 3 == 0) {
+      const uint8_t finger = between(0, 3);
+      row = rng() & 1 ? 2 : 8;
+      col = 1 + finger;
+      keycode = MT(mods[finger] | (row >= 6 ? 0x10 : 0), KC_A + finger);
+      t += between(60, 250);  // Often outside the typing streak
+    }
+    add_key(t, t + between(60, 140), row, col, keycode);
+    t += between(50, 160);
+  }
+  finish_stream();
+}
+
+// Layer-tap thumbs held while the other hand types a few keys.
+static void thumb_stream(void) {
+  uint32_t t = 1000;
+  for (int i = 0; i < STREAM_KEYS;) {
+    const uint32_t start = t;
+    const int burst = between(1, 4);
+    t += between(120, 200);
+    for (int k = 0; k < burst; ++k, ++i) {
+      add_key(t, t + between(30, 60), 8, between(1, 5), KC_H + k);
+      t += between(70, 120);
+    }
+    add_key(start, t, 5, 0, LT(1, KC_SPACE));
+    ++i;
+    t += between(150, 400);
+  }
+  finish_stream();
+}
+
+// Mods held alone past their timeout, like Ctrl+scroll or Shift+click.
+static void timeout_stream(void) {
+  uint32_t t = 1000;
+  for (int i = 0; i < STREAM_KEYS; ++i) {
+    add_key(t, t + between(1050, 1500), 2, 1, MT(MOD_LCTL, KC_A));
+    t += between(1600, 2000);
+  }
+  finish_stream();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Runner
+// ─────────────────────────────────────────────────────────────────────────────
+
+typedef struct {
+  const char* name;
+  void (*build)(void);     // Generated stream, or
+  trace_reader_t* trace;   // binary trace, replayed from its mapping
+  double ns_per_event;
+  double relative;         // To the reference
+} scenario_t;
+
+static scenario_t scenarios[4 + MAX_TRACES] = {
+    {.name = "alpha", .build = alpha_stream},
+    {.name = "home_row_rolls", .build = home_row_stream},
+    {.name = "thumb_layers", .build = thumb_stream},
+    {.name = "timeouts", .build = timeout_stream},
+};
+static size_t scenario_count = 4;
+
+static trace_reader_t traces[MAX_TRACES];
+static char trace_names[MAX_TRACES][64];
+
+static double seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Reference: ns per event to generate and sort every synthetic stream
+static double run_reference(void) {
+  double best = 1e30;
+  size_t events = 0;
+  for (int r = 0; r < RUNS; ++r) {
+    events = 0;
+    const double start = seconds();
+    for (size_t s = 0; s < scenario_count; ++s) {
+      if (scenarios[s].build != NULL) {
+        rng_state = 0x9E3779B9;
+        stream_length = 0;
+        scenarios[s].build();
+        events += stream_length;
+      }
+    }
+    const double elapsed = seconds() - start;
+    if (elapsed < best) {
+      best = elapsed;
+    }
+  }
+  return best * 1e9 / events;
+}
+
+static double run_trace(trace_reader_t* trace) {
+  double best = 1e30;
+  uint32_t events = 0;
+  for (int r = 0; r < RUNS; ++r) {
+    trace_reader_t reader;
+    trace_reader_init(&reader, trace->data, trace->size);
+    harness_input_t input;
+    events = 0;
+    const double start = seconds();
+    while (trace_next(&reader, &input)) {
+      if (events++ == 0) {
+        harness_reset(input.time, NULL, NULL);
+      }
+      harness_feed(&input);
+    }
+    harness_finish();
+    const double elapsed = seconds() - start;
+    if (elapsed < best) {
+      best = elapsed;
+    }
+  }
+  return events ? best * 1e9 / events : 0;
+}
+
+static double run(const scenario_t* scenario) {
+  if (scenario->trace != NULL) {
+    return run_trace(scenario->trace);
+  }
+  rng_state = 0x9E3779B9;
+  stream_length = 0;
+  scenario->build();
+
+  double best = 1e30;
+  for (int r = 0; r < RUNS; ++r) {
+    const double start = seconds();
+    harness_reset(stream[0].time, NULL, NULL);
+    for (size_t i = 0; i < stream_length; ++i) {
+      harness_feed(&stream[i]);
+    }
+    harness_finish();
+    const double elapsed = seconds() - start;
+    if (elapsed < best) {
+      best = elapsed;
+    }
+  }
+  return best * 1e9 / stream_length;
+}
+
+// Baseline: one `<scenario> <ns/event relative to the reference>` per line,
+// `#` comments.
+static bool baseline_of(FILE* file, const char* name, double* relative) {
+  char line[128], scenario[64];
+  double value;
+  rewind(file);
+  while (fgets(line, sizeof(line), file) != NULL) {
+    if (line[0] != '#' && sscanf(line, "%63s %lf", scenario, &value) == 2 &&
+        strcmp(scenario, name) == 0) {
+      *relative = value;
+      return true;
+    }
+  }
+  return false;
+}
+
+int main(int argc, char** argv) {
+  const char* baseline_path = NULL;
+  double threshold = 25.0;
+  bool write = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+      baseline_path = argv[++i];
+    } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+      threshold = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--write") == 0) {
+      write = true;
+    } else if (argv[i][0] != '-' && scenario_count < 4 + MAX_TRACES) {
+      trace_reader_t* trace = &traces[scenario_count - 4];
+      if (!trace_open(trace, argv[i])) {
+        fprintf(stderr, "%s: %s\n", argv[i],
+                errno == EINVAL ? "not a binary trace" : strerror(errno));
+        return 2;
+      }
+      // Named after the file, without directory and extension
+      char* name = trace_names[scenario_count - 4];
+      const char* base = strrchr(argv[i], '/');
+      snprintf(name, sizeof(trace_names[0]), "%s", base ? base + 1 : argv[i]);
+      name[strcspn(name, ".")] = '\0';
+      scenarios[scenario_count++] = (scenario_t){.name = name, .trace = trace};
+    } else {
+      fprintf(stderr,
+              "usage: %s [--baseline FILE [--threshold PCT] [--write]] "
+              "[TRACE.ktr...]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+
+  FILE* baseline = NULL;
+  if (baseline_path != NULL && !write &&
+      (baseline = fopen(baseline_path, "r")) == NULL) {
+    perror(baseline_path);
+    return 2;
+  }
+
+  int regressions = 0;
+  printf("%-16s %10s %14s %10s %10s\n", "scenario", "ns/event", "events/s",
+         "relative", "baseline");
+  const double reference = run_reference();
+  printf("%-16s %10.1f %14.0f %10.2f\n", "(reference)", reference, 1e9 / reference, 1.0);
+  for (size_t s = 0; s < scenario_count; ++s) {
+    scenario_t* scenario = &scenarios[s];
+    scenario->ns_per_event = run(scenario);
+    scenario->relative = scenario->ns_per_event / reference;
+    printf("%-16s %10.1f %14.0f %10.2f", scenario->name, scenario->ns_per_event,
+           1e9 / scenario->ns_per_event, scenario->relative);
+
+    double expected;
+    if (baseline != NULL && baseline_of(baseline, scenario->name, &expected)) {
+      const double change = (scenario->relative / expected - 1) * 100;
+      const bool regressed = change > threshold;
+      printf(" %+9.1f%%%s", change, regressed ? "  REGRESSION" : "");
+      regressions += regressed;
+    }
+    printf("\n");
+  }
+  if (baseline != NULL) {
+    fclose(baseline);
+  }
+
+  if (write) {
+    FILE* out = fopen(baseline_path, "w");
+    if (out == NULL) {
+      perror(baseline_path);
+      return 2;
+    }
+    fprintf(out, "# Achordion benchmark baseline, ns/event relative to the reference run\n"
+                 "# (make -f Makefile.test bench-baseline)\n");
+    for (size_t s = 0; s < scenario_count; ++s) {
+      fprintf(out, "%s %.3f\n", scenarios[s].name, scenarios[s].relative);
+    }
+    fclose(out);
+    printf("wrote %s\n", baseline_path);
+  }
+
+  if (regressions > 0) {
+    printf("%d scenario(s) more than %.0f%% slower than the baseline\n",
+           regressions, threshold);
+    return 1;
+  }
+  return 0;
+}
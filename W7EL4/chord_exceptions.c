@@ -0,0 +1,32 @@
+// chord_exceptions.c — Achordion's hands and same-hand chord exceptions
+//
+// Generated by tools/gen_chord_exceptions.py from chord_exceptions.json and
+// keymap.c. Do not edit.
+//
+// Bit 0: GUI + Z/X/C/V, on the left hand
+
+#include "chord_exceptions.h"
+
+const uint8_t chord_hands[MATRIX_ROWS][MATRIX_COLS] PROGMEM = LAYOUT_voyager(
+  0x01,  0x01,  0x01,  0x01,  0x01,  0x01,  0x02,  0x02,  0x02,  0x02,  0x02,  0x02,
+  0x01,  0x01,  0x01,  0x01,  0x01,  0x01,  0x02,  0x02,  0x02,  0x02,  0x02,  0x02,
+  0x01,  0x01,  0x01,  0x01,  0x01,  0x01,  0x02,  0x02,  0x02,  0x02,  0x02,  0x02,
+  0x01,  0x01,  0x01,  0x01,  0x01,  0x01,  0x02,  0x02,  0x02,  0x02,  0x02,  0x02,
+  0,     0,     0,     0
+);
+
+const chord_exception_mask_t chord_exception_tap_hold[MATRIX_ROWS][MATRIX_COLS] PROGMEM = LAYOUT_voyager(
+  0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+  0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+  0,     0,     0,     0x01,  0,     0,     0,     0,     0,     0,     0,     0,
+  0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+  0,     0,     0,     0
+);
+
+const chord_exception_mask_t chord_exception_other[MATRIX_ROWS][MATRIX_COLS] PROGMEM = LAYOUT_voyager(
+  0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+  0,     0,     0,     0,     0,     0x01,  0,     0,     0,     0,     0,     0,
+  0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+  0,     0,     0x01,  0,     0x01,  0x01,  0,     0,     0,     0,     0,     0,
+  0,     0,     0,     0
+);
@@ -0,0 +1,46 @@
+// chord_exceptions.h — Achordion's hands and same-hand chord exceptions
+//
+// Generated by tools/gen_chord_exceptions.py from chord_exceptions.json and
+// keymap.c. Do not edit: change chord_exceptions.json and run
+//   python3 tools/gen_chord_exceptions.py W7EL4
+
+#pragma once
+
+#include "quantum.h"
+
+#define CHORD_EXCEPTIONS 1
+
+#define CHORD_HAND_LEFT 0x01
+#define CHORD_HAND_RIGHT 0x02
+
+// Hand bit of every key; none for keys that go with either hand.
+extern const uint8_t chord_hands[MATRIX_ROWS][MATRIX_COLS] PROGMEM;
+
+// Returns true if both keys are on the same hand. Keys outside the matrix,
+// like combos, are on neither.
+static inline bool chord_same_hand(keypos_t a, keypos_t b) {
+  if (a.row >= MATRIX_ROWS || a.col >= MATRIX_COLS ||
+      b.row >= MATRIX_ROWS || b.col >= MATRIX_COLS) {
+    return false;
+  }
+  return (pgm_read_byte(&chord_hands[a.row][a.col]) &
+          pgm_read_byte(&chord_hands[b.row][b.col])) != 0;
+}
+
+typedef uint8_t chord_exception_mask_t;
+
+// Bit i is set if the key is a tap-hold key of exception i.
+extern const chord_exception_mask_t chord_exception_tap_hold[MATRIX_ROWS][MATRIX_COLS] PROGMEM;
+// Bit i is set if the key is an other key of exception i.
+extern const chord_exception_mask_t chord_exception_other[MATRIX_ROWS][MATRIX_COLS] PROGMEM;
+
+// Returns true if a chord of the two keys is an exception, allowed to
+// settle as hold even on the same hand.
+static inline bool chord_exception(keypos_t tap_hold, keypos_t other) {
+  if (tap_hold.row >= MATRIX_ROWS || tap_hold.col >= MATRIX_COLS ||
+      other.row >= MATRIX_ROWS || other.col >= MATRIX_COLS) {
+    return false;
+  }
+  return (pgm_read_byte(&chord_exception_tap_hold[tap_hold.row][tap_hold.col]) &
+          pgm_read_byte(&chord_exception_other[other.row][other.col])) != 0;
+}
@@ -0,0 +1,132 @@
+// deadline.c — Min-heap deadline scheduler
+
+#include "deadline.h"
+
+typedef struct {
+  uint32_t deadline;
+  deadline_callback_t callback;
+  void* arg;
+  deadline_token_t token;
+} deadline_entry_t;
+
+// Binary min-heap ordered by deadline; heap[0] is the next one due.
+static deadline_entry_t heap[DEADLINE_MAX];
+static uint8_t heap_size = 0;
+static deadline_token_t last_token = DEADLINE_INVALID;
+
+static void swap(uint8_t a, uint8_t b) {
+  const deadline_entry_t tmp = heap[a];
+  heap[a] = heap[b];
+  heap[b] = tmp;
+}
+
+static void sift_up(uint8_t i) {
+  while (i > 0) {
+    const uint8_t parent = (i - 1) / 2;
+    if (!deadline_before(heap[i].deadline, heap[parent].deadline)) {
+      break;
+    }
+    swap(i, parent);
+    i = parent;
+  }
+}
+
+static void sift_down(uint8_t i) {
+  for (;;) {
+    const uint8_t left = 2 * i + 1;
+    const uint8_t right = left + 1;
+    uint8_t smallest = i;
+    if (left < heap_size &&
+        deadline_before(heap[left].deadline, heap[smallest].deadline)) {
+      smallest = left;
+    }
+    if (right < heap_size &&
+        deadline_before(heap[right].deadline, heap[smallest].deadline)) {
+      smallest = right;
+    }
+    if (smallest == i) {
+      return;
+    }
+    swap(i, smallest);
+    i = smallest;
+  }
+}
+
+static void remove_at(uint8_t i) {
+  --heap_size;
+  if (i == heap_size) {
+    return;
+  }
+  heap[i] = heap[heap_size];
+  sift_up(i);
+  sift_down(i);
+}
+
+static bool token_in_use(deadline_token_t token) {
+  for (uint8_t i = 0; i < heap_size; ++i) {
+    if (heap[i].token == token) {
+      return true;
+    }
+  }
+  return false;
+}
+
+deadline_token_t deadline_schedule(uint32_t deadline, deadline_callback_t callback,
+                                   void* arg) {
+  if (heap_size == DEADLINE_MAX || callback == NULL) {
+    return DEADLINE_INVALID;
+  }
+
+  // Tokens are reused after 255 deadlines; skip any still scheduled.
+  do {
+    ++last_token;
+  } while (last_token == DEADLINE_INVALID || token_in_use(last_token));
+
+  const uint8_t i = heap_size++;
+  heap[i].deadline = deadline;
+  heap[i].callback = callback;
+  heap[i].arg = arg;
+  heap[i].token = last_token;
+  sift_up(i);
+  return last_token;
+}
+
+deadline_token_t deadline_schedule_in(uint32_t delay_ms, deadline_callback_t callback,
+                                      void* arg) {
+  return deadline_schedule(timer_read32() + delay_ms, callback, arg);
+}
+
+bool deadline_cancel(deadline_token_t token) {
+  if (token == DEADLINE_INVALID) {
+    return false;
+  }
+  for (uint8_t i = 0; i < heap_size; ++i) {
+    if (heap[i].token == token) {
+      remove_at(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t deadline_next(void) {
+  return heap[0].deadline;
+}
+
+bool deadline_pending(void) {
+  return heap_size > 0;
+}
+
+void deadline_task(void) {
+  if (heap_size == 0) {
+    return;
+  }
+
+  const uint32_t now = timer_read32();
+  // Callbacks may schedule or cancel deadlines, so re-check the top each time.
+  while (heap_size > 0 && !deadline_before(now, heap[0].deadline)) {
+    const deadline_entry_t entry = heap[0];
+    remove_at(0);
+    entry.callback(entry.deadline, entry.arg);
+  }
+}
@@ -0,0 +1,213 @@
+// capture.c — Drains keystroke capture reports from the keyboard into a trace
+//
+// Usage: capture [-d DEVICE] [-n EVENTS] [-o OUT]
+//
+// Reads the raw HID reports of a keyboard built with KEY_CAPTURE_ENABLE
+// (see ../key_capture.h) from a Linux hidraw device, and writes the events
+// as a trace for replay: binary if OUT ends in .ktr, text otherwise, or
+// text on standard output. Without -d, uses the first hidraw device with a
+// QMK raw HID interface. Runs until EVENTS events, end of input or Ctrl-C.
+//
+// The keyboard records nothing until capture sends it the start request,
+// and capture sends the stop request when it ends. Reports only flow while
+// the raw HID channel is paired: keep Keymapp or Oryx live training
+// connected. hidraw hands every reader its own copy of the reports, so
+// capture reads alongside it. Any file or pipe of 32-byte reports stands in
+// for a device already capturing, e.g. hidraw_sim's output.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "trace_file.h"
+#include "../key_capture.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int signal) {
+  (void)signal;
+  stop = 1;
+}
+
+// Returns true if the hidraw device's report descriptor starts with QMK's
+// raw HID usage page, 0xFF60.
+static bool is_raw_hid(const char* sysfs_dir) {
+  char path[512];
+  snprintf(path, sizeof(path), "%s/device/report_descriptor", sysfs_dir);
+  FILE* file = fopen(path, "rb");
+  if (file == NULL) {
+    return false;
+  }
+  uint8_t descriptor[3];
+  const bool match = fread(descriptor, 1, 3, file) == 3 &&
+                     descriptor[0] == 0x06 && descriptor[1] == 0x60 &&
+                     descriptor[2] == 0xFF;
+  fclose(file);
+  return match;
+}
+
+static bool find_device(char* device, size_t size) {
+  glob_t found;
+  if (glob("/sys/class/hidraw/hidraw*", 0, NULL, &found) != 0) {
+    return false;
+  }
+  bool ok = false;
+  for (size_t i = 0; i < found.gl_pathc && !ok; ++i) {
+    if (is_raw_hid(found.gl_pathv[i])) {
+      snprintf(device, size, "/dev/%s", strrchr(found.gl_pathv[i], '/') + 1);
+      ok = true;
+    }
+  }
+  globfree(&found);
+  return ok;
+}
+
+// Sends a capture request. hidraw takes the report id, 0 on QMK's raw HID
+// interface, ahead of the report.
+static bool send_command(int fd, uint8_t command) {
+  uint8_t request[1 + KEY_CAPTURE_REPORT_SIZE] = {0, KEY_CAPTURE_EVENT, command};
+  return write(fd, request, sizeof(request)) == (ssize_t)sizeof(request);
+}
+
+// Reads one whole report. hidraw returns one per read(); pipes may split
+// them.
+static bool read_report(int fd, uint8_t* report) {
+  size_t got = 0;
+  while (got < KEY_CAPTURE_REPORT_SIZE) {
+    const ssize_t n = read(fd, report + got, KEY_CAPTURE_REPORT_SIZE - got);
+    if (n == 0 || (n < 0 && errno != EINTR) || stop) {
+      return false;
+    }
+    if (n > 0) {
+      got += n;
+    }
+  }
+  return true;
+}
+
+typedef struct {
+  FILE* text;  // Either text output,
+  trace_writer_t binary;  // or binary
+  bool is_binary;
+  uint32_t events;
+  uint32_t dropped;
+  uint32_t time;  // Unwrapped, ms
+  uint16_t last_time;
+} output_t;
+
+static bool write_event(output_t* out, uint16_t time, uint16_t keycode,
+                        uint8_t key) {
+  // The keyboard's clock is 16 bits: unwrap it from the deltas. Gaps over
+  // 65 s fold, which replay cannot tell from a shorter pause anyway.
+  out->time = out->events == 0 ? time : out->time + (uint16_t)(time - out->last_time);
+  out->last_time = time;
+  ++out->events;
+
+  const uint8_t row = key >> 4;
+  const uint8_t col = (key >> 1) & 0x07;
+  const bool pressed = key & 1;
+  if (out->is_binary) {
+    return trace_write(&out->binary, out->time, row, col, pressed, keycode);
+  }
+  return fprintf(out->text, "%lu %u %u %c 0x%04X\n", (unsigned long)out->time,
+                 row, col, pressed ? 'd' : 'u', keycode) > 0;
+}
+
+int main(int argc, char** argv) {
+  char device[64] = "";
+  const char* out_path = NULL;
+  unsigned long limit = 0;
+  int opt;
+  while ((opt = getopt(argc, argv, "d:n:o:")) != -1) {
+    switch (opt) {
+      case 'd':
+        snprintf(device, sizeof(device), "%s", optarg);
+        break;
+      case 'n':
+        limit = strtoul(optarg, NULL, 0);
+        break;
+      case 'o':
+        out_path = optarg;
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-d DEVICE] [-n EVENTS] [-o OUT]\n", argv[0]);
+        return 2;
+    }
+  }
+  if (device[0] == '\0' && !find_device(device, sizeof(device))) {
+    fprintf(stderr, "no raw HID device found, give one with -d\n");
+    return 1;
+  }
+  // Only a device takes requests: files and pipes are replayed as they are.
+  struct stat status;
+  const bool is_device = stat(device, &status) == 0 && S_ISCHR(status.st_mode);
+  const int fd = open(device, is_device ? O_RDWR : O_RDONLY);
+  if (fd < 0) {
+    perror(device);
+    return 1;
+  }
+  if (is_device && !send_command(fd, KEY_CAPTURE_START)) {
+    perror(device);
+    close(fd);
+    return 1;
+  }
+
+  output_t out = {.text = stdout};
+  if (out_path != NULL) {
+    const size_t length = strlen(out_path);
+    out.is_binary = length > 4 && strcmp(out_path + length - 4, ".ktr") == 0;
+    if (out.is_binary ? !trace_create(&out.binary, out_path, 0)
+                      : (out.text = fopen(out_path, "w")) == NULL) {
+      perror(out_path);
+      return 1;
+    }
+  }
+  if (!out.is_binary) {
+    fprintf(out.text, "# Captured from %s\n", device);
+  }
+
+  struct sigaction action = {.sa_handler = on_signal};
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+
+  uint8_t report[KEY_CAPTURE_REPORT_SIZE];
+  bool ok = true;
+  while (ok && (limit == 0 || out.events < limit) && read_report(fd, report)) {
+    if (report[0] != KEY_CAPTURE_EVENT) {
+      continue;  // Oryx's own reports, stats replies
+    }
+    if (report[2] > 0) {
+      out.dropped += report[2];
+      if (!out.is_binary) {
+        fprintf(out.text, "# %u events dropped\n", report[2]);
+      }
+    }
+    const uint8_t n = report[1] <= KEY_CAPTURE_PER_REPORT ? report[1] : 0;
+    for (uint8_t k = 0; k < n && ok && (limit == 0 || out.events < limit); ++k) {
+      const uint8_t* e = report + 3 + k * KEY_CAPTURE_EVENT_SIZE;
+      ok = write_event(&out, e[0] | e[1] << 8, e[2] | e[3] << 8, e[4]);
+    }
+  }
+  if (is_device && !send_command(fd, KEY_CAPTURE_STOP)) {
+    perror(device);
+  }
+  close(fd);
+
+  ok = (out.is_binary ? trace_finish(&out.binary)
+                      : fflush(out.text) == 0 &&
+                            (out.text == stdout || fclose(out.text) == 0)) &&
+       ok;
+  if (!ok) {
+    perror(out_path != NULL ? out_path : "stdout");
+    return 1;
+  }
+  fprintf(stderr, "captured %lu events, %lu dropped\n",
+          (unsigned long)out.events, (unsigned long)out.dropped);
+  return 0;
+}
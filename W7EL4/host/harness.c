@@ -0,0 +1,141 @@
+// harness.c — Trace replay engine for the real achordion.c
+
+#include "harness.h"
+#include "achordion.h"
+#include "achordion_test.h"
+#include "deadline.h"
+
+static uint32_t now = 0;
+static harness_sink_t sink = NULL;
+static void* sink_context = NULL;
+static uint32_t outputs = 0;
+
+static bool achordion_enabled = true;
+static bool tapping_enabled = false;
+static tapping_config_t tapping_config;
+
+// ─────────────────────────────────────────────────────────────────────────────
+// QMK functions Achordion calls
+// ─────────────────────────────────────────────────────────────────────────────
+
+uint16_t timer_read(void) {
+  return (uint16_t)now;
+}
+
+uint32_t timer_read32(void) {
+  return now;
+}
+
+static void emit(const harness_output_t* output) {
+  ++outputs;
+  if (sink != NULL) {
+    sink(output, sink_context);
+  }
+}
+
+void process_record(keyrecord_t* record) {
+  const harness_output_t output = {
+      .time = now,
+      .latency = (uint16_t)((uint16_t)now - record->event.time),
+      .kind = HARNESS_KEY,
+      .row = record->event.key.row,
+      .col = record->event.key.col,
+      .pressed = record->event.pressed,
+      .tap_count = record->tap.count,
+  };
+  emit(&output);
+}
+
+static void emit_mods(uint8_t kind, uint8_t mods) {
+  const harness_output_t output = {.time = now, .kind = kind, .mods = mods};
+  emit(&output);
+}
+
+void register_mods(uint8_t mods) {
+  emit_mods(HARNESS_MODS_DOWN, mods);
+}
+
+void unregister_mods(uint8_t mods) {
+  emit_mods(HARNESS_MODS_UP, mods);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Main loop
+// ─────────────────────────────────────────────────────────────────────────────
+
+static void main_loop_task(void) {
+  deadline_task();
+  housekeeping_task_achordion();
+}
+
+// Runs every deadline due by `time`, each at its own time.
+static void run_until(uint32_t time) {
+  while (deadline_pending() && !deadline_before(time, deadline_next())) {
+    if (deadline_before(now, deadline_next())) {
+      now = deadline_next();
+    }
+    main_loop_task();
+  }
+  now = time;
+}
+
+// Where events go once QMK's tapping logic is done with them
+static void deliver(uint16_t keycode, keyrecord_t* record) {
+  if (!achordion_enabled || process_record_achordion(keycode, record)) {
+    process_record(record);
+  }
+}
+
+void harness_configure(const harness_config_t* config) {
+  achordion_enabled = config->achordion;
+  tapping_enabled = config->tapping != NULL;
+  if (tapping_enabled) {
+    tapping_config = *config->tapping;
+  }
+}
+
+void harness_reset(uint32_t time, harness_sink_t new_sink, void* context) {
+  reset_achordion_state_for_testing();
+  if (tapping_enabled) {
+    tapping_reset(&tapping_config, deliver);
+  }
+  now = time;
+  sink = new_sink;
+  sink_context = context;
+  outputs = 0;
+}
+
+void harness_feed(const harness_input_t* input) {
+  run_until(input->time);
+
+  keyrecord_t record = {
+      .event =
+          {
+              .key = {.col = input->col, .row = input->row},
+              .time = (uint16_t)input->time,
+              .type = KEY_EVENT,
+              .pressed = input->pressed,
+          },
+  };
+  if (tapping_enabled) {
+    tapping_process(input->keycode, &record);
+  } else {
+    deliver(input->keycode, &record);
+  }
+  main_loop_task();
+}
+
+void harness_finish(void) {
+  while (deadline_pending()) {
+    run_until(deadline_next());
+  }
+  main_loop_task();
+}
+
+uint32_t harness_now(void) {
+  return now;
+}
+
+uint32_t harness_output_count(void) {
+  return outputs;
+}
@@ -0,0 +1,82 @@
+// harness.h — Trace replay engine for the real achordion.c
+//
+// Drives Achordion the way QMK's main loop does, on a virtual clock: each
+// input event goes through process_record_achordion(), then deadline_task()
+// and housekeeping_task_achordion() run. Between events, the clock jumps
+// straight to each due deadline instead of ticking every millisecond, so a
+// long trace replays as fast as Achordion can process it.
+//
+// Everything that reaches the rest of QMK, whether passed through or
+// replayed, comes out in order to a sink, with the virtual time it came
+// out at.
+//
+// By default input goes straight to Achordion with tap.count 0, as the
+// regression traces expect. harness_configure() can put the tapping model
+// (tapping.h) in front of it, as QMK does, and take Achordion out, to
+// compare configurations.
+
+#pragma once
+
+#include "quantum.h"
+#include "tapping.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// One keystroke of a trace
+typedef struct {
+  uint32_t time;  // ms
+  uint16_t keycode;
+  uint8_t row;
+  uint8_t col;
+  bool pressed;
+} harness_input_t;
+
+enum harness_output_kind {
+  HARNESS_KEY,        // A key event reached process_record()
+  HARNESS_MODS_DOWN,  // register_mods()
+  HARNESS_MODS_UP,    // unregister_mods()
+};
+
+typedef struct {
+  uint32_t time;     // Virtual time it came out at, ms
+  uint16_t latency;  // HARNESS_KEY: ms since the key event happened
+  uint8_t kind;      // enum harness_output_kind
+  uint8_t row;
+  uint8_t col;
+  bool pressed;
+  uint8_t tap_count;  // 0 for a hold or a plain key
+  uint8_t mods;       // HARNESS_MODS_*
+} harness_output_t;
+
+typedef void (*harness_sink_t)(const harness_output_t* output, void* context);
+
+typedef struct {
+  bool achordion;  // Events go through process_record_achordion()
+  // QMK's tap-hold decision in front of Achordion, or NULL for none
+  const tapping_config_t* tapping;
+} harness_config_t;
+
+// Sets the configuration for the next harness_reset(). The default is
+// Achordion alone.
+void harness_configure(const harness_config_t* config);
+
+// Resets Achordion and sets the clock to `time`. Outputs go to `sink`,
+// which may be NULL to only count them.
+void harness_reset(uint32_t time, harness_sink_t sink, void* context);
+
+// Runs the main loop up to `input->time`, then processes `input`.
+void harness_feed(const harness_input_t* input);
+
+// Runs the main loop until no deadline is left.
+void harness_finish(void);
+
+uint32_t harness_now(void);
+
+// Number of outputs since harness_reset()
+uint32_t harness_output_count(void);
+
+#ifdef __cplusplus
+}
+#endif
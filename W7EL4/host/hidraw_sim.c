@@ -0,0 +1,74 @@
+// hidraw_sim.c — Simulated keyboard for testing capture
+//
+// Usage: hidraw_sim [-t N] TRACE.ktr > reports
+//
+// Plays a binary trace through the real key_capture.c, as if typed on a
+// paired keyboard that capture has started, and writes the raw HID reports
+// it sends to standard output, the way a hidraw device delivers them. An
+// unrelated report is mixed in every few events, as Oryx and stats replies
+// would. The main loop runs once every N events (default 1), so that a
+// large N overflows the capture buffer.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "trace_file.h"
+#include "raw_hid.h"
+#include "../key_capture.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+void raw_hid_send(uint8_t* data, uint8_t length) {
+  fwrite(data, length, 1, stdout);
+}
+
+int main(int argc, char** argv) {
+  unsigned long every = 1;
+  int opt;
+  while ((opt = getopt(argc, argv, "t:")) != -1) {
+    if (opt != 't' || (every = strtoul(optarg, NULL, 0)) == 0) {
+      fprintf(stderr, "usage: %s [-t N] TRACE.ktr\n", argv[0]);
+      return 2;
+    }
+  }
+  if (optind >= argc) {
+    fprintf(stderr, "usage: %s [-t N] TRACE.ktr\n", argv[0]);
+    return 2;
+  }
+
+  trace_reader_t trace;
+  if (!trace_open(&trace, argv[optind])) {
+    fprintf(stderr, "%s: %s\n", argv[optind],
+            errno == EINVAL ? "not a binary trace" : strerror(errno));
+    return 1;
+  }
+
+  rawhid_state.paired = true;
+  uint8_t start[KEY_CAPTURE_REPORT_SIZE] = {KEY_CAPTURE_EVENT, KEY_CAPTURE_START};
+  key_capture_receive(start, sizeof(start));
+  uint8_t other[KEY_CAPTURE_REPORT_SIZE] = {0xAC};
+  harness_input_t input;
+  for (unsigned long i = 1; trace_next(&trace, &input); ++i) {
+    const keyrecord_t record = {
+        .event = {
+            .key = {.row = input.row, .col = input.col},
+            .time = (uint16_t)input.time,
+            .type = KEY_EVENT,
+            .pressed = input.pressed,
+        },
+    };
+    key_capture_record(input.keycode, &record);
+    if (i % every == 0) {
+      key_capture_task();
+    }
+    if (i % 7 == 0) {
+      raw_hid_send(other, sizeof(other));
+    }
+  }
+  while (key_capture_pending() > 0) {
+    key_capture_task();
+  }
+  trace_close(&trace);
+  return trace.error || fflush(stdout) != 0;
+}
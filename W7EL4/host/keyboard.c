@@ -0,0 +1,266 @@
+// keyboard.c — The HID reports and LEDs a layout's keymap.c drives
+//
+// Host versions of QMK's action, send_string and RGB matrix functions:
+// register_code16() and friends keep one keyboard report and hand it to
+// host_keyboard_send() whenever it changes, consumer keys go to
+// host_consumer_send(), and rgb_matrix_set_color() paints rgb_matrix_frame.
+// Whoever links this overrides the weak hooks to capture them.
+
+#include "voyager.h"
+
+rgb_config_t rgb_matrix_config = {
+    .enable = 1,
+    .hsv = {0, 255, 255},
+    .speed = 127,
+    .flags = LED_FLAG_ALL,
+};
+keyboard_config_t keyboard_config = {0};
+
+// The LED colors set since the last frame, for whoever links this.
+RGB rgb_matrix_frame[RGB_MATRIX_LED_COUNT];
+
+static report_keyboard_t report = {0};
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Reports
+// ─────────────────────────────────────────────────────────────────────────────
+
+__attribute__((weak)) void host_keyboard_send(const report_keyboard_t* report) {
+  (void)report;
+}
+
+__attribute__((weak)) void host_consumer_send(uint16_t usage) {
+  (void)usage;
+}
+
+__attribute__((weak)) void wait_ms(uint32_t ms) {
+  (void)ms;
+}
+
+static void set_mods(uint8_t mods) {
+  if (report.mods != mods) {
+    report.mods = mods;
+    host_keyboard_send(&report);
+  }
+}
+
+// Achordion's eager mods; harness.c links its own.
+__attribute__((weak)) void register_mods(uint8_t mods) {
+  set_mods(report.mods | mods);
+}
+
+__attribute__((weak)) void unregister_mods(uint8_t mods) {
+  set_mods(report.mods & ~mods);
+}
+
+// The 8-bit mods of a 5-bit mod encoding.
+static uint8_t mod_bits(uint8_t mods) {
+  return (mods & 0x10) ? (mods & 0x0F) << 4 : mods;
+}
+
+static uint16_t consumer_usage(uint8_t keycode) {
+  switch (keycode) {
+    case KC_AUDIO_MUTE:
+      return 0x00E2;
+    case KC_AUDIO_VOL_UP:
+      return 0x00E9;
+    case KC_AUDIO_VOL_DOWN:
+      return 0x00EA;
+    case KC_MEDIA_NEXT_TRACK:
+      return 0x00B5;
+    case KC_MEDIA_PREV_TRACK:
+      return 0x00B6;
+    case KC_MEDIA_STOP:
+      return 0x00B7;
+    case KC_MEDIA_PLAY_PAUSE:
+      return 0x00CD;
+  }
+  return 0;
+}
+
+void register_code(uint8_t keycode) {
+  if (IS_MODIFIER_KEYCODE(keycode)) {
+    set_mods(report.mods | 1 << (keycode - KC_LEFT_CTRL));
+  } else if (IS_CONSUMER_KEYCODE(keycode)) {
+    host_consumer_send(consumer_usage(keycode));
+  } else if (keycode > KC_TRANSPARENT && keycode <= KC_F24) {
+    // 6KRO, as with NKRO_ENABLE = no: a seventh key is dropped.
+    for (int i = 0; i < 6; ++i) {
+      if (report.keys[i] == keycode) {
+        return;
+      }
+    }
+    for (int i = 0; i < 6; ++i) {
+      if (report.keys[i] == KC_NO) {
+        report.keys[i] = keycode;
+        host_keyboard_send(&report);
+        return;
+      }
+    }
+  }
+}
+
+void unregister_code(uint8_t keycode) {
+  if (IS_MODIFIER_KEYCODE(keycode)) {
+    set_mods(report.mods & ~(1 << (keycode - KC_LEFT_CTRL)));
+  } else if (IS_CONSUMER_KEYCODE(keycode)) {
+    host_consumer_send(0);
+  } else {
+    for (int i = 0; i < 6; ++i) {
+      if (report.keys[i] == keycode && keycode != KC_NO) {
+        report.keys[i] = KC_NO;
+        host_keyboard_send(&report);
+        return;
+      }
+    }
+  }
+}
+
+void tap_code(uint8_t keycode) {
+  register_code(keycode);
+  unregister_code(keycode);
+}
+
+void register_code16(uint16_t keycode) {
+  if (IS_QK_MODS(keycode)) {
+    set_mods(report.mods | mod_bits(QK_MODS_GET_MODS(keycode)));
+  }
+  register_code(QK_MODS_GET_BASIC_KEYCODE(keycode));
+}
+
+void unregister_code16(uint16_t keycode) {
+  unregister_code(QK_MODS_GET_BASIC_KEYCODE(keycode));
+  if (IS_QK_MODS(keycode)) {
+    set_mods(report.mods & ~mod_bits(QK_MODS_GET_MODS(keycode)));
+  }
+}
+
+void tap_code16(uint16_t keycode) {
+  register_code16(keycode);
+  unregister_code16(keycode);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// SEND_STRING
+// ─────────────────────────────────────────────────────────────────────────────
+
+// US ANSI: the unshifted and shifted characters of the keys after KC_0
+static const char punctuation[] = "\n\x1b\b\t -=[]\\#;'`,./";
+static const char shifted_punctuation[] = "\n\x1b\b\t _+{}|\x7f:\"~<>?";
+static const char shifted_digits[] = "!@#$%^&*()";
+
+void send_char(char ascii_code) {
+  uint8_t keycode = KC_NO;
+  bool shift = false;
+  const char* p;
+  if (ascii_code >= 'a' && ascii_code <= 'z') {
+    keycode = KC_A + (ascii_code - 'a');
+  } else if (ascii_code >= 'A' && ascii_code <= 'Z') {
+    keycode = KC_A + (ascii_code - 'A');
+    shift = true;
+  } else if (ascii_code >= '1' && ascii_code <= '9') {
+    keycode = KC_1 + (ascii_code - '1');
+  } else if (ascii_code == '0') {
+    keycode = KC_0;
+  } else if (ascii_code == 0) {
+    return;
+  } else if ((p = strchr(shifted_digits, ascii_code)) != NULL) {
+    keycode = KC_1 + (p - shifted_digits);
+    shift = true;
+  } else if ((p = strchr(punctuation, ascii_code)) != NULL) {
+    keycode = KC_ENTER + (p - punctuation);
+  } else if ((p = strchr(shifted_punctuation, ascii_code)) != NULL) {
+    keycode = KC_ENTER + (p - shifted_punctuation);
+    shift = true;
+  }
+  if (keycode == KC_NO) {
+    return;
+  }
+  if (shift) {
+    register_code(KC_LEFT_SHIFT);
+  }
+  tap_code(keycode);
+  if (shift) {
+    unregister_code(KC_LEFT_SHIFT);
+  }
+}
+
+// send_string_with_delay_impl(), blocking on SS_DELAY as QMK does
+void send_string_P(const char* str) {
+  for (char c = (char)pgm_read_byte(str++); c != 0; c = (char)pgm_read_byte(str++)) {
+    if (c != SS_QMK_PREFIX) {
+      send_char(c);
+      continue;
+    }
+    c = (char)pgm_read_byte(str++);
+    if (c == SS_TAP_CODE) {
+      tap_code((uint8_t)pgm_read_byte(str++));
+    } else if (c == SS_DOWN_CODE) {
+      register_code((uint8_t)pgm_read_byte(str++));
+    } else if (c == SS_UP_CODE) {
+      unregister_code((uint8_t)pgm_read_byte(str++));
+    } else if (c == SS_DELAY_CODE) {
+      uint32_t ms = 0;
+      for (c = (char)pgm_read_byte(str++); c != '|'; c = (char)pgm_read_byte(str++)) {
+        ms = ms * 10 + c - '0';
+      }
+      wait_ms(ms);
+    }
+  }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// RGB matrix
+// ─────────────────────────────────────────────────────────────────────────────
+
+// color.c's integer conversion, without CIE1931 correction
+RGB hsv_to_rgb(HSV hsv) {
+  if (hsv.s == 0) {
+    return (RGB){hsv.v, hsv.v, hsv.v};
+  }
+  const uint16_t h = hsv.h, s = hsv.s, v = hsv.v;
+  const uint8_t region = h * 6 / 255;
+  const uint8_t remainder = (h * 2 - region * 85) * 3;
+  const uint8_t p = (v * (255 - s)) >> 8;
+  const uint8_t q = (v * (255 - ((s * remainder) >> 8))) >> 8;
+  const uint8_t t = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8;
+  switch (region) {
+    case 6:
+    case 0:
+      return (RGB){v, t, p};
+    case 1:
+      return (RGB){q, v, p};
+    case 2:
+      return (RGB){p, v, t};
+    case 3:
+      return (RGB){p, q, v};
+    case 4:
+      return (RGB){t, p, v};
+    default:
+      return (RGB){v, p, q};
+  }
+}
+
+void rgb_matrix_enable(void) {
+  rgb_matrix_config.enable = 1;
+}
+
+void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+  if (index >= 0 && index < RGB_MATRIX_LED_COUNT) {
+    rgb_matrix_frame[index] = (RGB){red, green, blue};
+  }
+}
+
+void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
+  for (int i = 0; i < RGB_MATRIX_LED_COUNT; ++i) {
+    rgb_matrix_frame[i] = (RGB){red, green, blue};
+  }
+}
+
+led_flags_t rgb_matrix_get_flags(void) {
+  return rgb_matrix_config.flags;
+}
+
+void rgblight_mode(uint8_t mode) {
+  rgb_matrix_config.mode = mode;
+}
@@ -0,0 +1,603 @@
+// layout.c — Runs a whole layout's keymap.c on the host, capturing its output
+//
+// Usage: layout_<LAYOUT> [-q] [TRACE]   (standard input if omitted)
+//
+// Built once per layout directory (make -C host layouts), with its config.h,
+// rules.mk features and SRC, on the quantum.h shim. Replays a text or binary
+// trace (trace_file.h) one 1 ms matrix scan at a time, as QMK's main loop
+// does: key events go through the tapping model (tapping.h), set up from
+// config.h, then a small action layer that stands in for QMK's:
+// pre_process_record_user(), process_record_user(), then, if it returns
+// true, basic and modded keys, mod-taps, layer keys, one-shot keys and tap
+// dances. Keycodes come from the layout's own keymaps, not the trace.
+//
+// Prints every HID keyboard report and consumer usage the keymap sends, and
+// every LED that rgb_matrix_indicators_user() changes, with the virtual time
+// it happened at:
+//   <time ms>  report <mods> <key> <key> <key> <key> <key> <key>
+//   <time ms>  consumer <usage>
+//   <time ms>  leds <index>=<rrggbb> ...
+// -q leaves them out. The wall-clock cost per call of process_record_user(),
+// split into macros (custom keycodes) and other keys, of tap dance callbacks,
+// housekeeping_task_user() and rgb_matrix_indicators_user() goes to
+// standard error, so standard output stays deterministic.
+//
+// Not modeled: combos, auto shift, caps word, repeat key, layer lock and
+// RGB effects; the LED frame is what the indicators paint over the last one.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "trace_file.h"
+#include "deadline.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// rgb_matrix.h: how often RGB frames are flushed, and indicators run
+#ifndef RGB_MATRIX_LED_FLUSH_LIMIT
+#define RGB_MATRIX_LED_FLUSH_LIMIT 16
+#endif
+
+#ifndef QUICK_TAP_TERM
+#define QUICK_TAP_TERM TAPPING_TERM
+#endif
+
+extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
+extern RGB rgb_matrix_frame[RGB_MATRIX_LED_COUNT];
+
+static uint32_t now = 0;
+static bool quiet = false;
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Timing
+// ─────────────────────────────────────────────────────────────────────────────
+
+typedef struct {
+  const char* name;
+  uint32_t calls;
+  uint64_t total;  // ns
+  uint64_t max;
+} stat_t;
+
+static stat_t record_stats = {.name = "process_record_user, keys"};
+static stat_t macro_stats = {.name = "process_record_user, macros"};
+static stat_t dance_stats = {.name = "tap dance callbacks"};
+static stat_t housekeeping_stats = {.name = "housekeeping_task_user"};
+static stat_t indicator_stats = {.name = "rgb_matrix_indicators_user"};
+
+static uint64_t nanoseconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void record_stat(stat_t* stat, uint64_t start) {
+  const uint64_t ns = nanoseconds() - start;
+  ++stat->calls;
+  stat->total += ns;
+  if (ns > stat->max) {
+    stat->max = ns;
+  }
+}
+
+#define MEASURE(stat, call)                 \
+  do {                                      \
+    const uint64_t start_ = nanoseconds();  \
+    call;                                   \
+    record_stat((stat), start_);            \
+  } while (0)
+
+static void print_stat(const stat_t* stat) {
+  fprintf(stderr, "%-30s %8lu calls  mean %8.0f ns  max %8lu ns\n", stat->name,
+          (unsigned long)stat->calls,
+          stat->calls ? (double)stat->total / stat->calls : 0.0,
+          (unsigned long)stat->max);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// QMK functions the keymap calls that keyboard.c leaves out
+// ─────────────────────────────────────────────────────────────────────────────
+
+uint16_t timer_read(void) {
+  return (uint16_t)now;
+}
+
+uint32_t timer_read32(void) {
+  return now;
+}
+
+void raw_hid_send(uint8_t* data, uint8_t length) {
+  (void)data;
+  (void)length;
+}
+
+// Blocks the main loop, as on the keyboard: SEND_STRING's SS_DELAY
+void wait_ms(uint32_t ms) {
+  now += ms;
+}
+
+__attribute__((weak)) uint16_t get_tapping_term(uint16_t keycode, keyrecord_t* record) {
+  (void)keycode;
+  (void)record;
+  return TAPPING_TERM;
+}
+
+__attribute__((weak)) bool pre_process_record_user(uint16_t keycode, keyrecord_t* record) {
+  (void)keycode;
+  (void)record;
+  return true;
+}
+
+__attribute__((weak)) void housekeeping_task_user(void) {}
+
+__attribute__((weak)) void keyboard_post_init_user(void) {}
+
+__attribute__((weak)) bool rgb_matrix_indicators_user(void) {
+  return true;
+}
+
+__attribute__((weak)) layer_state_t layer_state_set_user(layer_state_t state) {
+  return state;
+}
+
+__attribute__((weak)) layer_state_t default_layer_state_set_user(layer_state_t state) {
+  return state;
+}
+
+static bool in_matrix(keypos_t key) {
+  return key.row < MATRIX_ROWS && key.col < MATRIX_COLS;
+}
+
+// QMK's layer_switch_get_layer(): the highest active layer where `key` is
+// not transparent, else layer 0
+uint8_t layer_switch_get_layer(keypos_t key) {
+  if (!in_matrix(key)) {
+    return 0;
+  }
+  const layer_state_t state = layer_state | default_layer_state;
+  for (int layer = get_highest_layer(state); layer > 0; --layer) {
+    if ((state & (1 << layer)) &&
+        pgm_read_word(&keymaps[layer][key.row][key.col]) != KC_TRANSPARENT) {
+      return (uint8_t)layer;
+    }
+  }
+  return 0;
+}
+
+// The layer each key's press took its keycode from: a release goes where its
+// press went, whatever the layers have done since, as with QMK's layer cache.
+static uint8_t source_layers[MATRIX_ROWS][MATRIX_COLS];
+
+uint8_t read_source_layers_cache(keypos_t key) {
+  return in_matrix(key) ? source_layers[key.row][key.col] : 0;
+}
+
+static uint16_t record_keycode(const keyrecord_t* record) {
+  const keypos_t key = record->event.key;
+  if (!in_matrix(key)) {
+    return KC_NO;
+  }
+  if (record->event.pressed) {
+    source_layers[key.row][key.col] = layer_switch_get_layer(key);
+  }
+  return pgm_read_word(&keymaps[read_source_layers_cache(key)][key.row][key.col]);
+}
+
+#ifdef CHORDAL_HOLD
+static char hand(keypos_t key) {
+  return in_matrix(key) ? (char)pgm_read_byte(&chordal_hold_layout[key.row][key.col]) : '*';
+}
+#endif
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Capture
+// ─────────────────────────────────────────────────────────────────────────────
+
+static uint32_t reports = 0;
+static uint32_t led_changes = 0;
+static RGB shown[RGB_MATRIX_LED_COUNT];
+
+void host_keyboard_send(const report_keyboard_t* report) {
+  ++reports;
+  if (!quiet) {
+    printf("%8lu  report %02x", (unsigned long)now, report->mods);
+    for (int i = 0; i < 6; ++i) {
+      printf(" %02x", report->keys[i]);
+    }
+    printf("\n");
+  }
+}
+
+void host_consumer_send(uint16_t usage) {
+  ++reports;
+  if (!quiet) {
+    printf("%8lu  consumer %04x\n", (unsigned long)now, usage);
+  }
+}
+
+// Prints the LEDs that changed since the last frame.
+static void flush_frame(void) {
+  bool any = false;
+  for (int i = 0; i < RGB_MATRIX_LED_COUNT; ++i) {
+    const RGB c = rgb_matrix_frame[i];
+    if (c.r == shown[i].r && c.g == shown[i].g && c.b == shown[i].b) {
+      continue;
+    }
+    shown[i] = c;
+    ++led_changes;
+    if (quiet) {
+      continue;
+    }
+    if (!any) {
+      printf("%8lu  leds", (unsigned long)now);
+      any = true;
+    }
+    printf(" %d=%02x%02x%02x", i, c.r, c.g, c.b);
+  }
+  if (any) {
+    printf("\n");
+  }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Layers and one-shot keys
+// ─────────────────────────────────────────────────────────────────────────────
+
+// Every layer change goes through the keymap's hook, as in QMK.
+static void layer_state_set(layer_state_t state) {
+  layer_state = layer_state_set_user(state);
+}
+
+static void layer_on(uint8_t layer) {
+  layer_state_set(layer_state | (layer_state_t)(1 << layer));
+}
+
+static void layer_off(uint8_t layer) {
+  layer_state_set(layer_state & (layer_state_t) ~(1 << layer));
+}
+
+// The 8-bit mods of a 5-bit mod encoding
+static uint8_t mod_bits(uint8_t mods) {
+  return (mods & 0x10) ? (mods & 0x0F) << 4 : mods;
+}
+
+// One-shot layer and mods, for the next key pressed, until its release
+static int8_t oneshot_layer = -1;
+static uint8_t oneshot_mods = 0;
+static bool oneshot_used = false;
+static keypos_t oneshot_key;  // The key that used them, if `oneshot_used`
+
+static void oneshot_press(uint16_t keycode, keypos_t key) {
+  if ((oneshot_layer >= 0 || oneshot_mods) && !oneshot_used && keycode < QK_ONE_SHOT_LAYER) {
+    oneshot_used = true;
+    oneshot_key = key;
+  }
+}
+
+static void oneshot_release(keypos_t key) {
+  if (!oneshot_used || key.row != oneshot_key.row || key.col != oneshot_key.col) {
+    return;
+  }
+  if (oneshot_layer >= 0) {
+    layer_off(oneshot_layer);
+    oneshot_layer = -1;
+  }
+  if (oneshot_mods) {
+    unregister_mods(oneshot_mods);
+    oneshot_mods = 0;
+  }
+  oneshot_used = false;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Tap dance, as process_tap_dance.c
+// ─────────────────────────────────────────────────────────────────────────────
+
+#ifdef TAP_DANCE_ENABLE
+extern tap_dance_action_t tap_dance_actions[];
+
+static tap_dance_action_t* active_dance = NULL;
+static uint16_t active_dance_keycode = KC_NO;
+static keyrecord_t active_dance_record;
+static uint32_t active_dance_time = 0;  // Of its last press
+
+static void dance_call(tap_dance_user_fn_t fn, tap_dance_action_t* action) {
+  if (fn != NULL) {
+    MEASURE(&dance_stats, fn(&action->state, action->user_data));
+  }
+}
+
+static void dance_reset(tap_dance_action_t* action) {
+  dance_call(action->fn.on_reset, action);
+  action->state = (tap_dance_state_t){0};
+  if (action == active_dance) {
+    active_dance = NULL;
+  }
+}
+
+static void dance_finish(tap_dance_action_t* action) {
+  if (action->state.finished) {
+    return;
+  }
+  action->state.finished = true;
+  dance_call(action->fn.on_dance_finished, action);
+  if (!action->state.pressed) {
+    dance_reset(action);
+  }
+}
+
+// Any other key pressed interrupts the dance in progress.
+static void dance_preprocess(uint16_t keycode, keyrecord_t* record) {
+  if (active_dance != NULL && record->event.pressed && keycode != active_dance_keycode) {
+    active_dance->state.interrupted = true;
+    active_dance->state.interrupting_keycode = keycode;
+    dance_finish(active_dance);
+  }
+}
+
+static void dance_process(uint16_t keycode, keyrecord_t* record) {
+  tap_dance_action_t* action = &tap_dance_actions[keycode - QK_TAP_DANCE];
+  if (record->event.pressed) {
+    action->state.pressed = true;
+    ++action->state.count;
+    active_dance = action;
+    active_dance_keycode = keycode;
+    active_dance_record = *record;
+    active_dance_time = now;
+    dance_call(action->fn.on_each_tap, action);
+  } else {
+    action->state.pressed = false;
+    dance_call(action->fn.on_each_release, action);
+    if (action->state.finished) {
+      dance_reset(action);
+    }
+  }
+}
+
+// Ends a dance once its tapping term passes with no new tap.
+static void dance_task(void) {
+  if (active_dance != NULL && !active_dance->state.finished &&
+      now - active_dance_time >= get_tapping_term(active_dance_keycode, &active_dance_record)) {
+    dance_finish(active_dance);
+  }
+}
+
+static bool dance_pending(void) {
+  return active_dance != NULL;
+}
+#else
+static void dance_preprocess(uint16_t keycode, keyrecord_t* record) {
+  (void)keycode;
+  (void)record;
+}
+static void dance_process(uint16_t keycode, keyrecord_t* record) {
+  (void)keycode;
+  (void)record;
+}
+static void dance_task(void) {}
+static bool dance_pending(void) {
+  return false;
+}
+#endif
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Actions
+// ─────────────────────────────────────────────────────────────────────────────
+
+// What QMK does with a keycode process_record_user() lets through
+static void process_action(uint16_t keycode, keyrecord_t* record) {
+  const bool pressed = record->event.pressed;
+  if (keycode <= QK_MODS_MAX) {
+    if (pressed) {
+      register_code16(keycode);
+    } else {
+      unregister_code16(keycode);
+    }
+  } else if (IS_QK_MOD_TAP(keycode)) {
+    if (record->tap.count > 0) {
+      process_action(QK_MOD_TAP_GET_TAP_KEYCODE(keycode), record);
+    } else if (pressed) {
+      register_mods(mod_bits(QK_MOD_TAP_GET_MODS(keycode)));
+    } else {
+      unregister_mods(mod_bits(QK_MOD_TAP_GET_MODS(keycode)));
+    }
+  } else if (IS_QK_LAYER_TAP(keycode)) {
+    if (record->tap.count > 0) {
+      process_action(QK_LAYER_TAP_GET_TAP_KEYCODE(keycode), record);
+    } else if (pressed) {
+      layer_on(QK_LAYER_TAP_GET_LAYER(keycode));
+    } else {
+      layer_off(QK_LAYER_TAP_GET_LAYER(keycode));
+    }
+  } else if (keycode >= QK_TO && keycode < QK_TO + 0x20) {
+    if (pressed) {
+      layer_state_set((layer_state_t)(1 << (keycode & 0x1F)));
+    }
+  } else if (keycode >= QK_MOMENTARY && keycode < QK_MOMENTARY + 0x20) {
+    if (pressed) {
+      layer_on(keycode & 0x1F);
+    } else {
+      layer_off(keycode & 0x1F);
+    }
+  } else if (keycode >= QK_DEF_LAYER && keycode < QK_DEF_LAYER + 0x20) {
+    if (pressed) {
+      default_layer_state = default_layer_state_set_user((layer_state_t)(1 << (keycode & 0x1F)));
+    }
+  } else if (keycode >= QK_TOGGLE_LAYER && keycode < QK_TOGGLE_LAYER + 0x20) {
+    if (pressed) {
+      layer_state_set(layer_state ^ (layer_state_t)(1 << (keycode & 0x1F)));
+    }
+  } else if (keycode >= QK_ONE_SHOT_LAYER && keycode < QK_ONE_SHOT_LAYER + 0x20) {
+    if (pressed) {
+      oneshot_layer = keycode & 0x1F;
+      layer_on(oneshot_layer);
+    }
+  } else if (keycode >= QK_ONE_SHOT_MOD && keycode < QK_ONE_SHOT_MOD + 0x20) {
+    if (pressed) {
+      oneshot_mods |= mod_bits(keycode & 0x1F);
+      register_mods(oneshot_mods);
+    }
+  } else if (IS_QK_TAP_DANCE(keycode)) {
+    dance_process(keycode, record);
+  }
+}
+
+// QMK's process_record(): also where Achordion replays settled events
+void process_record(keyrecord_t* record) {
+  const uint16_t keycode = record_keycode(record);
+  dance_preprocess(keycode, record);
+  if (record->event.pressed) {
+    oneshot_press(keycode, record->event.key);
+  }
+
+  bool pass;
+  MEASURE(keycode >= SAFE_RANGE ? &macro_stats : &record_stats,
+          pass = process_record_user(keycode, record));
+  if (pass) {
+    process_action(keycode, record);
+  }
+
+  if (!record->event.pressed) {
+    oneshot_release(record->event.key);
+  }
+}
+
+static void deliver(uint16_t keycode, keyrecord_t* record) {
+  (void)keycode;
+  process_record(record);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Main loop
+// ─────────────────────────────────────────────────────────────────────────────
+
+static void scan(void) {
+  deadline_task();
+  dance_task();
+  MEASURE(&housekeeping_stats, housekeeping_task_user());
+  if (now % RGB_MATRIX_LED_FLUSH_LIMIT == 0) {
+    MEASURE(&indicator_stats, rgb_matrix_indicators_user());
+    flush_frame();
+  }
+}
+
+static void feed(const harness_input_t* input) {
+  keyrecord_t record = {
+      .event =
+          {
+              .key = {.col = input->col, .row = input->row},
+              .time = (uint16_t)now,
+              .type = KEY_EVENT,
+              .pressed = input->pressed,
+          },
+  };
+  const uint16_t keycode = record_keycode(&record);
+  if (pre_process_record_user(keycode, &record)) {
+    tapping_process(keycode, &record);
+  }
+}
+
+// The trace being replayed, binary or text
+static trace_reader_t binary;
+static bool is_binary = false;
+static FILE* in = NULL;
+static const char* path = NULL;
+static unsigned line_number = 0;
+
+// Reads the next event into `input`. Returns 1 on success, 0 at the end, -1
+// on error after printing it.
+static int next_input(harness_input_t* input, uint32_t inputs) {
+  if (!is_binary) {
+    return trace_read_text(in, input, NULL, 0, &line_number);
+  }
+  if (trace_next(&binary, input)) {
+    return 1;
+  }
+  if (binary.error) {
+    fprintf(stderr, "%s: truncated at event %lu\n", path, (unsigned long)inputs);
+    return -1;
+  }
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  int arg = 1;
+  if (arg < argc && strcmp(argv[arg], "-q") == 0) {
+    quiet = true;
+    ++arg;
+  }
+  path = arg < argc ? argv[arg] : NULL;
+
+  in = stdin;
+  if (path != NULL) {
+    is_binary = trace_open(&binary, path);
+    if (!is_binary && (errno != EINVAL || (in = fopen(path, "r")) == NULL)) {
+      perror(path);
+      return 1;
+    }
+  }
+
+  const tapping_config_t tapping = {
+#ifdef FLOW_TAP_TERM
+      .flow_tap_term = FLOW_TAP_TERM,
+#endif
+      .quick_tap_term = QUICK_TAP_TERM,
+#ifdef PERMISSIVE_HOLD
+      .permissive_hold = true,
+#endif
+#ifdef CHORDAL_HOLD
+      .chordal_hold = true,
+      .hand = hand,
+#endif
+      .tapping_term = get_tapping_term,
+  };
+  tapping_reset(&tapping, deliver);
+  keyboard_post_init_user();
+
+  uint32_t inputs = 0;
+  harness_input_t input;
+  int status = next_input(&input, inputs);
+  if (status > 0) {
+    now = input.time;
+  }
+  const uint64_t start = nanoseconds();
+  // One scan per ms; the events of a ms come in at the start of its scan.
+  while (status > 0) {
+    for (; status > 0 && !deadline_before(now, input.time); ++inputs) {
+      feed(&input);
+      status = next_input(&input, inputs + 1);
+    }
+    scan();
+    ++now;
+  }
+  if (status < 0) {
+    return 1;
+  }
+  // Until every deadline and dance has played out, then one more frame
+  for (; deadline_pending() || dance_pending(); ++now) {
+    scan();
+  }
+  for (; now % RGB_MATRIX_LED_FLUSH_LIMIT != 0; ++now) {
+    scan();
+  }
+  scan();
+  const double elapsed = (nanoseconds() - start) * 1e-9;
+
+  if (is_binary) {
+    trace_close(&binary);
+  }
+
+  if (!quiet) {
+    printf("# %lu events in, %lu reports out, %lu LED changes\n", (unsigned long)inputs,
+           (unsigned long)reports, (unsigned long)led_changes);
+  }
+  print_stat(&record_stats);
+  print_stat(&macro_stats);
+  print_stat(&dance_stats);
+  print_stat(&housekeeping_stats);
+  print_stat(&indicator_stats);
+  fprintf(stderr, "replayed %lu events over %lu ms in %.3f ms\n", (unsigned long)inputs,
+          (unsigned long)now, elapsed * 1e3);
+  return 0;
+}
@@ -0,0 +1,26 @@
+// quantum.c — QMK state shared by every host build
+
+#include "quantum.h"
+
+layer_state_t layer_state = 0;
+layer_state_t default_layer_state = 1;
+
+#ifdef ORYX_ENABLE
+rawhid_state_t rawhid_state = {0};
+#endif
+
+uint8_t get_highest_layer(layer_state_t state) {
+  uint8_t layer = 0;
+  while (state >>= 1) {
+    ++layer;
+  }
+  return layer;
+}
+
+uint8_t biton32(uint32_t bits) {
+  uint8_t n = 0;
+  while (bits >>= 1) {
+    ++n;
+  }
+  return n;
+}
@@ -0,0 +1,499 @@
+// quantum.h — Host shim of the QMK API used by Achordion and the keymaps
+//
+// Lets achordion.c, deadline.c and friends, and a layout's whole keymap.c,
+// compile unmodified on the host. Types, keycode encodings and mod bits
+// match QMK; functions are declared here and defined by whoever links the
+// code: host/quantum.c for the shared state, host/keyboard.c for the HID
+// reports and LEDs keymap.c drives, host/harness.c (or a test's own mocks)
+// for the clock, process_record() and mods.
+//
+// Only for host builds: keep this directory out of the firmware's include
+// path, where it would shadow the real quantum.h.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ZSA Voyager: a split keyboard, 6 rows of 7 columns per side.
+#ifndef MATRIX_ROWS
+#define MATRIX_ROWS 12
+#define MATRIX_COLS 7
+#define SPLIT_KEYBOARD
+#endif
+
+typedef uint8_t matrix_row_t;
+
+// action_tapping.h
+#ifndef TAPPING_TERM
+#define TAPPING_TERM 200
+#endif
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Events
+// ─────────────────────────────────────────────────────────────────────────────
+
+typedef struct {
+  uint8_t col;
+  uint8_t row;
+} keypos_t;
+
+typedef enum {
+  TICK_EVENT = 0,
+  KEY_EVENT = 1,
+  ENCODER_CW_EVENT = 2,
+  ENCODER_CCW_EVENT = 3,
+  COMBO_EVENT = 4,
+} keyevent_type_t;
+
+typedef struct {
+  keypos_t key;
+  uint16_t time;
+  keyevent_type_t type;
+  bool pressed;
+} keyevent_t;
+
+typedef struct {
+  bool interrupted : 1;
+  bool reserved2 : 1;
+  bool reserved1 : 1;
+  bool reserved0 : 1;
+  uint8_t count : 4;
+} tap_t;
+
+typedef struct {
+  keyevent_t event;
+  tap_t tap;
+#if defined(COMBO_ENABLE) || defined(REPEAT_KEY_ENABLE)
+  uint16_t keycode;
+#endif
+} keyrecord_t;
+
+#define IS_KEYEVENT(event) ((event).type == KEY_EVENT)
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Keycodes
+// ─────────────────────────────────────────────────────────────────────────────
+
+enum {
+  KC_NO = 0x00,
+  KC_TRANSPARENT = 0x01,
+  KC_A = 0x04, KC_B, KC_C, KC_D, KC_E, KC_F, KC_G, KC_H, KC_I, KC_J, KC_K,
+  KC_L, KC_M, KC_N, KC_O, KC_P, KC_Q, KC_R, KC_S, KC_T, KC_U, KC_V, KC_W,
+  KC_X, KC_Y, KC_Z,
+  KC_1, KC_2, KC_3, KC_4, KC_5, KC_6, KC_7, KC_8, KC_9, KC_0,
+  KC_ENTER, KC_ESCAPE, KC_BACKSPACE, KC_TAB, KC_SPACE,
+  KC_MINUS, KC_EQUAL, KC_LEFT_BRACKET, KC_RIGHT_BRACKET, KC_BACKSLASH,
+  KC_NONUS_HASH, KC_SEMICOLON, KC_QUOTE, KC_GRAVE, KC_COMMA, KC_DOT, KC_SLASH,
+  KC_CAPS_LOCK,
+  KC_F1, KC_F2, KC_F3, KC_F4, KC_F5, KC_F6, KC_F7, KC_F8, KC_F9, KC_F10,
+  KC_F11, KC_F12,
+  KC_PRINT_SCREEN, KC_SCROLL_LOCK, KC_PAUSE, KC_INSERT, KC_HOME, KC_PAGE_UP,
+  KC_DELETE, KC_END, KC_PAGE_DOWN, KC_RIGHT, KC_LEFT, KC_DOWN, KC_UP,
+  KC_NUM_LOCK, KC_KP_SLASH, KC_KP_ASTERISK, KC_KP_MINUS, KC_KP_PLUS,
+  KC_KP_ENTER, KC_KP_1, KC_KP_2, KC_KP_3, KC_KP_4, KC_KP_5, KC_KP_6, KC_KP_7,
+  KC_KP_8, KC_KP_9, KC_KP_0, KC_KP_DOT, KC_NONUS_BACKSLASH, KC_APPLICATION,
+  KC_KB_POWER, KC_KP_EQUAL,
+  KC_F13, KC_F14, KC_F15, KC_F16, KC_F17, KC_F18, KC_F19, KC_F20, KC_F21,
+  KC_F22, KC_F23, KC_F24,
+  // Consumer keys, sent as usages of their own report
+  KC_AUDIO_MUTE = 0xA8, KC_AUDIO_VOL_UP, KC_AUDIO_VOL_DOWN,
+  KC_MEDIA_NEXT_TRACK, KC_MEDIA_PREV_TRACK, KC_MEDIA_STOP,
+  KC_MEDIA_PLAY_PAUSE,
+  KC_MS_UP = 0xCD, KC_MS_DOWN, KC_MS_LEFT, KC_MS_RIGHT, KC_MS_BTN1,
+  KC_MS_BTN2, KC_MS_BTN3,
+  KC_LEFT_CTRL = 0xE0, KC_LEFT_SHIFT, KC_LEFT_ALT, KC_LEFT_GUI,
+  KC_RIGHT_CTRL, KC_RIGHT_SHIFT, KC_RIGHT_ALT, KC_RIGHT_GUI,
+};
+#define KC_TRNS KC_TRANSPARENT
+#define _______ KC_TRANSPARENT
+#define XXXXXXX KC_NO
+#define KC_ENT KC_ENTER
+#define KC_ESC KC_ESCAPE
+#define KC_BSPC KC_BACKSPACE
+#define KC_SPC KC_SPACE
+#define KC_MINS KC_MINUS
+#define KC_EQL KC_EQUAL
+#define KC_LBRC KC_LEFT_BRACKET
+#define KC_RBRC KC_RIGHT_BRACKET
+#define KC_BSLS KC_BACKSLASH
+#define KC_SCLN KC_SEMICOLON
+#define KC_QUOT KC_QUOTE
+#define KC_GRV KC_GRAVE
+#define KC_COMM KC_COMMA
+#define KC_SLSH KC_SLASH
+#define KC_CAPS KC_CAPS_LOCK
+#define KC_DEL KC_DELETE
+#define KC_PGUP KC_PAGE_UP
+#define KC_PGDN KC_PAGE_DOWN
+#define KC_APP KC_APPLICATION
+#define KC_PSLS KC_KP_SLASH
+#define KC_PAST KC_KP_ASTERISK
+#define KC_PMNS KC_KP_MINUS
+#define KC_PPLS KC_KP_PLUS
+#define KC_PEQL KC_KP_EQUAL
+#define KC_LCTL KC_LEFT_CTRL
+#define KC_LSFT KC_LEFT_SHIFT
+#define KC_LALT KC_LEFT_ALT
+#define KC_LGUI KC_LEFT_GUI
+#define KC_RCTL KC_RIGHT_CTRL
+#define KC_RSFT KC_RIGHT_SHIFT
+#define KC_RALT KC_RIGHT_ALT
+#define KC_RGUI KC_RIGHT_GUI
+
+#define IS_MODIFIER_KEYCODE(kc) ((kc) >= KC_LEFT_CTRL && (kc) <= KC_RIGHT_GUI)
+#define IS_CONSUMER_KEYCODE(kc) ((kc) >= KC_AUDIO_MUTE && (kc) <= KC_MEDIA_PLAY_PAUSE)
+
+// Modifier wrappers: mods in the high byte of a basic keycode
+#define QK_MODS 0x0100
+#define QK_MODS_MAX 0x1FFF
+#define QK_LCTL 0x0100
+#define QK_LSFT 0x0200
+#define QK_LALT 0x0400
+#define QK_LGUI 0x0800
+#define QK_RMODS_MIN 0x1000
+#define QK_RCTL 0x1100
+#define QK_RSFT 0x1200
+#define QK_RALT 0x1400
+#define QK_RGUI 0x1800
+#define IS_QK_MODS(kc) ((kc) >= QK_MODS && (kc) <= QK_MODS_MAX)
+#define QK_MODS_GET_MODS(kc) (((kc) >> 8) & 0x1F)
+#define QK_MODS_GET_BASIC_KEYCODE(kc) ((kc) & 0xFF)
+
+#define LCTL(kc) (QK_LCTL | (kc))
+#define LSFT(kc) (QK_LSFT | (kc))
+#define LALT(kc) (QK_LALT | (kc))
+#define LGUI(kc) (QK_LGUI | (kc))
+#define RCTL(kc) (QK_RCTL | (kc))
+#define RSFT(kc) (QK_RSFT | (kc))
+#define RALT(kc) (QK_RALT | (kc))
+#define RGUI(kc) (QK_RGUI | (kc))
+#define S(kc) LSFT(kc)
+#define MEH(kc) (QK_LCTL | QK_LSFT | QK_LALT | (kc))
+#define HYPR(kc) (QK_LCTL | QK_LSFT | QK_LALT | QK_LGUI | (kc))
+#define KC_MEH MEH(KC_NO)
+#define KC_HYPR HYPR(KC_NO)
+
+#define KC_TILD S(KC_GRAVE)
+#define KC_EXLM S(KC_1)
+#define KC_AT S(KC_2)
+#define KC_HASH S(KC_3)
+#define KC_DLR S(KC_4)
+#define KC_PERC S(KC_5)
+#define KC_CIRC S(KC_6)
+#define KC_AMPR S(KC_7)
+#define KC_ASTR S(KC_8)
+#define KC_LPRN S(KC_9)
+#define KC_RPRN S(KC_0)
+#define KC_UNDS S(KC_MINUS)
+#define KC_PLUS S(KC_EQUAL)
+#define KC_LCBR S(KC_LEFT_BRACKET)
+#define KC_RCBR S(KC_RIGHT_BRACKET)
+#define KC_PIPE S(KC_BACKSLASH)
+#define KC_COLN S(KC_SEMICOLON)
+#define KC_DQUO S(KC_QUOTE)
+#define KC_LABK S(KC_COMMA)
+#define KC_RABK S(KC_DOT)
+#define KC_QUES S(KC_SLASH)
+
+#define QK_MOD_TAP 0x2000
+#define QK_MOD_TAP_MAX 0x3FFF
+#define QK_LAYER_TAP 0x4000
+#define QK_LAYER_TAP_MAX 0x4FFF
+
+#define IS_QK_MOD_TAP(kc) ((kc) >= QK_MOD_TAP && (kc) <= QK_MOD_TAP_MAX)
+#define IS_QK_LAYER_TAP(kc) ((kc) >= QK_LAYER_TAP && (kc) <= QK_LAYER_TAP_MAX)
+#define QK_MOD_TAP_GET_MODS(kc) (((kc) >> 8) & 0x1F)
+#define QK_MOD_TAP_GET_TAP_KEYCODE(kc) ((kc) & 0xFF)
+#define QK_LAYER_TAP_GET_LAYER(kc) (((kc) >> 8) & 0xF)
+#define QK_LAYER_TAP_GET_TAP_KEYCODE(kc) ((kc) & 0xFF)
+
+#define MT(mod, kc) (QK_MOD_TAP | (((mod) & 0x1F) << 8) | ((kc) & 0xFF))
+#define LT(layer, kc) (QK_LAYER_TAP | (((layer) & 0xF) << 8) | ((kc) & 0xFF))
+
+// Layer, one-shot, tap dance and quantum keycodes
+#define QK_TO 0x5200
+#define QK_MOMENTARY 0x5220
+#define QK_DEF_LAYER 0x5240
+#define QK_TOGGLE_LAYER 0x5260
+#define QK_ONE_SHOT_LAYER 0x5280
+#define QK_ONE_SHOT_MOD 0x52A0
+#define QK_TAP_DANCE 0x5700
+#define QK_TAP_DANCE_MAX 0x57FF
+#define QK_BOOT 0x7C00
+#define QK_CAPS_WORD_TOGGLE 0x7C73
+#define QK_LAYER_LOCK 0x7C7B
+#define QK_USER 0x7E40
+#define SAFE_RANGE QK_USER
+
+#define TO(layer) (QK_TO | ((layer) & 0x1F))
+#define MO(layer) (QK_MOMENTARY | ((layer) & 0x1F))
+#define DF(layer) (QK_DEF_LAYER | ((layer) & 0x1F))
+#define TG(layer) (QK_TOGGLE_LAYER | ((layer) & 0x1F))
+#define OSL(layer) (QK_ONE_SHOT_LAYER | ((layer) & 0x1F))
+#define OSM(mod) (QK_ONE_SHOT_MOD | ((mod) & 0x1F))
+#define TD(index) (QK_TAP_DANCE | ((index) & 0xFF))
+#define IS_QK_TAP_DANCE(kc) ((kc) >= QK_TAP_DANCE && (kc) <= QK_TAP_DANCE_MAX)
+#define CW_TOGG QK_CAPS_WORD_TOGGLE
+#define QK_LLCK QK_LAYER_LOCK
+
+// 5-bit mod encoding of mod-tap keys
+#define MOD_LCTL 0x01
+#define MOD_LSFT 0x02
+#define MOD_LALT 0x04
+#define MOD_LGUI 0x08
+#define MOD_RCTL 0x11
+#define MOD_RSFT 0x12
+#define MOD_RALT 0x14
+#define MOD_RGUI 0x18
+#define MOD_MEH 0x07
+#define MOD_HYPR 0x0F
+
+// No mod swapping on the host
+static inline uint8_t mod_config(uint8_t mod) {
+  return mod;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Flash, layers, timer, actions
+// ─────────────────────────────────────────────────────────────────────────────
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+
+typedef uint8_t layer_state_t;  // LAYER_STATE_8BIT
+extern layer_state_t layer_state;
+extern layer_state_t default_layer_state;
+uint8_t get_highest_layer(layer_state_t state);
+// Implemented by layout builds: the layer `key`'s keycode comes from now, and
+// the one its press took it from
+uint8_t layer_switch_get_layer(keypos_t key);
+uint8_t read_source_layers_cache(keypos_t key);
+
+uint16_t timer_read(void);
+uint32_t timer_read32(void);
+#define timer_elapsed(last) ((uint16_t)(timer_read() - (last)))
+#define timer_elapsed32(last) (timer_read32() - (last))
+
+void process_record(keyrecord_t* record);
+void register_mods(uint8_t mods);
+void unregister_mods(uint8_t mods);
+
+#ifdef ORYX_ENABLE
+// oryx.h
+typedef struct {
+  bool paired;
+  bool rgb_control;
+} rawhid_state_t;
+extern rawhid_state_t rawhid_state;
+#endif
+
+#ifdef CHORDAL_HOLD
+extern const char chordal_hold_layout[MATRIX_ROWS][MATRIX_COLS] PROGMEM;
+#endif
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Keymap API: HID reports, SEND_STRING, combos, tap dance, RGB matrix
+// ─────────────────────────────────────────────────────────────────────────────
+
+typedef struct {
+  uint8_t mods;
+  uint8_t reserved;
+  uint8_t keys[6];
+} report_keyboard_t;
+
+void register_code(uint8_t keycode);
+void unregister_code(uint8_t keycode);
+void tap_code(uint8_t keycode);
+void register_code16(uint16_t keycode);
+void unregister_code16(uint16_t keycode);
+void tap_code16(uint16_t keycode);
+void send_char(char ascii_code);
+void send_string_P(const char* str);
+void wait_ms(uint32_t ms);
+
+// Where reports go when they change; weak no-ops in host/keyboard.c
+void host_keyboard_send(const report_keyboard_t* report);
+void host_consumer_send(uint16_t usage);
+
+// send_string_keycodes.h: SS_TAP(X_A) is "\1\1\x04"
+#define SS_QMK_PREFIX 1
+#define SS_TAP_CODE 1
+#define SS_DOWN_CODE 2
+#define SS_UP_CODE 3
+#define SS_DELAY_CODE 4
+#define STRINGIZE(z) #z
+#define ADD_SLASH_X(y) STRINGIZE(\x##y)
+#define SS_TAP(keycode) "\1\1" ADD_SLASH_X(keycode)
+#define SS_DOWN(keycode) "\1\2" ADD_SLASH_X(keycode)
+#define SS_UP(keycode) "\1\3" ADD_SLASH_X(keycode)
+#define SS_DELAY(msecs) "\1\4" STRINGIZE(msecs) "|"
+#define SS_LCTL(string) SS_DOWN(X_LCTL) string SS_UP(X_LCTL)
+#define SS_LSFT(string) SS_DOWN(X_LSFT) string SS_UP(X_LSFT)
+#define SS_LALT(string) SS_DOWN(X_LALT) string SS_UP(X_LALT)
+#define SS_LGUI(string) SS_DOWN(X_LGUI) string SS_UP(X_LGUI)
+#define SEND_STRING(string) send_string_P(PSTR(string))
+
+// Two hex digits per basic keycode, as SS_TAP() pastes them
+#define X_A 04
+#define X_B 05
+#define X_C 06
+#define X_D 07
+#define X_E 08
+#define X_F 09
+#define X_G 0a
+#define X_H 0b
+#define X_I 0c
+#define X_J 0d
+#define X_K 0e
+#define X_L 0f
+#define X_M 10
+#define X_N 11
+#define X_O 12
+#define X_P 13
+#define X_Q 14
+#define X_R 15
+#define X_S 16
+#define X_T 17
+#define X_U 18
+#define X_V 19
+#define X_W 1a
+#define X_X 1b
+#define X_Y 1c
+#define X_Z 1d
+#define X_1 1e
+#define X_2 1f
+#define X_3 20
+#define X_4 21
+#define X_5 22
+#define X_6 23
+#define X_7 24
+#define X_8 25
+#define X_9 26
+#define X_0 27
+#define X_ENTER 28
+#define X_ESCAPE 29
+#define X_BACKSPACE 2a
+#define X_TAB 2b
+#define X_SPACE 2c
+#define X_MINUS 2d
+#define X_EQUAL 2e
+#define X_LEFT_BRACKET 2f
+#define X_RIGHT_BRACKET 30
+#define X_BACKSLASH 31
+#define X_SEMICOLON 33
+#define X_QUOTE 34
+#define X_GRAVE 35
+#define X_COMMA 36
+#define X_DOT 37
+#define X_SLASH 38
+#define X_RIGHT 4f
+#define X_LEFT 50
+#define X_DOWN 51
+#define X_UP 52
+#define X_LEFT_CTRL e0
+#define X_LEFT_SHIFT e1
+#define X_LEFT_ALT e2
+#define X_LEFT_GUI e3
+#define X_ENT X_ENTER
+#define X_ESC X_ESCAPE
+#define X_BSPC X_BACKSPACE
+#define X_SPC X_SPACE
+#define X_MINS X_MINUS
+#define X_SCLN X_SEMICOLON
+#define X_QUOT X_QUOTE
+#define X_COMM X_COMMA
+#define X_SLSH X_SLASH
+#define X_LCTL X_LEFT_CTRL
+#define X_LSFT X_LEFT_SHIFT
+#define X_LALT X_LEFT_ALT
+#define X_LGUI X_LEFT_GUI
+
+// process_combo.h
+typedef struct {
+  const uint16_t* keys;
+  uint16_t keycode;
+} combo_t;
+
+#define COMBO(ck, ca) {.keys = &(ck)[0], .keycode = (ca)}
+#define COMBO_END 0
+
+// process_tap_dance.h
+typedef struct {
+  uint16_t interrupting_keycode;
+  uint8_t count;
+  uint8_t weak_mods;
+  bool pressed : 1;
+  bool finished : 1;
+  bool interrupted : 1;
+} tap_dance_state_t;
+
+typedef void (*tap_dance_user_fn_t)(tap_dance_state_t* state, void* user_data);
+
+typedef struct {
+  tap_dance_state_t state;
+  struct {
+    tap_dance_user_fn_t on_each_tap;
+    tap_dance_user_fn_t on_dance_finished;
+    tap_dance_user_fn_t on_reset;
+    tap_dance_user_fn_t on_each_release;
+  } fn;
+  void* user_data;
+} tap_dance_action_t;
+
+#define ACTION_TAP_DANCE_FN_ADVANCED(each_tap, finished, reset) \
+  {.fn = {each_tap, finished, reset, NULL}, .user_data = NULL}
+
+// color.h and rgb_matrix.h
+typedef struct {
+  uint8_t h;
+  uint8_t s;
+  uint8_t v;
+} HSV;
+
+typedef struct {
+  uint8_t r;
+  uint8_t g;
+  uint8_t b;
+} RGB;
+
+typedef uint8_t led_flags_t;
+#define LED_FLAG_NONE 0x00
+#define LED_FLAG_ALL 0xFF
+
+typedef struct {
+  uint8_t enable;
+  uint8_t mode;
+  HSV hsv;
+  uint8_t speed;
+  led_flags_t flags;
+} rgb_config_t;
+
+extern rgb_config_t rgb_matrix_config;
+
+RGB hsv_to_rgb(HSV hsv);
+void rgb_matrix_enable(void);
+void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue);
+void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue);
+led_flags_t rgb_matrix_get_flags(void);
+void rgblight_mode(uint8_t mode);
+
+uint8_t biton32(uint32_t bits);
+
+// Keymap hooks QMK calls
+bool process_record_user(uint16_t keycode, keyrecord_t* record);
+bool pre_process_record_user(uint16_t keycode, keyrecord_t* record);
+void housekeeping_task_user(void);
+void keyboard_post_init_user(void);
+bool rgb_matrix_indicators_user(void);
+layer_state_t layer_state_set_user(layer_state_t state);
+layer_state_t default_layer_state_set_user(layer_state_t state);
+
+// The keyboard's LAYOUT macro and LED count, which QMK's generated headers
+// give every file of a keyboard build
+#include "voyager.h"
@@ -0,0 +1,9 @@
+// raw_hid.h — Host shim of QMK's raw HID API
+//
+// Defined by whoever links the code: host/hidraw_sim.c, or a test's mock.
+
+#pragma once
+
+#include <stdint.h>
+
+void raw_hid_send(uint8_t* data, uint8_t length);
@@ -0,0 +1,148 @@
+// replay.c — Replays a keystroke trace through the real achordion.c
+//
+// Usage: replay [-o OUT.ktr] [TRACE]   (standard input if omitted)
+//
+// Text trace: one event per line, `#` starts a comment:
+//   <time ms> <row> <col> <d|u> <keycode>
+// The keycode is a number in C syntax, e.g. 0x2104 for MT(MOD_LCTL, KC_A).
+// Binary traces (see trace_file.h) are recognized by their header and
+// replayed straight from a memory mapping. -o also writes the input events
+// to a binary trace, to convert a text trace.
+//
+// Prints every event that reaches the rest of QMK, with the virtual time it
+// came out at and how long Achordion held it back, then a summary. The
+// wall-clock cost of the replay goes to standard error, so standard output
+// stays deterministic and can be diffed against an expected file.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "harness.h"
+#include "trace_file.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct {
+  uint32_t keys;
+  uint32_t held_back;  // Keys that came out later than they happened
+  uint64_t total_latency;
+  uint16_t max_latency;
+} summary_t;
+
+static void print_output(const harness_output_t* output, void* context) {
+  summary_t* summary = context;
+  switch (output->kind) {
+    case HARNESS_KEY:
+      printf("%8lu  %2u %2u %-4s tap=%u  +%ums\n", (unsigned long)output->time,
+             output->row, output->col, output->pressed ? "down" : "up",
+             output->tap_count, output->latency);
+      ++summary->keys;
+      summary->total_latency += output->latency;
+      if (output->latency > 0) {
+        ++summary->held_back;
+      }
+      if (output->latency > summary->max_latency) {
+        summary->max_latency = output->latency;
+      }
+      break;
+    case HARNESS_MODS_DOWN:
+    case HARNESS_MODS_UP:
+      printf("%8lu  mods %c0x%02x\n", (unsigned long)output->time,
+             output->kind == HARNESS_MODS_DOWN ? '+' : '-', output->mods);
+      break;
+  }
+}
+
+static double seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char** argv) {
+  const char* out_path = NULL;
+  int arg = 1;
+  if (arg + 1 < argc && strcmp(argv[arg], "-o") == 0) {
+    out_path = argv[arg + 1];
+    arg += 2;
+  }
+  const char* path = arg < argc ? argv[arg] : NULL;
+
+  trace_reader_t binary;
+  bool is_binary = false;
+  FILE* in = stdin;
+  if (path != NULL) {
+    is_binary = trace_open(&binary, path);
+    if (!is_binary && (errno != EINVAL || (in = fopen(path, "r")) == NULL)) {
+      perror(path);
+      return 1;
+    }
+  }
+
+  trace_writer_t writer;
+  if (out_path != NULL && !trace_create(&writer, out_path, 0)) {
+    perror(out_path);
+    return 1;
+  }
+
+  summary_t summary = {0};
+  uint32_t inputs = 0;
+  unsigned line_number = 0;
+  const double start = seconds();
+
+  harness_input_t input;
+  for (;;) {
+    if (is_binary) {
+      if (!trace_next(&binary, &input)) {
+        if (binary.error) {
+          fprintf(stderr, "%s: truncated at event %lu\n", path,
+                  (unsigned long)inputs);
+          return 1;
+        }
+        break;
+      }
+    } else {
+      const int status = trace_read_text(in, &input, NULL, 0, &line_number);
+      if (status < 0) {
+        return 1;
+      }
+      if (status == 0) {
+        break;
+      }
+    }
+
+    if (inputs == 0) {
+      harness_reset(input.time, print_output, &summary);
+    }
+    if (out_path != NULL && !trace_write(&writer, input.time, input.row,
+                                         input.col, input.pressed,
+                                         input.keycode)) {
+      fprintf(stderr, "%s: cannot write event %lu\n", out_path,
+              (unsigned long)inputs);
+      return 1;
+    }
+    harness_feed(&input);
+    ++inputs;
+  }
+  harness_finish();
+  const double elapsed = seconds() - start;
+
+  if (is_binary) {
+    trace_close(&binary);
+  }
+  if (out_path != NULL && !trace_finish(&writer)) {
+    perror(out_path);
+    return 1;
+  }
+
+  printf("# %lu events in, %lu keys out, %lu held back, latency mean %.1f ms, max %u ms\n",
+         (unsigned long)inputs, (unsigned long)summary.keys,
+         (unsigned long)summary.held_back,
+         summary.keys ? (double)summary.total_latency / summary.keys : 0.0,
+         summary.max_latency);
+  fprintf(stderr, "replayed %lu events in %.3f ms (%.0f ns/event)\n",
+          (unsigned long)inputs, elapsed * 1e3,
+          inputs ? elapsed * 1e9 / inputs : 0.0);
+  return 0;
+}
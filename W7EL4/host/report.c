@@ -0,0 +1,398 @@
+// report.c — Tap-hold quality of one layout's configuration over a trace
+//
+// Usage: report -c CONFIG [TRACE]   (standard input if omitted)
+//
+// Replays a trace through the tapping model (tapping.h) and the real
+// achordion.c, set up as CONFIG describes a layout, and reports what the
+// typist would feel: the latency each key press gains on its way to the
+// rest of QMK, how many tap-hold presses settled the other way than
+// intended, and the longest stalls. tools/tap_hold_report.py writes CONFIG
+// from a layout directory and runs this once per layout.
+//
+// CONFIG has one setting per line, `#` starting a comment:
+//   achordion 0|1
+//   permissive_hold 0|1
+//   chordal_hold 0|1
+//   flow_tap_term <ms>               0 for off
+//   quick_tap_term <ms>              0 for off
+//   default <tt> <at> <st> <policy>  timing of keys not listed
+//   key <row> <col> <L|R|*> <keycode> <tt> <at> <st> <policy>
+// where the keycode, in hex, is the key's on the base layer, tt its tapping
+// term, at its Achordion timeout, st its streak timeout and policy its settle
+// policy, as in key_timing.json. Keys are timed as on the base layer: the
+// harness does not switch layers.
+//
+// The intent of a tap-hold press comes from the trace's note, `tap` or
+// `hold` (see trace_file.h), as tools/gen_traces.py --annotate writes it.
+// Presses without one count for latency only.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "harness.h"
+#include "trace_file.h"
+#include "achordion.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Worst stalls listed
+#define REPORT_STALLS 5
+// Presses of one key in flight at once
+#define REPORT_QUEUE 8
+
+typedef struct {
+  uint16_t tapping_term;
+  uint16_t achordion_timeout;
+  uint16_t achordion_streak_timeout;
+  uint8_t achordion_settle_policy;
+} timing_t;
+
+static timing_t default_timing = {TAPPING_TERM, 1000, ACHORDION_STREAK_TIMEOUT,
+                                  ACHORDION_SETTLE_ON_PRESS};
+static timing_t timings[MATRIX_ROWS][MATRIX_COLS];
+static uint16_t keycodes[MATRIX_ROWS][MATRIX_COLS];
+static char hands[MATRIX_ROWS][MATRIX_COLS];
+
+static bool in_matrix(keypos_t key) {
+  return key.row < MATRIX_ROWS && key.col < MATRIX_COLS;
+}
+
+static char hand(keypos_t key) {
+  return in_matrix(key) ? hands[key.row][key.col] : '*';
+}
+
+// Achordion's callbacks only get the keycode: the timing of the first key
+// that has it.
+static const timing_t* timing_of_keycode(uint16_t keycode) {
+  for (uint8_t row = 0; row < MATRIX_ROWS; ++row) {
+    for (uint8_t col = 0; col < MATRIX_COLS; ++col) {
+      if (keycodes[row][col] == keycode) {
+        return &timings[row][col];
+      }
+    }
+  }
+  return &default_timing;
+}
+
+static uint16_t tapping_term(uint16_t keycode, keyrecord_t* record) {
+  (void)keycode;
+  const keypos_t key = record->event.key;
+  return in_matrix(key) ? timings[key.row][key.col].tapping_term
+                        : default_timing.tapping_term;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Achordion callbacks, from CONFIG instead of the keymap
+// ─────────────────────────────────────────────────────────────────────────────
+
+// Hold only across hands. Chord exceptions are not part of the comparison.
+bool achordion_chord(uint16_t tap_hold_keycode, keyrecord_t* tap_hold_record,
+                     uint16_t other_keycode, keyrecord_t* other_record) {
+  (void)tap_hold_keycode;
+  (void)other_keycode;
+  const char a = hand(tap_hold_record->event.key);
+  const char b = hand(other_record->event.key);
+  return a == '*' || b == '*' || a != b;
+}
+
+uint16_t achordion_timeout(uint16_t tap_hold_keycode) {
+  return timing_of_keycode(tap_hold_keycode)->achordion_timeout;
+}
+
+uint8_t achordion_settle_policy(uint16_t tap_hold_keycode) {
+  return timing_of_keycode(tap_hold_keycode)->achordion_settle_policy;
+}
+
+uint16_t achordion_streak_timeout(uint16_t tap_hold_keycode, uint8_t layer) {
+  (void)layer;
+  return timing_of_keycode(tap_hold_keycode)->achordion_streak_timeout;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Report
+// ─────────────────────────────────────────────────────────────────────────────
+
+enum intent { INTENT_NONE, INTENT_TAP, INTENT_HOLD };
+
+typedef struct {
+  uint16_t latency;
+  uint32_t time;  // When the key was pressed
+  uint8_t row;
+  uint8_t col;
+} stall_t;
+
+typedef struct {
+  uint32_t keystrokes;
+  uint32_t histogram[65536];  // Key presses by latency, ms
+  uint32_t tap_hold_presses;  // With an intent
+  uint32_t misfired_holds;    // Meant as tap, came out as hold
+  uint32_t misfired_taps;     // Meant as hold, came out as tap
+  stall_t stalls[REPORT_STALLS];  // Longest first
+
+  // Intents of the presses at each position, oldest first
+  uint8_t intents[MATRIX_ROWS][MATRIX_COLS][REPORT_QUEUE];
+  uint8_t intent_head[MATRIX_ROWS][MATRIX_COLS];
+  uint8_t intent_count[MATRIX_ROWS][MATRIX_COLS];
+} report_t;
+
+static void add_stall(report_t* report, const stall_t* stall) {
+  int i = REPORT_STALLS;
+  while (i > 0 && report->stalls[i - 1].latency < stall->latency) {
+    --i;
+  }
+  if (i == REPORT_STALLS) {
+    return;
+  }
+  memmove(&report->stalls[i + 1], &report->stalls[i],
+          (REPORT_STALLS - 1 - i) * sizeof(stall_t));
+  report->stalls[i] = *stall;
+}
+
+static void push_intent(report_t* report, uint8_t row, uint8_t col,
+                        uint8_t intent) {
+  if (row >= MATRIX_ROWS || col >= MATRIX_COLS ||
+      report->intent_count[row][col] == REPORT_QUEUE) {
+    return;
+  }
+  const uint8_t i =
+      (report->intent_head[row][col] + report->intent_count[row][col]++) % REPORT_QUEUE;
+  report->intents[row][col][i] = intent;
+}
+
+static uint8_t pop_intent(report_t* report, uint8_t row, uint8_t col) {
+  if (row >= MATRIX_ROWS || col >= MATRIX_COLS ||
+      report->intent_count[row][col] == 0) {
+    return INTENT_NONE;
+  }
+  const uint8_t intent = report->intents[row][col][report->intent_head[row][col]];
+  report->intent_head[row][col] = (report->intent_head[row][col] + 1) % REPORT_QUEUE;
+  --report->intent_count[row][col];
+  return intent;
+}
+
+static void on_output(const harness_output_t* output, void* context) {
+  report_t* report = context;
+  if (output->kind != HARNESS_KEY || !output->pressed) {
+    return;
+  }
+  ++report->histogram[output->latency];
+  const stall_t stall = {output->latency, output->time - output->latency,
+                         output->row, output->col};
+  add_stall(report, &stall);
+
+  switch (pop_intent(report, output->row, output->col)) {
+    case INTENT_TAP:
+      if (output->tap_count == 0) {
+        ++report->misfired_holds;
+      }
+      break;
+    case INTENT_HOLD:
+      if (output->tap_count > 0) {
+        ++report->misfired_taps;
+      }
+      break;
+  }
+}
+
+static uint16_t percentile(const report_t* report, uint32_t total, double p) {
+  const uint64_t rank = (uint64_t)(p * total + 0.999999);
+  uint64_t seen = 0;
+  for (uint32_t latency = 0; latency < 65536; ++latency) {
+    seen += report->histogram[latency];
+    if (seen >= rank && seen > 0) {
+      return (uint16_t)latency;
+    }
+  }
+  return 0;
+}
+
+static bool read_config(const char* path, harness_config_t* config,
+                        tapping_config_t* tapping) {
+  FILE* file = fopen(path, "r");
+  if (file == NULL) {
+    perror(path);
+    return false;
+  }
+  memset(hands, '*', sizeof(hands));
+  memset(keycodes, 0, sizeof(keycodes));
+  bool listed[MATRIX_ROWS][MATRIX_COLS] = {{false}};
+
+  char line[256];
+  unsigned line_number = 0;
+  bool ok = true;
+  while (ok && fgets(line, sizeof(line), file) != NULL) {
+    ++line_number;
+    char* comment = strchr(line, '#');
+    if (comment != NULL) {
+      *comment = '\0';
+    }
+    char name[32];
+    int offset = 0;
+    if (sscanf(line, "%31s %n", name, &offset) != 1) {
+      continue;
+    }
+    const char* args = line + offset;
+    unsigned value, row, col, keycode, tt, at, st, policy;
+    char key_hand;
+    if (strcmp(name, "achordion") == 0 && sscanf(args, "%u", &value) == 1) {
+      config->achordion = value != 0;
+    } else if (strcmp(name, "permissive_hold") == 0 && sscanf(args, "%u", &value) == 1) {
+      tapping->permissive_hold = value != 0;
+    } else if (strcmp(name, "chordal_hold") == 0 && sscanf(args, "%u", &value) == 1) {
+      tapping->chordal_hold = value != 0;
+    } else if (strcmp(name, "flow_tap_term") == 0 && sscanf(args, "%u", &value) == 1) {
+      tapping->flow_tap_term = value;
+    } else if (strcmp(name, "quick_tap_term") == 0 && sscanf(args, "%u", &value) == 1) {
+      tapping->quick_tap_term = value;
+    } else if (strcmp(name, "default") == 0 &&
+               sscanf(args, "%u %u %u %u", &tt, &at, &st, &policy) == 4) {
+      default_timing = (timing_t){tt, at, st, policy};
+    } else if (strcmp(name, "key") == 0 &&
+               sscanf(args, "%u %u %c %x %u %u %u %u", &row, &col, &key_hand,
+                      &keycode, &tt, &at, &st, &policy) == 8 &&
+               row < MATRIX_ROWS && col < MATRIX_COLS) {
+      hands[row][col] = key_hand;
+      keycodes[row][col] = keycode;
+      timings[row][col] = (timing_t){tt, at, st, policy};
+      listed[row][col] = true;
+    } else {
+      fprintf(stderr, "%s:%u: bad setting\n", path, line_number);
+      ok = false;
+    }
+  }
+  fclose(file);
+  for (uint8_t row = 0; row < MATRIX_ROWS; ++row) {
+    for (uint8_t col = 0; col < MATRIX_COLS; ++col) {
+      if (!listed[row][col]) {
+        timings[row][col] = default_timing;
+      }
+    }
+  }
+  return ok;
+}
+
+static double seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char** argv) {
+  const char* config_path = NULL;
+  int arg = 1;
+  if (arg + 1 < argc && strcmp(argv[arg], "-c") == 0) {
+    config_path = argv[arg + 1];
+    arg += 2;
+  }
+  if (config_path == NULL) {
+    fprintf(stderr, "usage: %s -c CONFIG [TRACE]\n", argv[0]);
+    return 2;
+  }
+  const char* path = arg < argc ? argv[arg] : NULL;
+
+  tapping_config_t tapping = {.hand = hand, .tapping_term = tapping_term};
+  harness_config_t config = {.achordion = true, .tapping = &tapping};
+  if (!read_config(config_path, &config, &tapping)) {
+    return 1;
+  }
+  harness_configure(&config);
+
+  trace_reader_t binary;
+  bool is_binary = false;
+  FILE* in = stdin;
+  if (path != NULL) {
+    is_binary = trace_open(&binary, path);
+    if (!is_binary && (errno != EINVAL || (in = fopen(path, "r")) == NULL)) {
+      perror(path);
+      return 1;
+    }
+  }
+
+  report_t* report = calloc(1, sizeof(report_t));
+  if (report == NULL) {
+    perror("report");
+    return 1;
+  }
+  uint32_t inputs = 0;
+  unsigned line_number = 0;
+  const double start = seconds();
+
+  harness_input_t input;
+  char note[16] = "";
+  for (;;) {
+    if (is_binary) {
+      if (!trace_next(&binary, &input)) {
+        if (binary.error) {
+          fprintf(stderr, "%s: truncated at event %lu\n", path,
+                  (unsigned long)inputs);
+          return 1;
+        }
+        break;
+      }
+    } else {
+      const int status = trace_read_text(in, &input, note, sizeof(note), &line_number);
+      if (status < 0) {
+        return 1;
+      }
+      if (status == 0) {
+        break;
+      }
+    }
+
+    if (inputs == 0) {
+      harness_reset(input.time, on_output, report);
+    }
+    if (input.pressed) {
+      ++report->keystrokes;
+      uint8_t intent = INTENT_NONE;
+      if (!is_binary && strcmp(note, "tap") == 0) {
+        intent = INTENT_TAP;
+      } else if (!is_binary && strcmp(note, "hold") == 0) {
+        intent = INTENT_HOLD;
+      }
+      if (intent != INTENT_NONE) {
+        ++report->tap_hold_presses;
+      }
+      push_intent(report, input.row, input.col, intent);
+    }
+    harness_feed(&input);
+    ++inputs;
+  }
+  harness_finish();
+  const double elapsed = seconds() - start;
+  if (is_binary) {
+    trace_close(&binary);
+  }
+
+  uint32_t presses = 0;
+  uint16_t max_latency = 0;
+  uint64_t total_latency = 0;
+  for (uint32_t latency = 0; latency < 65536; ++latency) {
+    if (report->histogram[latency] > 0) {
+      presses += report->histogram[latency];
+      total_latency += (uint64_t)latency * report->histogram[latency];
+      max_latency = latency;
+    }
+  }
+
+  printf("keystrokes %lu\n", (unsigned long)report->keystrokes);
+  printf("latency_mean %.1f\n", presses ? (double)total_latency / presses : 0.0);
+  printf("latency_p50 %u\n", percentile(report, presses, 0.50));
+  printf("latency_p90 %u\n", percentile(report, presses, 0.90));
+  printf("latency_p99 %u\n", percentile(report, presses, 0.99));
+  printf("latency_max %u\n", max_latency);
+  printf("tap_hold_presses %lu\n", (unsigned long)report->tap_hold_presses);
+  printf("misfired_holds %lu\n", (unsigned long)report->misfired_holds);
+  printf("misfired_taps %lu\n", (unsigned long)report->misfired_taps);
+  for (int i = 0; i < REPORT_STALLS && report->stalls[i].latency > 0; ++i) {
+    printf("stall %u ms at %lu ms, key %u %u\n", report->stalls[i].latency,
+           (unsigned long)report->stalls[i].time, report->stalls[i].row,
+           report->stalls[i].col);
+  }
+  fprintf(stderr, "reported on %lu events in %.3f ms (%.0f ns/event)\n",
+          (unsigned long)inputs, elapsed * 1e3,
+          inputs ? elapsed * 1e9 / inputs : 0.0);
+  free(report);
+  return 0;
+}
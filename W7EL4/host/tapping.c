@@ -0,0 +1,241 @@
+// tapping.c — Host model of QMK's tap-hold decision (action_tapping.c)
+
+#include "tapping.h"
+#include "deadline.h"
+
+// Events held back behind an undecided key, as QMK's waiting buffer
+#define WAITING_MAX 16
+
+typedef struct {
+  uint16_t keycode;
+  keyrecord_t record;
+} pending_event_t;
+
+static tapping_config_t config;
+static tapping_next_t next;
+
+// The undecided tap-hold key, if `undecided`
+static bool undecided = false;
+static pending_event_t tapping_key;
+static deadline_token_t term_deadline = DEADLINE_INVALID;
+
+static pending_event_t waiting[WAITING_MAX];
+static uint8_t waiting_count = 0;
+
+// How each tap-hold key was decided, for its release: its tap count
+static uint8_t decided[MATRIX_ROWS][MATRIX_COLS];
+
+// Previous press, for flow tap. Like QMK's flow_tap_update_last_event(), a
+// tap-hold key decided as hold is not recorded: it was unsettled when the
+// keys after it went down.
+static uint16_t last_press_keycode = KC_NO;
+static uint16_t last_press_time = 0;
+
+// Last tap-hold key tapped, for quick tap, until another key is pressed
+static bool quick_tap_armed = false;
+static keypos_t quick_tap_key;
+static uint16_t quick_tap_time = 0;  // Of its release
+
+static bool is_tap_hold(uint16_t keycode) {
+  return IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode);
+}
+
+static uint16_t tapping_term_of(uint16_t keycode, keyrecord_t* record) {
+  return config.tapping_term != NULL ? config.tapping_term(keycode, record)
+                                     : TAPPING_TERM;
+}
+
+// QMK's default is_flow_tap_key(): alphas, space and some punctuation.
+static bool is_flow_tap_key(uint16_t keycode) {
+  if (is_tap_hold(keycode)) {
+    keycode &= 0xFF;
+  }
+  switch (keycode) {
+    case KC_A ... KC_Z:
+    case KC_SPACE:
+    case KC_DOT:
+    case KC_COMMA:
+    case KC_SEMICOLON:
+    case KC_SLASH:
+      return true;
+  }
+  return false;
+}
+
+static bool same_hand(keypos_t a, keypos_t b) {
+  if (config.hand == NULL) {
+    return false;
+  }
+  const char ha = config.hand(a);
+  const char hb = config.hand(b);
+  return ha != '*' && hb != '*' && ha == hb;
+}
+
+static bool in_matrix(keypos_t key) {
+  return key.row < MATRIX_ROWS && key.col < MATRIX_COLS;
+}
+
+static bool same_key(keypos_t a, keypos_t b) {
+  return a.row == b.row && a.col == b.col;
+}
+
+static void emit(uint16_t keycode, keyrecord_t* record) {
+  if (record->event.pressed) {
+    if (!is_tap_hold(keycode) || record->tap.count > 0) {
+      last_press_keycode = keycode;
+      last_press_time = record->event.time;
+    }
+    if (!same_key(record->event.key, quick_tap_key)) {
+      quick_tap_armed = false;
+    }
+  } else if (is_tap_hold(keycode) && record->tap.count > 0) {
+    quick_tap_armed = true;
+    quick_tap_key = record->event.key;
+    quick_tap_time = record->event.time;
+  }
+  next(keycode, record);
+}
+
+static void flush_waiting(void);
+
+static void decide(uint8_t tap_count) {
+  undecided = false;
+  deadline_cancel(term_deadline);
+  term_deadline = DEADLINE_INVALID;
+  if (in_matrix(tapping_key.record.event.key)) {
+    decided[tapping_key.record.event.key.row][tapping_key.record.event.key.col] = tap_count;
+  }
+  tapping_key.record.tap.count = tap_count;
+  emit(tapping_key.keycode, &tapping_key.record);
+  flush_waiting();
+}
+
+static void on_term(uint32_t deadline, void* arg) {
+  (void)deadline;
+  (void)arg;
+  term_deadline = DEADLINE_INVALID;
+  if (undecided) {
+    decide(0);
+  }
+}
+
+// Processes the waiting events again, in order: one may start a new
+// undecided key, which the rest then wait behind.
+static void flush_waiting(void) {
+  pending_event_t events[WAITING_MAX];
+  const uint8_t count = waiting_count;
+  memcpy(events, waiting, count * sizeof(events[0]));
+  waiting_count = 0;
+  for (uint8_t i = 0; i < count; ++i) {
+    tapping_process(events[i].keycode, &events[i].record);
+  }
+}
+
+static void wait(uint16_t keycode, keyrecord_t* record) {
+  if (waiting_count == WAITING_MAX) {
+    decide(0);  // QMK's buffer overflowing settles the key as hold too
+    tapping_process(keycode, record);
+    return;
+  }
+  waiting[waiting_count++] = (pending_event_t){keycode, *record};
+}
+
+static bool is_waiting(keypos_t key) {
+  for (uint8_t i = 0; i < waiting_count; ++i) {
+    if (same_key(waiting[i].record.event.key, key)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void tapping_reset(const tapping_config_t* new_config, tapping_next_t new_next) {
+  config = *new_config;
+  next = new_next;
+  undecided = false;
+  deadline_cancel(term_deadline);
+  term_deadline = DEADLINE_INVALID;
+  waiting_count = 0;
+  memset(decided, 0, sizeof(decided));
+  last_press_keycode = KC_NO;
+  quick_tap_armed = false;
+}
+
+void tapping_process(uint16_t keycode, keyrecord_t* record) {
+  const keypos_t key = record->event.key;
+  const bool pressed = record->event.pressed;
+
+  if (undecided) {
+    const keypos_t tapping_pos = tapping_key.record.event.key;
+    if (!pressed && same_key(key, tapping_pos)) {
+      // Released within its tapping term: a tap.
+      decide(1);
+      record->tap.count = 1;
+      emit(keycode, record);
+      return;
+    }
+    if (pressed) {
+      if (config.chordal_hold && waiting_count == 0 &&
+          same_hand(tapping_pos, key)) {
+        decide(1);
+        tapping_process(keycode, record);
+      } else {
+        wait(keycode, record);
+      }
+      return;
+    }
+    if (is_waiting(key)) {
+      if (config.permissive_hold) {
+        // A key pressed after it went down and up: a hold.
+        decide(0);
+        tapping_process(keycode, record);
+      } else {
+        wait(keycode, record);
+      }
+      return;
+    }
+    // Release of a key pressed before it
+    emit(keycode, record);
+    return;
+  }
+
+  if (!is_tap_hold(keycode)) {
+    emit(keycode, record);
+    return;
+  }
+  if (!pressed) {
+    record->tap.count = in_matrix(key) ? decided[key.row][key.col] : 0;
+    emit(keycode, record);
+    return;
+  }
+
+  if (config.quick_tap_term > 0 && quick_tap_armed && same_key(key, quick_tap_key) &&
+      (uint16_t)(record->event.time - quick_tap_time) < config.quick_tap_term) {
+    // Tapped again right after a tap: a second tap, held to repeat.
+    if (in_matrix(key)) {
+      decided[key.row][key.col] = 2;
+    }
+    record->tap.count = 2;
+    emit(keycode, record);
+    return;
+  }
+
+  if (config.flow_tap_term > 0 && is_flow_tap_key(keycode) &&
+      is_flow_tap_key(last_press_keycode) &&
+      (uint16_t)(record->event.time - last_press_time) < config.flow_tap_term) {
+    // Typing fast: settled as tap on the spot.
+    if (in_matrix(key)) {
+      decided[key.row][key.col] = 1;
+    }
+    record->tap.count = 1;
+    emit(keycode, record);
+    return;
+  }
+
+  undecided = true;
+  tapping_key = (pending_event_t){keycode, *record};
+  term_deadline = deadline_schedule(
+      timer_read32() - (uint16_t)(timer_read() - record->event.time) +
+          tapping_term_of(keycode, record),
+      on_term, NULL);
+}
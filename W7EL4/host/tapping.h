@@ -0,0 +1,47 @@
+// tapping.h — Host model of QMK's tap-hold decision (action_tapping.c)
+//
+// Sits in front of Achordion the way QMK's tapping logic does on the
+// keyboard: a mod-tap or layer-tap press is held back until it is decided,
+// and the presses that follow it wait behind it. It settles as:
+// - tap, when released within its tapping term;
+// - tap, right away, when pressed again within the quick tap term of its
+//   release with no other key in between (QUICK_TAP_TERM): held, it repeats;
+// - tap, right away, when pressed within the flow tap term of a previous
+//   alpha or space press (FLOW_TAP_TERM);
+// - tap, when a key on the same hand is pressed (CHORDAL_HOLD);
+// - hold, when a key pressed after it is released first (PERMISSIVE_HOLD);
+// - hold, when its tapping term expires.
+// Decided events go on with tap.count 1 for a tap, 2 for a quick tap and 0
+// for a hold, as in QMK. Not modeled: hold on other key press, retro tapping, tap counts
+// beyond 2.
+
+#pragma once
+
+#include "quantum.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  uint16_t flow_tap_term;   // 0 for off
+  uint16_t quick_tap_term;  // 0 for off
+  bool permissive_hold;
+  bool chordal_hold;
+  // Hand of a key for CHORDAL_HOLD: 'L', 'R', or '*' for either
+  char (*hand)(keypos_t key);
+  // Per-key term, as QMK's get_tapping_term(), or NULL for TAPPING_TERM
+  uint16_t (*tapping_term)(uint16_t keycode, keyrecord_t* record);
+} tapping_config_t;
+
+typedef void (*tapping_next_t)(uint16_t keycode, keyrecord_t* record);
+
+// Resets the model; decided events go to `next`.
+void tapping_reset(const tapping_config_t* config, tapping_next_t next);
+
+// Processes a key event at the current time.
+void tapping_process(uint16_t keycode, keyrecord_t* record);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,239 @@
+// trace_file.c — Binary keystroke traces
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "trace_file.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static uint32_t read_u32(const uint8_t* p) {
+  return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+         (uint32_t)p[3] << 24;
+}
+
+static void put_u32(uint8_t* p, uint32_t value) {
+  p[0] = (uint8_t)value;
+  p[1] = (uint8_t)(value >> 8);
+  p[2] = (uint8_t)(value >> 16);
+  p[3] = (uint8_t)(value >> 24);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Reader
+// ─────────────────────────────────────────────────────────────────────────────
+
+bool trace_is_binary(const void* data, size_t size) {
+  const uint8_t* header = data;
+  return size >= TRACE_HEADER_SIZE && memcmp(header, TRACE_MAGIC, 4) == 0 &&
+         header[4] == TRACE_VERSION;
+}
+
+bool trace_reader_init(trace_reader_t* reader, const void* data, size_t size) {
+  memset(reader, 0, sizeof(*reader));
+  if (!trace_is_binary(data, size)) {
+    return false;
+  }
+  const uint8_t* header = data;
+  reader->data = data;
+  reader->size = size;
+  reader->cursor = header + TRACE_HEADER_SIZE;
+  reader->end = header + size;
+  reader->microseconds = (header[5] & TRACE_MICROSECONDS) != 0;
+  reader->remaining = read_u32(header + 8);
+  reader->time = read_u32(header + 12);
+  return true;
+}
+
+bool trace_open(trace_reader_t* reader, const char* path) {
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+  void* data = NULL;
+  if (st.st_size > 0) {
+    data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  if (data == NULL || !trace_reader_init(reader, data, st.st_size)) {
+    if (data != NULL) {
+      munmap(data, st.st_size);
+    }
+    errno = EINVAL;
+    return false;
+  }
+  // Read front to back, once.
+  posix_madvise(data, st.st_size, POSIX_MADV_SEQUENTIAL);
+  reader->mapped = true;
+  return true;
+}
+
+void trace_close(trace_reader_t* reader) {
+  if (reader->mapped) {
+    munmap((void*)reader->data, reader->size);
+  }
+  memset(reader, 0, sizeof(*reader));
+}
+
+bool trace_next(trace_reader_t* reader, harness_input_t* input) {
+  if (reader->remaining == 0) {
+    return false;
+  }
+  const uint8_t* p = reader->cursor;
+  const uint8_t* const end = reader->end;
+
+  uint64_t word = 0;
+  for (unsigned shift = 0;; shift += 7) {
+    if (p == end || shift > 63) {
+      reader->error = true;
+      return false;
+    }
+    const uint8_t byte = *p++;
+    word |= (uint64_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      break;
+    }
+  }
+  const bool has_keycode = word & 2;
+  if (end - p < (has_keycode ? 3 : 1)) {
+    reader->error = true;
+    return false;
+  }
+  const uint8_t row = *p >> 4;
+  const uint8_t col = *p++ & 0x0F;
+  if (has_keycode) {
+    reader->keycodes[row][col] = p[0] | p[1] << 8;
+    p += 2;
+  }
+
+  reader->cursor = p;
+  --reader->remaining;
+  reader->time += word >> 2;
+  input->time =
+      (uint32_t)(reader->microseconds ? reader->time / 1000 : reader->time);
+  input->keycode = reader->keycodes[row][col];
+  input->row = row;
+  input->col = col;
+  input->pressed = word & 1;
+  return true;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Text
+// ─────────────────────────────────────────────────────────────────────────────
+
+int trace_read_text(FILE* in, harness_input_t* input, char* note,
+                    size_t note_size, unsigned* line_number) {
+  char line[256];
+  while (fgets(line, sizeof(line), in) != NULL) {
+    ++*line_number;
+    char* comment = strchr(line, '#');
+    if (comment != NULL) {
+      *comment = '\0';
+    }
+
+    unsigned long time;
+    unsigned row, col;
+    char action;
+    char keycode[32], extra[32];
+    const int fields = sscanf(line, "%lu %u %u %c %31s %31s", &time, &row,
+                              &col, &action, keycode, extra);
+    if (fields <= 0) {
+      continue;  // Blank line
+    }
+    if (fields < 5 || (action != 'd' && action != 'u')) {
+      fprintf(stderr, "line %u: expected <time> <row> <col> <d|u> <keycode>\n",
+              *line_number);
+      return -1;
+    }
+    *input = (harness_input_t){
+        .time = time,
+        .keycode = (uint16_t)strtoul(keycode, NULL, 0),
+        .row = row,
+        .col = col,
+        .pressed = action == 'd',
+    };
+    if (note != NULL && note_size > 0) {
+      snprintf(note, note_size, "%s", fields == 6 ? extra : "");
+    }
+    return 1;
+  }
+  return 0;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Writer
+// ─────────────────────────────────────────────────────────────────────────────
+
+bool trace_create(trace_writer_t* writer, const char* path, uint8_t flags) {
+  memset(writer, 0, sizeof(*writer));
+  writer->file = fopen(path, "wb");
+  if (writer->file == NULL) {
+    return false;
+  }
+  // The start time is filled in by the first trace_write(), the count by
+  // trace_finish().
+  uint8_t header[TRACE_HEADER_SIZE] = {0};
+  memcpy(header, TRACE_MAGIC, 4);
+  header[4] = TRACE_VERSION;
+  header[5] = flags;
+  return fwrite(header, sizeof(header), 1, writer->file) == 1;
+}
+
+bool trace_write(trace_writer_t* writer, uint32_t time, uint8_t row,
+                 uint8_t col, bool pressed, uint16_t keycode) {
+  if (row >= TRACE_MAX_ROWS || col >= TRACE_MAX_COLS ||
+      (writer->count > 0 && time < writer->time)) {
+    return false;
+  }
+  const uint32_t delta = writer->count > 0 ? time - writer->time : 0;
+  const bool has_keycode = keycode != writer->keycodes[row][col];
+
+  uint8_t record[5 + 1 + 2];  // Varint of up to 34 bits, key, keycode
+  size_t length = 0;
+  uint64_t word = (uint64_t)delta << 2 | has_keycode << 1 | pressed;
+  do {
+    record[length++] = (uint8_t)(word & 0x7F) | (word > 0x7F ? 0x80 : 0);
+    word >>= 7;
+  } while (word != 0);
+  record[length++] = row << 4 | col;
+  if (has_keycode) {
+    record[length++] = (uint8_t)keycode;
+    record[length++] = (uint8_t)(keycode >> 8);
+    writer->keycodes[row][col] = keycode;
+  }
+
+  if (writer->count == 0) {
+    uint8_t start[4];
+    put_u32(start, time);
+    if (fseek(writer->file, 12, SEEK_SET) != 0 ||
+        fwrite(start, sizeof(start), 1, writer->file) != 1 ||
+        fseek(writer->file, 0, SEEK_END) != 0) {
+      return false;
+    }
+  }
+  writer->time = time;
+  ++writer->count;
+  return fwrite(record, length, 1, writer->file) == 1;
+}
+
+bool trace_finish(trace_writer_t* writer) {
+  uint8_t count[4];
+  put_u32(count, writer->count);
+  bool ok = fseek(writer->file, 8, SEEK_SET) == 0 &&
+            fwrite(count, sizeof(count), 1, writer->file) == 1;
+  ok = fclose(writer->file) == 0 && ok;
+  writer->file = NULL;
+  return ok;
+}
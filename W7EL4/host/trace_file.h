@@ -0,0 +1,107 @@
+// trace_file.h — Binary keystroke traces
+//
+// A compact trace format for long recorded sessions, read straight from a
+// memory mapping with no parsing beyond varint decoding:
+//
+//   Header, 16 bytes, little-endian:
+//     0  "AKTR"
+//     4  u8   version, TRACE_VERSION
+//     5  u8   flags, TRACE_MICROSECONDS if times are in us instead of ms
+//     6  u16  reserved, 0
+//     8  u32  number of events
+//     12 u32  time of the first event
+//   Then one record per event:
+//     varint  (time since the previous event) << 2 | has_keycode << 1 | pressed
+//     u8      row << 4 | col
+//     u16     keycode, only if has_keycode
+//
+// Text traces have one event per line, `#` starting a comment:
+//   <time ms> <row> <col> <d|u> <keycode> [note]
+// The keycode is a number in C syntax. The optional note, such as the
+// expected tap or hold of a tap-hold press, is for tools that want it.
+//
+// In binary traces, a record without a keycode repeats the last keycode
+// seen at its position, so releases and repeated presses take 2 bytes in a
+// typical session.
+// Varints are LEB128: 7 bits per byte, least significant first.
+
+#pragma once
+
+#include "harness.h"
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRACE_MAGIC "AKTR"
+#define TRACE_VERSION 1
+#define TRACE_HEADER_SIZE 16
+#define TRACE_MICROSECONDS 0x01
+// Rows and columns must fit in a nibble.
+#define TRACE_MAX_ROWS 16
+#define TRACE_MAX_COLS 16
+
+// Reader over a trace in memory. Decodes one event at a time; nothing is
+// copied out of `data`.
+typedef struct {
+  const uint8_t* data;
+  size_t size;
+  const uint8_t* cursor;
+  const uint8_t* end;
+  uint32_t remaining;
+  uint64_t time;  // In file units
+  bool microseconds;
+  bool error;     // Set on a truncated or malformed record
+  bool mapped;    // `data` comes from trace_open()
+  uint16_t keycodes[TRACE_MAX_ROWS][TRACE_MAX_COLS];
+} trace_reader_t;
+
+// Starts reading the trace in `data`. Returns false if it has no valid
+// header.
+bool trace_reader_init(trace_reader_t* reader, const void* data, size_t size);
+
+// Maps the trace file at `path` and starts reading it. Returns false and
+// sets errno, or EINVAL for a file that is not a trace, on failure.
+bool trace_open(trace_reader_t* reader, const char* path);
+
+// Decodes the next event into `input`, with its time in ms. Returns false
+// at the end of the trace, or on error with `reader->error` set.
+bool trace_next(trace_reader_t* reader, harness_input_t* input);
+
+// Unmaps a trace opened with trace_open().
+void trace_close(trace_reader_t* reader);
+
+// Returns true if `data` starts with a trace header.
+bool trace_is_binary(const void* data, size_t size);
+
+// Reads the next event of a text trace into `input`, and its note, if any,
+// into `note` (`note_size` bytes; may be NULL). Counts lines in
+// `line_number`. Returns 1 on success, 0 at the end, -1 on a malformed line
+// after printing an error.
+int trace_read_text(FILE* in, harness_input_t* input, char* note,
+                    size_t note_size, unsigned* line_number);
+
+typedef struct {
+  FILE* file;
+  uint32_t count;
+  uint32_t time;  // Of the last event, in file units
+  uint16_t keycodes[TRACE_MAX_ROWS][TRACE_MAX_COLS];
+} trace_writer_t;
+
+// Creates a trace at `path`; `flags` are TRACE_* flags. Returns false and
+// sets errno on failure.
+bool trace_create(trace_writer_t* writer, const char* path, uint8_t flags);
+
+// Appends an event at `time`, in the units given by the flags. Returns
+// false if its time goes backwards, its position does not fit, or on
+// write error.
+bool trace_write(trace_writer_t* writer, uint32_t time, uint8_t row,
+                 uint8_t col, bool pressed, uint16_t keycode);
+
+// Writes the event count and closes the file. Returns false on write error.
+bool trace_finish(trace_writer_t* writer);
+
+#ifdef __cplusplus
+}
+#endif
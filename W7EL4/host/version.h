@@ -0,0 +1,7 @@
+// version.h — Host stand-in for the header QMK generates at build time
+
+#pragma once
+
+#define QMK_VERSION "host"
+#define QMK_BUILDDATE "host"
+#define QMK_GIT_HASH "host"
@@ -0,0 +1,45 @@
+// voyager.h — Host shim of the ZSA Voyager keyboard header
+//
+// What QMK_KEYBOARD_H gives a layout's keymap.c: the LAYOUT macro, the LED
+// count and ZSA's keyboard_config. Host builds of keymap.c pass
+// -DQMK_KEYBOARD_H='"voyager.h"'.
+
+#pragma once
+
+#include "quantum.h"
+
+#define RGB_MATRIX_LED_COUNT 52
+
+// keyboards/zsa/voyager/voyager.h
+typedef struct {
+  bool disable_layer_led : 1;
+  bool led_level : 1;
+} keyboard_config_t;
+
+extern keyboard_config_t keyboard_config;
+
+#define LED_LEVEL keyboard_config.led_level
+
+// Matrix positions as in the keyboard's info.json, and
+// tools/qmk_keymap.py's MATRIX: rows 0-5 left, 6-11 right.
+#define LAYOUT_voyager( \
+  k01, k02, k03, k04, k05, k06,   k60, k61, k62, k63, k64, k65, \
+  k11, k12, k13, k14, k15, k16,   k70, k71, k72, k73, k74, k75, \
+  k21, k22, k23, k24, k25, k26,   k80, k81, k82, k83, k84, k85, \
+  k31, k32, k33, k34, k35, k36,   k90, k91, k92, k93, k94, k95, \
+                      k44, k50,   kB6, kA2 \
+) { \
+  { 0,   k01, k02, k03, k04, k05, k06 }, \
+  { 0,   k11, k12, k13, k14, k15, k16 }, \
+  { 0,   k21, k22, k23, k24, k25, k26 }, \
+  { 0,   k31, k32, k33, k34, k35, k36 }, \
+  { 0,   0,   0,   0,   k44, 0,   0   }, \
+  { k50, 0,   0,   0,   0,   0,   0   }, \
+  { k60, k61, k62, k63, k64, k65, 0   }, \
+  { k70, k71, k72, k73, k74, k75, 0   }, \
+  { k80, k81, k82, k83, k84, k85, 0   }, \
+  { k90, k91, k92, k93, k94, k95, 0   }, \
+  { 0,   0,   kA2, 0,   0,   0,   0   }, \
+  { 0,   0,   0,   0,   0,   0,   kB6 }, \
+}
+#define LAYOUT LAYOUT_voyager
@@ -0,0 +1,109 @@
+// key_capture.c — Keystroke capture over the Oryx raw HID channel
+
+#include "key_capture.h"
+
+#ifdef RAW_ENABLE
+#include "raw_hid.h"
+#endif
+
+_Static_assert(MATRIX_ROWS <= 16 && MATRIX_COLS <= 8,
+               "Key position does not fit in one byte");
+_Static_assert(KEY_CAPTURE_BUFFER <= 255, "Buffer index is a uint8_t");
+
+typedef struct {
+  uint16_t time;
+  uint16_t keycode;
+  uint8_t key;  // row << 4 | col << 1 | pressed
+} capture_event_t;
+
+static capture_event_t buffer[KEY_CAPTURE_BUFFER];
+static uint8_t head = 0;  // Oldest event
+static uint8_t count = 0;
+static uint8_t dropped = 0;
+static bool started = false;  // By the host, until it stops it or unpairs
+
+static bool capturing(void) {
+#if defined(RAW_ENABLE) && defined(ORYX_ENABLE)
+  return started && rawhid_state.paired;
+#else
+  return false;
+#endif
+}
+
+void key_capture_record(uint16_t keycode, const keyrecord_t* record) {
+  const keyevent_t* event = &record->event;
+  // Only matrix keys: combos and encoders have no position in the trace.
+  if (!capturing() || !IS_KEYEVENT(*event) || event->key.row >= MATRIX_ROWS ||
+      event->key.col >= MATRIX_COLS) {
+    return;
+  }
+  if (count == KEY_CAPTURE_BUFFER) {
+    if (dropped < 255) {
+      ++dropped;
+    }
+    return;
+  }
+  uint8_t i = head + count;
+  if (i >= KEY_CAPTURE_BUFFER) {
+    i -= KEY_CAPTURE_BUFFER;
+  }
+  buffer[i] = (capture_event_t){
+      .time = event->time,
+      .keycode = keycode,
+      .key = event->key.row << 4 | event->key.col << 1 | event->pressed,
+  };
+  ++count;
+}
+
+uint8_t key_capture_pack(uint8_t* report) {
+  memset(report, 0, KEY_CAPTURE_REPORT_SIZE);
+  const uint8_t n = count < KEY_CAPTURE_PER_REPORT ? count : KEY_CAPTURE_PER_REPORT;
+  report[0] = KEY_CAPTURE_EVENT;
+  report[1] = n;
+  report[2] = dropped;
+  dropped = 0;
+
+  uint8_t* p = report + 3;
+  for (uint8_t k = 0; k < n; ++k) {
+    const capture_event_t* e = &buffer[head];
+    *p++ = e->time;
+    *p++ = e->time >> 8;
+    *p++ = e->keycode;
+    *p++ = e->keycode >> 8;
+    *p++ = e->key;
+    if (++head == KEY_CAPTURE_BUFFER) {
+      head = 0;
+    }
+  }
+  count -= n;
+  return n;
+}
+
+bool key_capture_receive(uint8_t* data, uint8_t length) {
+  if (length < 2 || data[0] != KEY_CAPTURE_EVENT) {
+    return false;
+  }
+  started = data[1] == KEY_CAPTURE_START;
+  return true;
+}
+
+uint8_t key_capture_pending(void) {
+  return count;
+}
+
+void key_capture_task(void) {
+#if defined(RAW_ENABLE) && defined(ORYX_ENABLE)
+  if (!rawhid_state.paired) {
+    // Nobody is listening: off until the next host starts afresh.
+    head = count = dropped = 0;
+    started = false;
+    return;
+  }
+  if (count == 0 && dropped == 0) {
+    return;
+  }
+  uint8_t report[KEY_CAPTURE_REPORT_SIZE];
+  key_capture_pack(report);
+  raw_hid_send(report, sizeof(report));
+#endif
+}
@@ -0,0 +1,84 @@
+// key_capture.h — Keystroke capture over the Oryx raw HID channel
+//
+// Built with KEY_CAPTURE_ENABLE = yes in rules.mk. Off until a raw HID host
+// starts it: then, while Oryx (or Keymapp) is paired, every physical press
+// and release is recorded into a RAM ring buffer before tap-hold processing,
+// and drained as raw HID reports, one per main loop pass, until the host
+// stops it or the channel unpairs. host/capture does both and turns the
+// reports into a trace for host/replay. Binary only: no strings in flash, no
+// console.
+//
+// Request, 32 bytes:
+//   [0]  KEY_CAPTURE_EVENT
+//   [1]  KEY_CAPTURE_START or KEY_CAPTURE_STOP
+//
+// Report layout, 32 bytes, integers little-endian:
+//   [0]  KEY_CAPTURE_EVENT
+//   [1]  Number of events, N <= KEY_CAPTURE_PER_REPORT
+//   [2]  Events dropped on a full buffer since the previous report,
+//        saturating at 255
+//   [3]  N x 5 bytes: time (uint16, ms, wraps), keycode (uint16),
+//        row << 4 | col << 1 | pressed
+
+#pragma once
+
+#include "quantum.h"
+
+#ifndef KEY_CAPTURE_BUFFER
+#define KEY_CAPTURE_BUFFER 64
+#endif
+
+// Event id, outside the range Oryx uses; next to ACHORDION_STATS_EVENT.
+#define KEY_CAPTURE_EVENT 0xAD
+#define KEY_CAPTURE_REPORT_SIZE 32
+#define KEY_CAPTURE_EVENT_SIZE 5
+#define KEY_CAPTURE_PER_REPORT ((KEY_CAPTURE_REPORT_SIZE - 3) / KEY_CAPTURE_EVENT_SIZE)
+
+enum key_capture_command {
+  KEY_CAPTURE_STOP,
+  KEY_CAPTURE_START,
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef KEY_CAPTURE_ENABLE
+
+// pre_process_record_user() hook: records the event if capture is on.
+void key_capture_record(uint16_t keycode, const keyrecord_t* record);
+
+// Main loop hook: sends one report of buffered events, if any.
+void key_capture_task(void);
+
+// raw_hid_receive_kb() hook: if `data` is a capture request, starts or stops
+// capture and returns true. Events already buffered are still sent after a
+// stop.
+bool key_capture_receive(uint8_t* data, uint8_t length);
+
+// Fills `report` (KEY_CAPTURE_REPORT_SIZE bytes) with up to
+// KEY_CAPTURE_PER_REPORT buffered events, removing them from the buffer.
+// Returns the number of events packed.
+uint8_t key_capture_pack(uint8_t* report);
+
+// Number of buffered events
+uint8_t key_capture_pending(void);
+
+#else
+
+static inline void key_capture_record(uint16_t keycode, const keyrecord_t* record) {
+  (void)keycode;
+  (void)record;
+}
+static inline void key_capture_task(void) {}
+static inline bool key_capture_receive(uint8_t* data, uint8_t length) {
+  (void)data;
+  (void)length;
+  return false;
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,69 @@
+// key_timing.c — Per-key timing tables
+//
+// Generated by tools/gen_key_timing.py from key_timing.json and keymap.c.
+// Do not edit.
+
+#include "key_timing.h"
+#include "achordion.h"
+
+const key_timing_t key_timing_profiles[] PROGMEM = {
+  // 0: defaults
+  {.tapping_term = TAPPING_TERM, .achordion_timeout = 1000, .achordion_streak_timeout = ACHORDION_STREAK_TIMEOUT, .achordion_settle_policy = ACHORDION_SETTLE_ON_PRESS},
+  // 1: KC_GRAVE
+  {.tapping_term = TAPPING_TERM - 70, .achordion_timeout = 1000, .achordion_streak_timeout = ACHORDION_STREAK_TIMEOUT, .achordion_settle_policy = ACHORDION_SETTLE_ON_PRESS},
+  // 2: DUAL_FUNC_1
+  {.tapping_term = TAPPING_TERM + 15, .achordion_timeout = 1000, .achordion_streak_timeout = ACHORDION_STREAK_TIMEOUT, .achordion_settle_policy = ACHORDION_SETTLE_ON_PRESS},
+};
+
+// Profile of every key, KEY_TIMING_TRANSPARENT (255) where it is transparent
+const uint8_t key_timing_map[KEY_TIMING_LAYERS][MATRIX_ROWS][MATRIX_COLS] PROGMEM = {
+  [0] = LAYOUT_voyager(
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    1,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   2,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0
+  ),
+  [1] = LAYOUT_voyager(
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 0,   0,   0,   0,   255, 255, 255,
+    255, 255, 255, 0,   0,   0,   0,   0,   0,   0,   255, 0,
+    255, 255, 255, 0
+  ),
+  [2] = LAYOUT_voyager(
+    255, 0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 0,   0,   255, 255, 0,   0,   0,   0,   0,   0,   255,
+    255, 0,   0,   0,   255, 0,   255, 0,   0,   0,   255, 255,
+    255, 255, 255, 255
+  ),
+  [3] = LAYOUT_voyager(
+    255, 255, 255, 255, 0,   255, 255, 255, 255, 255, 255, 255,
+    255, 0,   0,   255, 255, 255, 0,   255, 255, 255, 255, 255,
+    255, 255, 0,   255, 255, 255, 255, 255, 255, 0,   0,   255,
+    255, 0,   0,   255, 0,   0,   255, 0,   255, 255, 255, 0,
+    255, 255, 255, 255
+  ),
+  [4] = LAYOUT_voyager(
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 0,   0,   255, 255, 255, 255, 0,   255, 255,
+    255, 0,   255, 255, 0,   255, 255, 255, 255, 255, 255, 255,
+    0,   255, 255, 255, 255, 255, 255, 255, 0,   255, 255, 255,
+    255, 255, 255, 255
+  ),
+  [5] = LAYOUT_voyager(
+    255, 0,   0,   0,   255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255
+  ),
+  [6] = LAYOUT_voyager(
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255
+  ),
+};
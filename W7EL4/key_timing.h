@@ -0,0 +1,69 @@
+// key_timing.h — Per-key timing tables
+//
+// Generated by tools/gen_key_timing.py from key_timing.json and keymap.c.
+// Do not edit: change key_timing.json and run
+//   python3 tools/gen_key_timing.py W7EL4
+
+#pragma once
+
+#include "quantum.h"
+
+#define KEY_TIMING_LAYERS 7
+#define KEY_TIMING_HAS_TAPPING_TERM
+#define KEY_TIMING_HAS_ACHORDION_TIMEOUT
+#define KEY_TIMING_HAS_ACHORDION_STREAK_TIMEOUT
+#define KEY_TIMING_HAS_ACHORDION_SETTLE_POLICY
+
+// Map entry of a transparent key
+#define KEY_TIMING_TRANSPARENT 0xFF
+
+typedef struct {
+  uint16_t tapping_term;
+  uint16_t achordion_timeout;
+  uint16_t achordion_streak_timeout;
+  uint8_t achordion_settle_policy;
+} key_timing_t;
+
+extern const key_timing_t key_timing_profiles[] PROGMEM;
+extern const uint8_t key_timing_map[KEY_TIMING_LAYERS][MATRIX_ROWS][MATRIX_COLS] PROGMEM;
+
+// Timing of the key of `event` on the layer its keycode comes from, like
+// QMK's get_event_keycode(): for a press the highest active layer where it is
+// not transparent, for a release the layer its press took it from, however
+// the layers have changed since. Positions outside the matrix, like combos,
+// get the defaults.
+static inline const key_timing_t* key_timing_get(keyevent_t event) {
+  const keypos_t key = event.key;
+  if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {
+    return &key_timing_profiles[0];
+  }
+#if !defined(NO_ACTION_LAYER) && !defined(STRICT_LAYER_RELEASE)
+  const uint8_t layer = event.pressed ? layer_switch_get_layer(key) : read_source_layers_cache(key);
+#else
+  const uint8_t layer = layer_switch_get_layer(key);
+#endif
+  uint8_t profile = KEY_TIMING_TRANSPARENT;
+  if (layer < KEY_TIMING_LAYERS) {
+    profile = pgm_read_byte(&key_timing_map[layer][key.row][key.col]);
+  }
+  if (profile == KEY_TIMING_TRANSPARENT) {
+    profile = pgm_read_byte(&key_timing_map[0][key.row][key.col]);
+  }
+  return &key_timing_profiles[profile];
+}
+
+static inline uint16_t key_timing_tapping_term(keyevent_t event) {
+  return pgm_read_word(&key_timing_get(event)->tapping_term);
+}
+
+static inline uint16_t key_timing_achordion_timeout(keyevent_t event) {
+  return pgm_read_word(&key_timing_get(event)->achordion_timeout);
+}
+
+static inline uint16_t key_timing_achordion_streak_timeout(keyevent_t event) {
+  return pgm_read_word(&key_timing_get(event)->achordion_streak_timeout);
+}
+
+static inline uint8_t key_timing_achordion_settle_policy(keyevent_t event) {
+  return pgm_read_byte(&key_timing_get(event)->achordion_settle_policy);
+}
@@ -1,5 +1,12 @@
 #include QMK_KEYBOARD_H
 #include "version.h"
+#include "key_timing.h"
+#include "led_frames.h"
+#include "achordion.h"
+#include "achordion_stats.h"
+#include "key_capture.h"
+#include "deadline.h"
+#include "send_string_deferred.h"
 #define MOON_LED_LEVEL LED_LEVEL
 #ifndef ZSA_SAFE_RANGE
 #define ZSA_SAFE_RANGE SAFE_RANGE
@@ -102,100 +109,39 @@ combo_t key_combos[COMBO_COUNT] = {
 };
 
 uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record) {
-    switch (keycode) {
-        case KC_GRAVE:
-            return TAPPING_TERM -70;
-        case DUAL_FUNC_1:
-            return TAPPING_TERM + 15;
-        default:
-            return TAPPING_TERM;
-    }
+    (void)keycode;
+    return key_timing_tapping_term(record->event);
 }
 
 
 extern rgb_config_t rgb_matrix_config;
 
-RGB hsv_to_rgb_with_value(HSV hsv) {
-  RGB rgb = hsv_to_rgb( hsv );
-  float f = (float)rgb_matrix_config.hsv.v / UINT8_MAX;
-  return (RGB){ f * rgb.r, f * rgb.g, f * rgb.b };
-}
-
 void keyboard_post_init_user(void) {
   rgb_matrix_enable();
 }
 
-const uint8_t PROGMEM ledmap[][RGB_MATRIX_LED_COUNT][3] = {
-    [0] = { {20,255,255}, {101,255,255}, {101,255,255}, {101,255,255}, {101,255,255}, {101,255,255}, {20,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {0,245,245}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {0,245,245}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {0,245,245}, {0,245,245}, {101,255,255}, {101,255,255}, {101,255,255}, {101,255,255}, {101,255,255}, {20,184,184}, {20,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {20,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {20,255,255}, {169,255,255}, {169,255,255}, {20,255,255}, {20,255,255}, {20,255,255}, {20,255,255}, {0,245,245}, {0,245,245} },
-
-    [1] = { {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {131,255,255}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {20,255,255}, {0,0,0}, {0,0,0}, {0,0,0}, {20,255,255}, {20,255,255}, {20,255,255}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {20,255,255}, {27,255,255}, {27,255,255}, {0,0,0}, {0,0,0}, {0,0,0}, {20,255,255}, {27,255,255}, {27,255,255}, {27,255,255}, {0,0,0}, {0,245,245}, {0,0,0}, {20,184,184} },
-
-    [2] = { {0,0,0}, {131,255,255}, {131,255,255}, {131,255,255}, {131,255,255}, {131,255,255}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {131,255,255}, {131,255,255}, {0,0,0}, {0,0,0}, {131,255,255}, {0,0,0}, {199,218,204}, {199,218,204}, {199,218,204}, {0,0,0}, {131,255,255}, {0,0,0}, {0,0,0}, {131,255,255}, {131,255,255}, {131,255,255}, {131,255,255}, {131,255,255}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {34,230,226}, {0,159,251}, {241,218,204}, {0,159,251}, {34,230,226}, {0,0,0}, {0,0,0}, {241,218,204}, {241,218,204}, {241,218,204}, {0,0,0}, {0,0,0}, {0,245,245}, {0,0,0} },
-
-    [3] = { {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,245,245}, {0,0,0}, {0,0,0}, {0,245,245}, {0,245,245}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,245,245}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,245,245}, {0,245,245}, {0,0,0}, {0,245,245}, {0,245,245}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,245,245}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,245,245}, {0,245,245}, {0,0,0}, {0,0,0}, {0,245,245}, {0,0,0}, {0,0,0}, {0,0,0}, {0,245,245}, {0,0,0}, {0,0,0} },
-
-    [4] = { {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {169,255,255}, {169,255,255}, {0,0,0}, {0,0,0}, {169,255,255}, {0,0,0}, {0,0,0}, {169,255,255}, {0,0,0}, {20,184,184}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {169,255,255}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {169,255,255}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0} },
-
-    [5] = { {0,0,0}, {169,255,255}, {169,255,255}, {169,255,255}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0} },
-
-    [6] = { {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,245,245}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0} },
-
-};
-
 void set_layer_color(int layer) {
+  const RGB* frame = led_frames_get(layer);
   for (int i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
-    HSV hsv = {
-      .h = pgm_read_byte(&ledmap[layer][i][0]),
-      .s = pgm_read_byte(&ledmap[layer][i][1]),
-      .v = pgm_read_byte(&ledmap[layer][i][2]),
-    };
-    if (!hsv.h && !hsv.s && !hsv.v) {
-        rgb_matrix_set_color( i, 0, 0, 0 );
-    } else {
-        RGB rgb = hsv_to_rgb_with_value(hsv);
-        rgb_matrix_set_color(i, rgb.r, rgb.g, rgb.b);
-    }
+    rgb_matrix_set_color(i, frame[i].r, frame[i].g, frame[i].b);
   }
 }
 
+layer_state_t layer_state_set_user(layer_state_t state) {
+  led_frames_invalidate();
+  return state;
+}
+
+layer_state_t default_layer_state_set_user(layer_state_t state) {
+  led_frames_invalidate();
+  return state;
+}
+
 bool rgb_matrix_indicators_user(void) {
   if (rawhid_state.rgb_control) {
       return false;
   }
-  if (!keyboard_config.disable_layer_led) { 
-    switch (biton32(layer_state)) {
-      case 0:
-        set_layer_color(0);
-        break;
-      case 1:
-        set_layer_color(1);
-        break;
-      case 2:
-        set_layer_color(2);
-        break;
-      case 3:
-        set_layer_color(3);
-        break;
-      case 4:
-        set_layer_color(4);
-        break;
-      case 5:
-        set_layer_color(5);
-        break;
-      case 6:
-        set_layer_color(6);
-        break;
-     default:
-        if (rgb_matrix_get_flags() == LED_FLAG_NONE) {
-          rgb_matrix_set_color_all(0, 0, 0);
-        }
-    }
-  } else {
-    if (rgb_matrix_get_flags() == LED_FLAG_NONE) {
-      rgb_matrix_set_color_all(0, 0, 0);
-    }
-  }
-
+  led_frames_indicators();
   return true;
 }
 
@@ -217,6 +163,19 @@ enum {
 
 static tap dance_state[4];
 
+static void unregister_code16_deadline(uint32_t deadline, void *arg) {
+    (void)deadline;
+    unregister_code16((uint16_t)(uintptr_t)arg);
+}
+
+// Releases `keycode` 10 ms from now without blocking the matrix scan.
+static void unregister_code16_later(uint16_t keycode) {
+    if (deadline_schedule_in(10, unregister_code16_deadline, (void *)(uintptr_t)keycode) == DEADLINE_INVALID) {
+        wait_ms(10);
+        unregister_code16(keycode);
+    }
+}
+
 uint8_t dance_step(tap_dance_state_t *state);
 
 uint8_t dance_step(tap_dance_state_t *state) {
@@ -237,6 +196,7 @@ void dance_0_finished(tap_dance_state_t *state, void *user_data);
 void dance_0_reset(tap_dance_state_t *state, void *user_data);
 
 void on_dance_0(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     if(state->count == 3) {
         tap_code16(KC_Z);
         tap_code16(KC_Z);
@@ -248,6 +208,7 @@ void on_dance_0(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_0_finished(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     dance_state[0].step = dance_step(state);
     switch (dance_state[0].step) {
         case SINGLE_TAP: register_code16(KC_Z); break;
@@ -258,12 +219,13 @@ void dance_0_finished(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_0_reset(tap_dance_state_t *state, void *user_data) {
-    wait_ms(10);
+    (void)state;
+    (void)user_data;
     switch (dance_state[0].step) {
-        case SINGLE_TAP: unregister_code16(KC_Z); break;
-        case DOUBLE_TAP: unregister_code16(KC_Z); break;
-        case DOUBLE_HOLD: unregister_code16(RGUI(KC_Z)); break;
-        case DOUBLE_SINGLE_TAP: unregister_code16(KC_Z); break;
+        case SINGLE_TAP: unregister_code16_later(KC_Z); break;
+        case DOUBLE_TAP: unregister_code16_later(KC_Z); break;
+        case DOUBLE_HOLD: unregister_code16_later(RGUI(KC_Z)); break;
+        case DOUBLE_SINGLE_TAP: unregister_code16_later(KC_Z); break;
     }
     dance_state[0].step = 0;
 }
@@ -272,6 +234,7 @@ void dance_1_finished(tap_dance_state_t *state, void *user_data);
 void dance_1_reset(tap_dance_state_t *state, void *user_data);
 
 void on_dance_1(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     if(state->count == 3) {
         tap_code16(KC_X);
         tap_code16(KC_X);
@@ -283,6 +246,7 @@ void on_dance_1(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_1_finished(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     dance_state[1].step = dance_step(state);
     switch (dance_state[1].step) {
         case SINGLE_TAP: register_code16(KC_X); break;
@@ -293,12 +257,13 @@ void dance_1_finished(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_1_reset(tap_dance_state_t *state, void *user_data) {
-    wait_ms(10);
+    (void)state;
+    (void)user_data;
     switch (dance_state[1].step) {
-        case SINGLE_TAP: unregister_code16(KC_X); break;
-        case DOUBLE_TAP: unregister_code16(KC_X); break;
-        case DOUBLE_HOLD: unregister_code16(RGUI(KC_X)); break;
-        case DOUBLE_SINGLE_TAP: unregister_code16(KC_X); break;
+        case SINGLE_TAP: unregister_code16_later(KC_X); break;
+        case DOUBLE_TAP: unregister_code16_later(KC_X); break;
+        case DOUBLE_HOLD: unregister_code16_later(RGUI(KC_X)); break;
+        case DOUBLE_SINGLE_TAP: unregister_code16_later(KC_X); break;
     }
     dance_state[1].step = 0;
 }
@@ -307,6 +272,7 @@ void dance_2_finished(tap_dance_state_t *state, void *user_data);
 void dance_2_reset(tap_dance_state_t *state, void *user_data);
 
 void on_dance_2(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     if(state->count == 3) {
         tap_code16(KC_C);
         tap_code16(KC_C);
@@ -318,6 +284,7 @@ void on_dance_2(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_2_finished(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     dance_state[2].step = dance_step(state);
     switch (dance_state[2].step) {
         case SINGLE_TAP: register_code16(KC_C); break;
@@ -328,12 +295,13 @@ void dance_2_finished(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_2_reset(tap_dance_state_t *state, void *user_data) {
-    wait_ms(10);
+    (void)state;
+    (void)user_data;
     switch (dance_state[2].step) {
-        case SINGLE_TAP: unregister_code16(KC_C); break;
-        case DOUBLE_TAP: unregister_code16(KC_C); break;
-        case DOUBLE_HOLD: unregister_code16(RGUI(KC_C)); break;
-        case DOUBLE_SINGLE_TAP: unregister_code16(KC_C); break;
+        case SINGLE_TAP: unregister_code16_later(KC_C); break;
+        case DOUBLE_TAP: unregister_code16_later(KC_C); break;
+        case DOUBLE_HOLD: unregister_code16_later(RGUI(KC_C)); break;
+        case DOUBLE_SINGLE_TAP: unregister_code16_later(KC_C); break;
     }
     dance_state[2].step = 0;
 }
@@ -342,6 +310,7 @@ void dance_3_finished(tap_dance_state_t *state, void *user_data);
 void dance_3_reset(tap_dance_state_t *state, void *user_data);
 
 void on_dance_3(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     if(state->count == 3) {
         tap_code16(KC_V);
         tap_code16(KC_V);
@@ -353,6 +322,7 @@ void on_dance_3(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_3_finished(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     dance_state[3].step = dance_step(state);
     switch (dance_state[3].step) {
         case SINGLE_TAP: register_code16(KC_V); break;
@@ -363,12 +333,13 @@ void dance_3_finished(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_3_reset(tap_dance_state_t *state, void *user_data) {
-    wait_ms(10);
+    (void)state;
+    (void)user_data;
     switch (dance_state[3].step) {
-        case SINGLE_TAP: unregister_code16(KC_V); break;
-        case DOUBLE_TAP: unregister_code16(KC_V); break;
-        case DOUBLE_HOLD: unregister_code16(RGUI(KC_V)); break;
-        case DOUBLE_SINGLE_TAP: unregister_code16(KC_V); break;
+        case SINGLE_TAP: unregister_code16_later(KC_V); break;
+        case DOUBLE_TAP: unregister_code16_later(KC_V); break;
+        case DOUBLE_HOLD: unregister_code16_later(RGUI(KC_V)); break;
+        case DOUBLE_SINGLE_TAP: unregister_code16_later(KC_V); break;
     }
     dance_state[3].step = 0;
 }
@@ -380,41 +351,62 @@ tap_dance_action_t tap_dance_actions[] = {
         [DANCE_3] = ACTION_TAP_DANCE_FN_ADVANCED(on_dance_3, dance_3_finished, dance_3_reset),
 };
 
+void housekeeping_task_user(void) {
+  deadline_task();
+  housekeeping_task_achordion();
+  key_capture_task();
+}
+
+#ifdef RAW_ENABLE
+// Raw HID requests that Oryx's own handler does not know
+void raw_hid_receive_kb(uint8_t *data, uint8_t length) {
+  if (!achordion_stats_receive(data, length)) {
+    key_capture_receive(data, length);
+  }
+}
+#endif
+
+bool pre_process_record_user(uint16_t keycode, keyrecord_t *record) {
+  key_capture_record(keycode, record);
+  return true;
+}
+
 bool process_record_user(uint16_t keycode, keyrecord_t *record) {
+  if (!process_record_achordion(keycode, record)) { return false; }
   switch (keycode) {
     case ST_MACRO_0:
     if (record->event.pressed) {
-      SEND_STRING(SS_LSFT(SS_TAP(X_SCLN))SS_DELAY(100)  SS_TAP(X_L)SS_DELAY(100)  SS_TAP(X_S));
+      SEND_STRING_DEFERRED(SS_LSFT(SS_TAP(X_SCLN))SS_DELAY(100)  SS_TAP(X_L)SS_DELAY(100)  SS_TAP(X_S));
     }
     break;
     case ST_MACRO_1:
     if (record->event.pressed) {
-      SEND_STRING(SS_TAP(X_D)SS_DELAY(100)  SS_TAP(X_T)SS_DELAY(100)  SS_TAP(X_I)SS_DELAY(100)  SS_TAP(X_M));
+      SEND_STRING_DEFERRED(SS_TAP(X_D)SS_DELAY(100)  SS_TAP(X_T)SS_DELAY(100)  SS_TAP(X_I)SS_DELAY(100)  SS_TAP(X_M));
     }
     break;
     case ST_MACRO_2:
     if (record->event.pressed) {
-      SEND_STRING(SS_LSFT(SS_TAP(X_SCLN))SS_DELAY(100)  SS_TAP(X_A)SS_DELAY(100)  SS_TAP(X_P)SS_DELAY(100)  SS_TAP(X_U)SS_DELAY(100)  SS_TAP(X_P));
+      SEND_STRING_DEFERRED(SS_LSFT(SS_TAP(X_SCLN))SS_DELAY(100)  SS_TAP(X_A)SS_DELAY(100)  SS_TAP(X_P)SS_DELAY(100)  SS_TAP(X_U)SS_DELAY(100)  SS_TAP(X_P));
     }
     break;
     case ST_MACRO_3:
     if (record->event.pressed) {
-      SEND_STRING(SS_LSFT(SS_TAP(X_SCLN))SS_DELAY(100)  SS_TAP(X_L)SS_DELAY(100)  SS_TAP(X_T)  SS_DELAY(100) SS_TAP(X_ENTER));
+      SEND_STRING_DEFERRED(SS_LSFT(SS_TAP(X_SCLN))SS_DELAY(100)  SS_TAP(X_L)SS_DELAY(100)  SS_TAP(X_T)  SS_DELAY(100) SS_TAP(X_ENTER));
     }
     break;
     case ST_MACRO_4:
     if (record->event.pressed) {
-      SEND_STRING(SS_LSFT(SS_TAP(X_A))SS_DELAY(30)  SS_TAP(X_S)SS_DELAY(30)  SS_TAP(X_Y)SS_DELAY(30)  SS_TAP(X_L)SS_DELAY(30)  SS_TAP(X_U)SS_DELAY(30)  SS_TAP(X_M)SS_DELAY(30)  SS_TAP(X_1)SS_DELAY(30)  SS_TAP(X_3)  SS_DELAY(30) SS_TAP(X_ENTER));
+      SEND_STRING_DEFERRED(SS_LSFT(SS_TAP(X_A))SS_DELAY(30)  SS_TAP(X_S)SS_DELAY(30)  SS_TAP(X_Y)SS_DELAY(30)  SS_TAP(X_L)SS_DELAY(30)  SS_TAP(X_U)SS_DELAY(30)  SS_TAP(X_M)SS_DELAY(30)  SS_TAP(X_1)SS_DELAY(30)  SS_TAP(X_3)  SS_DELAY(30) SS_TAP(X_ENTER));
     }
     break;
     case ST_MACRO_5:
     if (record->event.pressed) {
-      SEND_STRING(SS_LSFT(SS_TAP(X_SCLN))SS_DELAY(100)  SS_TAP(X_Y)SS_DELAY(100)  SS_TAP(X_U)SS_DELAY(100)  SS_TAP(X_P));
+      SEND_STRING_DEFERRED(SS_LSFT(SS_TAP(X_SCLN))SS_DELAY(100)  SS_TAP(X_Y)SS_DELAY(100)  SS_TAP(X_U)SS_DELAY(100)  SS_TAP(X_P));
     }
     break;
     case ST_MACRO_6:
     if (record->event.pressed) {
-      SEND_STRING(SS_TAP(X_D)SS_DELAY(100)  SS_TAP(X_D)SS_DELAY(100)  SS_TAP(X_U)SS_DELAY(100)  SS_TAP(X_S));
+      SEND_STRING_DEFERRED(SS_TAP(X_D)SS_DELAY(100)  SS_TAP(X_D)SS_DELAY(100)  SS_TAP(X_U)SS_DELAY(100)  SS_TAP(X_S));
     }
     break;
 
@@ -0,0 +1,295 @@
+// bench_m4.c — Cycle counts of the keymap's hot paths on a Cortex-M4
+//
+// Runs the real keymap.c, achordion.c and friends, built for the Voyager's
+// Cortex-M4F, under QEMU (Makefile). Types a synthetic stream on the base
+// layer one 1 ms matrix scan at a time, as QMK's main loop would, and
+// reports per call of process_record_user(), housekeeping_task_user(),
+// rgb_matrix_indicators_user() and set_layer_color() on every layer, then
+// the cost of a whole scan against the scan budget: CPU_HZ cycles per
+// second, one scan per ms. Also reports both of led_frames.c's brightness
+// scaling paths on a whole frame of LED bytes.
+//
+// Counts are instructions under QEMU (cycles.h), a lower bound on cycles;
+// a scan also runs matrix scanning, debouncing and USB that are not here.
+
+#include "cycles.h"
+#include "led_frames.h"
+#include "quantum.h"
+#include "semihost.h"
+
+#ifndef CPU_HZ
+#define CPU_HZ 72000000  // STM32F303
+#endif
+#define SCAN_BUDGET (CPU_HZ / 1000)
+
+#define STREAM_KEYS 500   // Key presses, each with its release
+#define LAYERS 7          // set_layer_color() layers in keymap.c
+#define SCALE_FRAMES 16   // Frames scaled per led_frames_scale_*() path
+
+extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
+void set_layer_color(int layer);
+
+// ─────────────────────────────────────────────────────────────────────────────
+// QMK functions the keymap calls that host/keyboard.c leaves out
+// ─────────────────────────────────────────────────────────────────────────────
+
+static uint32_t now = 0;
+
+uint16_t timer_read(void) {
+  return (uint16_t)now;
+}
+
+uint32_t timer_read32(void) {
+  return now;
+}
+
+void raw_hid_send(uint8_t* data, uint8_t length) {
+  (void)data;
+  (void)length;
+}
+
+// The keycode at `key` on the highest active layer, through transparent keys
+static uint16_t keycode_at(keypos_t key) {
+  for (int layer = get_highest_layer(layer_state | default_layer_state); layer >= 0; --layer) {
+    const uint16_t keycode = keymaps[layer][key.row][key.col];
+    if (keycode != KC_TRANSPARENT) {
+      return keycode;
+    }
+  }
+  return KC_NO;
+}
+
+// Achordion's settled events re-enter the keymap here.
+void process_record(keyrecord_t* record) {
+  process_record_user(keycode_at(record->event.key), record);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Output
+// ─────────────────────────────────────────────────────────────────────────────
+
+static void print(const char* s) {
+  semihost_write(s);
+}
+
+// `value` right-aligned in `width` columns
+static void print_u32(uint32_t value, int width) {
+  char buffer[12];
+  char* p = buffer + sizeof(buffer) - 1;
+  *p = '\0';
+  do {
+    *--p = '0' + value % 10;
+    value /= 10;
+    --width;
+  } while (value != 0);
+  while (width-- > 0) {
+    *--p = ' ';
+  }
+  print(p);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Measurements
+// ─────────────────────────────────────────────────────────────────────────────
+
+typedef struct {
+  const char* name;
+  uint32_t calls;
+  uint64_t total;
+  uint32_t max;
+} stat_t;
+
+static uint32_t overhead = 0;
+
+static void record_stat(stat_t* stat, uint32_t cycles) {
+  cycles = cycles > overhead ? cycles - overhead : 0;
+  ++stat->calls;
+  stat->total += cycles;
+  if (cycles > stat->max) {
+    stat->max = cycles;
+  }
+}
+
+#define MEASURE(stat, call)                     \
+  do {                                          \
+    const uint32_t start_ = cycles_now();       \
+    call;                                       \
+    record_stat((stat), cycles_since(start_));  \
+  } while (0)
+
+static void print_stat(const stat_t* stat) {
+  print(stat->name);
+  print("\n    calls");
+  print_u32(stat->calls, 8);
+  print("  mean");
+  print_u32(stat->calls ? (uint32_t)(stat->total / stat->calls) : 0, 8);
+  print("  max");
+  print_u32(stat->max, 8);
+  print(" " CYCLES_UNIT "\n");
+}
+
+// Cost of the measurement itself, taken off every sample
+static void calibrate(void) {
+  overhead = UINT32_MAX;
+  for (int i = 0; i < 16; ++i) {
+    const uint32_t start = cycles_now();
+    const uint32_t cycles = cycles_since(start);
+    if (cycles < overhead) {
+      overhead = cycles;
+    }
+  }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Stream
+// ─────────────────────────────────────────────────────────────────────────────
+
+typedef struct {
+  uint32_t time;
+  keypos_t key;
+  bool pressed;
+} event_t;
+
+static event_t stream[STREAM_KEYS * 2];
+static uint32_t stream_length = 0;
+
+static uint32_t rng_state = 0x2545F491;
+
+static uint32_t rng(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+static uint32_t between(uint32_t low, uint32_t high) {
+  return low + rng() % (high - low + 1);
+}
+
+// Inserted in time order: presses come in order, releases overlap them.
+static void add_event(uint32_t time, uint8_t row, uint8_t col, bool pressed) {
+  uint32_t i = stream_length++;
+  for (; i > 0 && stream[i - 1].time > time; --i) {
+    stream[i] = stream[i - 1];
+  }
+  stream[i] = (event_t){time, {.col = col, .row = row}, pressed};
+}
+
+// Rolls over the alpha keys of both halves, home row mods among them, at
+// about 90 wpm, with a space thumb every few keys.
+static void build_stream(void) {
+  uint32_t t = 1000;
+  for (int i = 0; i < STREAM_KEYS; ++i) {
+    uint8_t row, col;
+    if (rng() % 6 == 0) {
+      row = 11;  // Space, a layer-tap thumb
+      col = 6;
+    } else if (rng() & 1) {
+      row = between(1, 3);
+      col = between(1, 5);
+    } else {
+      row = between(7, 9);
+      col = between(0, 4);
+    }
+    add_event(t, row, col, true);
+    add_event(t + between(50, 140), row, col, false);
+    t += between(60, 200);
+  }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Runner
+// ─────────────────────────────────────────────────────────────────────────────
+
+int main(void) {
+  static stat_t record_stats = {.name = "process_record_user"};
+  static stat_t housekeeping_stats = {.name = "housekeeping_task_user"};
+  static stat_t indicator_stats = {.name = "rgb_matrix_indicators_user"};
+  static stat_t layer_stats[LAYERS] = {
+      {.name = "set_layer_color(0)"}, {.name = "set_layer_color(1)"},
+      {.name = "set_layer_color(2)"}, {.name = "set_layer_color(3)"},
+      {.name = "set_layer_color(4)"}, {.name = "set_layer_color(5)"},
+      {.name = "set_layer_color(6)"},
+  };
+  static stat_t scan_stats = {.name = "scan"};
+  static stat_t scale_stats[2] = {
+      {.name = "led_frames_scale_bytes(frame)"},
+      {.name = "led_frames_scale_words(frame)"},
+  };
+  static uint8_t frame[RGB_MATRIX_LED_COUNT * 3];
+
+  cycles_init();
+  calibrate();
+  build_stream();
+  keyboard_post_init_user();
+
+  for (int layer = 0; layer < LAYERS; ++layer) {
+    for (int i = 0; i < 16; ++i) {
+      MEASURE(&layer_stats[layer], set_layer_color(layer));
+    }
+  }
+
+  for (int i = 0; i < SCALE_FRAMES * 2; ++i) {
+    for (uint16_t j = 0; j < sizeof(frame); ++j) {
+      frame[j] = rng();
+    }
+    const uint8_t value = rng();
+    if (i & 1) {
+      MEASURE(&scale_stats[1], led_frames_scale_words(frame, sizeof(frame), value));
+    } else {
+      MEASURE(&scale_stats[0], led_frames_scale_bytes(frame, sizeof(frame), value));
+    }
+  }
+
+  // One scan per ms, from the first event to the last deadline
+  uint32_t next = 0;
+  for (now = stream[0].time; next < stream_length || now <= stream[stream_length - 1].time + 1000; ++now) {
+    const uint32_t scan_start = cycles_now();
+    for (; next < stream_length && stream[next].time == now; ++next) {
+      keyrecord_t record = {
+          .event = {
+              .key = stream[next].key,
+              .time = (uint16_t)now,
+              .type = KEY_EVENT,
+              .pressed = stream[next].pressed,
+          },
+      };
+      MEASURE(&record_stats, process_record_user(keycode_at(record.event.key), &record));
+    }
+    MEASURE(&housekeeping_stats, housekeeping_task_user());
+    MEASURE(&indicator_stats, rgb_matrix_indicators_user());
+    record_stat(&scan_stats, cycles_since(scan_start));
+  }
+
+  print("bench_m4: " CYCLES_UNIT " per call, ");
+  print_u32(stream_length, 0);
+  print(" events\n");
+  print_stat(&record_stats);
+  print_stat(&housekeeping_stats);
+  print_stat(&indicator_stats);
+  for (int layer = 0; layer < LAYERS; ++layer) {
+    print_stat(&layer_stats[layer]);
+  }
+  print_stat(&scale_stats[0]);
+  print_stat(&scale_stats[1]);
+  print_stat(&scan_stats);
+
+  // Every call of a scan at its own worst at once, with one key event and
+  // the costliest layer lit
+  uint32_t worst_layer = 0;
+  for (int layer = 0; layer < LAYERS; ++layer) {
+    if (layer_stats[layer].max > worst_layer) {
+      worst_layer = layer_stats[layer].max;
+    }
+  }
+  const uint32_t bound = record_stats.max + housekeeping_stats.max +
+                         (indicator_stats.max > worst_layer ? indicator_stats.max : worst_layer);
+  print("worst-case scan bound");
+  print_u32(bound, 8);
+  print(" " CYCLES_UNIT ", budget");
+  print_u32(SCAN_BUDGET, 8);
+  print(" cycles, ");
+  print_u32((uint32_t)((uint64_t)bound * 1000 / SCAN_BUDGET), 0);
+  print(" permille\n");
+  return bound <= SCAN_BUDGET ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+// cycles.h — Cycle counter for the Cortex-M4 benchmarks
+//
+// Two sources, chosen at build time:
+// - CYCLES_DWT: the DWT cycle counter, exact cycles on silicon. QEMU does
+//   not model it.
+// - otherwise SysTick on the processor clock. Under QEMU's -icount, virtual
+//   time advances 2^ICOUNT_SHIFT ns per instruction, and mps2-an386 clocks
+//   SysTick at SYSTICK_HZ, so ticks convert to instructions executed. An
+//   instruction count is a lower bound on cycles: loads, taken branches,
+//   multiplies and flash wait states all take more than one on the F303.
+
+#pragma once
+
+#include <stdint.h>
+
+#ifndef ICOUNT_SHIFT
+#define ICOUNT_SHIFT 5
+#endif
+#ifndef SYSTICK_HZ
+#define SYSTICK_HZ 25000000
+#endif
+
+#define CYCLES_REG(address) (*(volatile uint32_t*)(address))
+
+#ifdef CYCLES_DWT
+
+#define DEMCR CYCLES_REG(0xE000EDFC)
+#define DWT_CTRL CYCLES_REG(0xE0001000)
+#define DWT_CYCCNT CYCLES_REG(0xE0001004)
+
+#define CYCLES_UNIT "cycles"
+
+static inline void cycles_init(void) {
+  DEMCR |= 1u << 24;  // TRCENA
+  DWT_CYCCNT = 0;
+  DWT_CTRL |= 1;  // CYCCNTENA
+}
+
+static inline uint32_t cycles_now(void) {
+  return DWT_CYCCNT;
+}
+
+static inline uint32_t cycles_since(uint32_t start) {
+  return DWT_CYCCNT - start;
+}
+
+#else
+
+#define SYST_CSR CYCLES_REG(0xE000E010)
+#define SYST_RVR CYCLES_REG(0xE000E014)
+#define SYST_CVR CYCLES_REG(0xE000E018)
+
+#define CYCLES_UNIT "insns"
+
+// ns of virtual time per SysTick tick and per instruction
+#define SYSTICK_NS (1000000000u / SYSTICK_HZ)
+#define ICOUNT_NS (1u << ICOUNT_SHIFT)
+
+static inline void cycles_init(void) {
+  SYST_RVR = 0x00FFFFFF;
+  SYST_CVR = 0;
+  SYST_CSR = 0x5;  // ENABLE | CLKSOURCE = processor clock, no interrupt
+}
+
+// SysTick counts down from 2^24 - 1 and wraps.
+static inline uint32_t cycles_now(void) {
+  return 0x00FFFFFF - SYST_CVR;
+}
+
+// Good for deltas up to 2^24 ticks, 0.67 s of virtual time.
+static inline uint32_t cycles_since(uint32_t start) {
+  const uint32_t ticks = (cycles_now() - start) & 0x00FFFFFF;
+  return (uint32_t)((uint64_t)ticks * SYSTICK_NS / ICOUNT_NS);
+}
+
+#endif
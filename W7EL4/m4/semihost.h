@@ -0,0 +1,33 @@
+// semihost.h — ARM semihosting calls, for output and exit under QEMU
+//
+// QEMU runs with -semihosting-config enable=on,target=native, so these go
+// to its stdout and exit status; on a board without a debugger attached,
+// BKPT would halt.
+
+#pragma once
+
+#include <stdint.h>
+
+#define SYS_WRITE0 0x04
+#define SYS_EXIT 0x18
+#define ADP_STOPPED_APPLICATION_EXIT 0x20026
+#define ADP_STOPPED_RUN_TIME_ERROR 0x20023
+
+static inline uint32_t semihost_call(uint32_t op, const void* arg) {
+  register uint32_t r0 __asm__("r0") = op;
+  register const void* r1 __asm__("r1") = arg;
+  __asm__ volatile("bkpt 0xAB" : "+r"(r0) : "r"(r1) : "memory");
+  return r0;
+}
+
+static inline void semihost_write(const char* s) {
+  semihost_call(SYS_WRITE0, s);
+}
+
+// Exits QEMU with status 0 for 0, 1 for anything else.
+static inline void __attribute__((noreturn)) semihost_exit(int status) {
+  semihost_call(SYS_EXIT, (const void*)(uintptr_t)(status == 0 ? ADP_STOPPED_APPLICATION_EXIT
+                                                                : ADP_STOPPED_RUN_TIME_ERROR));
+  for (;;) {
+  }
+}
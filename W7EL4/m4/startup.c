@@ -0,0 +1,48 @@
+// startup.c — Reset and fault handlers for the Cortex-M4 benchmarks
+
+#include <stdint.h>
+#include "semihost.h"
+
+extern uint32_t __data_load[], __data_start[], __data_end[];
+extern uint32_t __bss_start[], __bss_end[];
+extern uint32_t __stack_top[];
+
+int main(void);
+
+#define SCB_CPACR (*(volatile uint32_t*)0xE000ED88)
+
+void Reset_Handler(void) {
+  // CP10 and CP11 full access, before any floating point instruction:
+  // the keymap's hsv_to_rgb_with_value() uses the FPU.
+  SCB_CPACR |= 0xFu << 20;
+  __asm__ volatile("dsb\n\tisb" ::: "memory");
+
+  for (uint32_t *src = __data_load, *dst = __data_start; dst < __data_end;) {
+    *dst++ = *src++;
+  }
+  for (uint32_t* dst = __bss_start; dst < __bss_end;) {
+    *dst++ = 0;
+  }
+  semihost_exit(main());
+}
+
+static void Fault_Handler(void) {
+  semihost_write("bench_m4: fault\n");
+  semihost_exit(1);
+}
+
+__attribute__((section(".vectors"), used)) static void (*const vectors[16])(void) = {
+    (void (*)(void))__stack_top,
+    Reset_Handler,
+    Fault_Handler,  // NMI
+    Fault_Handler,  // HardFault
+    Fault_Handler,  // MemManage
+    Fault_Handler,  // BusFault
+    Fault_Handler,  // UsageFault
+    0, 0, 0, 0,
+    Fault_Handler,  // SVCall
+    Fault_Handler,  // DebugMonitor
+    0,
+    Fault_Handler,  // PendSV
+    Fault_Handler,  // SysTick
+};
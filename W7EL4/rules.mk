@@ -10,4 +10,13 @@ REPEAT_KEY_ENABLE = yes
 NKRO_ENABLE = no
 COMBO_ENABLE = yes
 TAP_DANCE_ENABLE = yes
-SRC += achordion.c
+SRC += achordion.c achordion_stats.c deadline.c send_string_deferred.c key_timing.c led_frames.c chord_exceptions.c
+OPT_DEFS += -DKEY_TIMING_ENABLE -DCHORD_EXCEPTIONS_ENABLE
+
+# Keystroke capture over raw HID, for host/capture: opt in with
+# KEY_CAPTURE_ENABLE = yes
+KEY_CAPTURE_ENABLE ?= no
+ifeq ($(strip $(KEY_CAPTURE_ENABLE)), yes)
+  SRC += key_capture.c
+  OPT_DEFS += -DKEY_CAPTURE_ENABLE
+endif
@@ -0,0 +1,75 @@
+// send_string_deferred.c — Non-blocking SEND_STRING player
+
+#include "send_string_deferred.h"
+#include "deadline.h"
+
+// Strings waiting to play; queue[0] is playing, `cursor` is its position.
+static const char* queue[SEND_STRING_DEFERRED_QUEUE + 1];
+static uint8_t queue_length = 0;
+static const char* cursor = NULL;
+
+static void play(void);
+
+static void resume(uint32_t deadline, void* arg) {
+  (void)deadline;
+  (void)arg;
+  play();
+}
+
+static char next_char(void) {
+  return (char)pgm_read_byte(cursor++);
+}
+
+// Plays the current string up to its next delay or its end. Mirrors the
+// decoding of send_string_with_delay_impl(), except for SS_DELAY.
+static void play(void) {
+  while (cursor != NULL) {
+    char ascii_code = next_char();
+
+    if (ascii_code == 0) {
+      // End of this string: start the next one, if any.
+      --queue_length;
+      memmove(queue, queue + 1, queue_length * sizeof(queue[0]));
+      cursor = queue_length > 0 ? queue[0] : NULL;
+    } else if (ascii_code == SS_QMK_PREFIX) {
+      ascii_code = next_char();
+      if (ascii_code == SS_TAP_CODE) {
+        tap_code(next_char());
+      } else if (ascii_code == SS_DOWN_CODE) {
+        register_code(next_char());
+      } else if (ascii_code == SS_UP_CODE) {
+        unregister_code(next_char());
+      } else if (ascii_code == SS_DELAY_CODE) {
+        uint32_t ms = 0;
+        for (ascii_code = next_char(); ascii_code != '|';
+             ascii_code = next_char()) {
+          ms = ms * 10 + ascii_code - '0';
+        }
+        if (ms > 0 &&
+            deadline_schedule_in(ms, resume, NULL) != DEADLINE_INVALID) {
+          return;
+        }
+        // No room in the scheduler: fall back to blocking.
+        wait_ms(ms);
+      }
+    } else {
+      send_char(ascii_code);
+    }
+  }
+}
+
+bool send_string_deferred_P(const char* str) {
+  if (queue_length == SEND_STRING_DEFERRED_QUEUE + 1) {
+    return false;
+  }
+  queue[queue_length++] = str;
+  if (cursor == NULL) {
+    cursor = str;
+    play();
+  }
+  return true;
+}
+
+bool send_string_deferred_active(void) {
+  return cursor != NULL;
+}
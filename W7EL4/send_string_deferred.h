@@ -0,0 +1,31 @@
+// send_string_deferred.h — SEND_STRING that does not block on SS_DELAY
+//
+// Plays the same strings as SEND_STRING, but each SS_DELAY schedules the rest
+// of the string on the deadline scheduler instead of calling wait_ms(), so
+// the matrix keeps being scanned while a macro types.
+
+#pragma once
+
+#include "quantum.h"
+
+// Maximum number of macros waiting to play behind the current one.
+#ifndef SEND_STRING_DEFERRED_QUEUE
+#define SEND_STRING_DEFERRED_QUEUE 4
+#endif
+
+#define SEND_STRING_DEFERRED(string) send_string_deferred_P(PSTR(string))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Plays `str`, a string in PROGMEM. If a macro is already playing, `str`
+// starts when it ends. Returns false if the queue is full.
+bool send_string_deferred_P(const char* str);
+
+// Returns true while a macro is playing.
+bool send_string_deferred_active(void);
+
+#ifdef __cplusplus
+}
+#endif
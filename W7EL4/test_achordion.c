@@ -2,11 +2,15 @@
 // Test framework designed for QMK environment
 
 // Define testing flag before includes
+#ifndef ACHORDION_TESTING
 #define ACHORDION_TESTING
+#endif
 
 #include "quantum.h"
 #include "achordion.h"
 #include "achordion_test.h"
+#include "achordion_stats.h"
+#include "deadline.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -32,13 +36,22 @@ static int test_failed = 0;
 } while(0)
 
 // Mock variables for testing
-static uint16_t mock_timer = 0;
+static uint32_t mock_timer = 0;
 static bool mock_process_record_called = false;
 static keyrecord_t mock_processed_record;
 static uint16_t mock_processed_keycode;
 
+// Every record plumbed through process_record, in order
+#define MOCK_LOG_SIZE 32
+static keyrecord_t mock_record_log[MOCK_LOG_SIZE];
+static int mock_record_log_count = 0;
+
 // Mock timer functions
 uint16_t timer_read(void) {
+    return (uint16_t)mock_timer;
+}
+
+uint32_t timer_read32(void) {
     return mock_timer;
 }
 
@@ -50,17 +63,77 @@ bool timer_expired(uint16_t current, uint16_t target) {
 void process_record(keyrecord_t* record) {
     mock_process_record_called = true;
     mock_processed_record = *record;
+    if (mock_record_log_count < MOCK_LOG_SIZE) {
+        mock_record_log[mock_record_log_count++] = *record;
+    }
     // For testing, we also need to capture the keycode
     // In real QMK, this would be handled differently
 }
 
+// Mock mods state for eager mods
+static uint8_t mock_mods = 0;
+static int mock_mods_reports = 0;
+
+void register_mods(uint8_t mods) {
+    mock_mods |= mods;
+    mock_mods_reports++;
+}
+
+void unregister_mods(uint8_t mods) {
+    mock_mods &= ~mods;
+    mock_mods_reports++;
+}
+
+// Ctrl+C waits for a release before settling; everything else settles on press
+#define RELEASE_POLICY_KEY MT(MOD_LCTL, KC_C)
+
+uint8_t achordion_settle_policy(uint16_t tap_hold_keycode) {
+    return tap_hold_keycode == RELEASE_POLICY_KEY ? ACHORDION_SETTLE_ON_RELEASE
+                                                  : ACHORDION_SETTLE_ON_PRESS;
+}
+
+// Hands of a split keyboard, 6 rows per side, as gen_chord_exceptions.py
+// writes them. The thumb keys at (5, 0) and (11, 6) go with either hand.
+#ifdef CHORD_EXCEPTIONS_ENABLE
+#include "chord_exceptions.h"
+
+#define L CHORD_HAND_LEFT
+#define R CHORD_HAND_RIGHT
+const uint8_t chord_hands[MATRIX_ROWS][MATRIX_COLS] PROGMEM = {
+    {L, L, L, L, L, L, L},
+    {L, L, L, L, L, L, L},
+    {L, L, L, L, L, L, L},
+    {L, L, L, L, L, L, L},
+    {L, L, L, L, L, L, L},
+    {0, L, L, L, L, L, L},
+    {R, R, R, R, R, R, R},
+    {R, R, R, R, R, R, R},
+    {R, R, R, R, R, R, R},
+    {R, R, R, R, R, R, R},
+    {R, R, R, R, R, R, R},
+    {R, R, R, R, R, R, 0},
+};
+#undef L
+#undef R
+
+// GUI on (3, 2) may chord with C on (2, 3), on the same hand
+const chord_exception_mask_t chord_exception_tap_hold[MATRIX_ROWS][MATRIX_COLS] PROGMEM = {
+    [2] = {[3] = 0x01},
+};
+const chord_exception_mask_t chord_exception_other[MATRIX_ROWS][MATRIX_COLS] PROGMEM = {
+    [3] = {[2] = 0x01},
+};
+#endif
+
 // Helper functions to create test records
 keyrecord_t create_keyrecord(uint16_t keycode, bool pressed, uint8_t col, uint8_t row, uint16_t time) {
+    (void)keycode;
     keyrecord_t record = {0};
     record.event.key.col = col;
     record.event.key.row = row;
     record.event.pressed = pressed;
     record.event.time = time;
+    record.event.type = KEY_EVENT;
     record.tap.count = 0;
     record.tap.interrupted = false;
     return record;
@@ -78,6 +151,17 @@ void reset_mocks(void) {
     mock_process_record_called = false;
     memset(&mock_processed_record, 0, sizeof(mock_processed_record));
     mock_processed_keycode = KC_NO;
+    mock_record_log_count = 0;
+    mock_mods = 0;
+    mock_mods_reports = 0;
+}
+
+// Returns true if log entry `i` is an event for the key at (col, row)
+static bool logged(int i, uint8_t col, uint8_t row, bool pressed) {
+    return i < mock_record_log_count &&
+           mock_record_log[i].event.key.col == col &&
+           mock_record_log[i].event.key.row == row &&
+           mock_record_log[i].event.pressed == pressed;
 }
 
 // Reset achordion state for testing
@@ -106,17 +190,21 @@ void test_quick_tap_registration(void) {
     
     // Should be intercepted (return false) and enter unsettled state
     TEST_ASSERT(!result1, "Tap-hold key press should be intercepted");
-    TEST_ASSERT(achordion_state == STATE_UNSETTLED, "Should enter unsettled state");
-    TEST_ASSERT(tap_hold_keycode == keycode, "Should store the tap-hold keycode");
+    TEST_ASSERT(achordion_pending_count_for_testing() == 1, "Should enter unsettled state");
+    TEST_ASSERT(achordion_pending_keycode_for_testing(0) == keycode, "Should store the tap-hold keycode");
     
     // Release the key quickly (before timeout)
     keyrecord_t release_record = create_tap_hold_record(keycode, false, 0, 2, 150);
     bool result2 = process_record_achordion(keycode, &release_record);
+    housekeeping_task_achordion();
     
     // Should be intercepted and state should reset
     TEST_ASSERT(!result2, "Tap-hold key release should be intercepted");
-    TEST_ASSERT(achordion_state == STATE_RELEASED, "Should return to released state");
-    TEST_ASSERT(tap_hold_keycode == KC_NO, "Should clear stored keycode");
+    TEST_ASSERT(achordion_pending_count_for_testing() == 0, "Should return to released state");
+    TEST_ASSERT(mock_record_log_count == 2 && logged(0, 0, 2, true) && logged(1, 0, 2, false),
+                "Should plumb a tap press and release");
+    TEST_ASSERT(mock_record_log[0].tap.count == 1, "Plumbed press should be a tap");
+    TEST_ASSERT(achordion_pending_keycode_for_testing(0) == KC_NO, "Should clear stored keycode");
 }
 
 // Test Case 2: process_record_achordion correctly registers a hold when 
@@ -136,17 +224,18 @@ void test_timeout_hold_registration(void) {
     
     bool result1 = process_record_achordion(keycode, &press_record);
     TEST_ASSERT(!result1, "Tap-hold key press should be intercepted");
-    TEST_ASSERT(achordion_state == STATE_UNSETTLED, "Should enter unsettled state");
+    TEST_ASSERT(achordion_pending_count_for_testing() == 1, "Should enter unsettled state");
     
     // Simulate time passing beyond timeout (default is 1000ms)
     mock_timer = 1200; // 1200ms > 100ms + 1000ms timeout
     
-    // Call housekeeping task to trigger timeout
+    // Run the deadline scheduler, then housekeeping, as the main loop does
+    deadline_task();
     housekeeping_task_achordion();
     
-    TEST_ASSERT(achordion_state == STATE_RELEASED, "Should settle as hold and return to released state");
+    TEST_ASSERT(achordion_pending_count_for_testing() == 0, "Should settle as hold and return to released state");
     TEST_ASSERT(mock_process_record_called, "Should have called process_record for hold action");
-    TEST_ASSERT(tap_hold_keycode == KC_NO, "Should clear stored keycode after settling");
+    TEST_ASSERT(achordion_pending_keycode_for_testing(0) == KC_NO, "Should clear stored keycode after settling");
 }
 
 // Test Case 3: achordion_opposite_hands correctly identifies keys pressed on different hands
@@ -156,18 +245,18 @@ void test_opposite_hands_detection(void) {
     // Left hand key (column 0, assuming split keyboard)
     keyrecord_t left_record = create_keyrecord(KC_A, true, 0, 2, 100);
     
-    // Right hand key (column 6, assuming 6-column split)
-    keyrecord_t right_record = create_keyrecord(KC_J, true, 6, 2, 100);
+    // Right hand key (row 8, split keyboard with 6 rows per side)
+    keyrecord_t right_record = create_keyrecord(KC_J, true, 0, 8, 100);
     
     // Same hand keys
     keyrecord_t left_record2 = create_keyrecord(KC_S, true, 1, 2, 100);
     
     // Test opposite hands
     bool opposite1 = achordion_opposite_hands(&left_record, &right_record);
-    TEST_ASSERT(opposite1, "Should detect opposite hands (left col 0 vs right col 6)");
+    TEST_ASSERT(opposite1, "Should detect opposite hands (left row 2 vs right row 8)");
     
     bool opposite2 = achordion_opposite_hands(&right_record, &left_record);
-    TEST_ASSERT(opposite2, "Should detect opposite hands (right col 6 vs left col 0)");
+    TEST_ASSERT(opposite2, "Should detect opposite hands (right row 8 vs left row 2)");
     
     // Test same hand
     bool same_hand = achordion_opposite_hands(&left_record, &left_record2);
@@ -194,18 +283,19 @@ void test_chording_condition_hold(void) {
     bool result1 = process_record_achordion(tap_hold_keycode_val, &tap_hold_press);
     
     TEST_ASSERT(!result1, "Tap-hold key press should be intercepted");
-    TEST_ASSERT(achordion_state == STATE_UNSETTLED, "Should enter unsettled state");
+    TEST_ASSERT(achordion_pending_count_for_testing() == 1, "Should enter unsettled state");
     
     // Press another key on opposite hand (right hand)
     uint16_t other_keycode = KC_J;
-    keyrecord_t other_press = create_keyrecord(other_keycode, true, 6, 2, 150);
+    keyrecord_t other_press = create_keyrecord(other_keycode, true, 0, 8, 150);
     bool result2 = process_record_achordion(other_keycode, &other_press);
+    housekeeping_task_achordion();
     
     // Should settle as hold due to opposite hands condition
     TEST_ASSERT(!result2, "Other key press should be intercepted during settlement");
-    TEST_ASSERT(achordion_state == STATE_RELEASED, "Should settle and return to released state");
+    TEST_ASSERT(achordion_pending_count_for_testing() == 0, "Should settle and return to released state");
     TEST_ASSERT(mock_process_record_called, "Should have processed the hold action");
-    TEST_ASSERT(tap_hold_keycode == KC_NO, "Should clear stored keycode after settling");
+    TEST_ASSERT(achordion_pending_keycode_for_testing(0) == KC_NO, "Should clear stored keycode after settling");
 }
 
 // Test Case 5: process_record_achordion correctly settles a tap-hold key as a tap 
@@ -224,22 +314,25 @@ void test_chording_condition_tap(void) {
     bool result1 = process_record_achordion(tap_hold_keycode_val, &tap_hold_press);
     
     TEST_ASSERT(!result1, "Tap-hold key press should be intercepted");
-    TEST_ASSERT(achordion_state == STATE_UNSETTLED, "Should enter unsettled state");
+    TEST_ASSERT(achordion_pending_count_for_testing() == 1, "Should enter unsettled state");
     
     // Press another key on same hand (left hand)
     uint16_t other_keycode = KC_S;
     keyrecord_t other_press = create_keyrecord(other_keycode, true, 1, 2, 150);
     bool result2 = process_record_achordion(other_keycode, &other_press);
+    housekeeping_task_achordion();
     
     // Should settle as tap due to same hand condition
     TEST_ASSERT(!result2, "Other key press should be intercepted during settlement");
-    TEST_ASSERT(achordion_state == STATE_RELEASED, "Should settle and return to released state");
+    TEST_ASSERT(achordion_pending_count_for_testing() == 0, "Should settle and return to released state");
     TEST_ASSERT(mock_process_record_called, "Should have processed the tap action");
-    TEST_ASSERT(tap_hold_keycode == KC_NO, "Should clear stored keycode after settling");
+    TEST_ASSERT(achordion_pending_keycode_for_testing(0) == KC_NO, "Should clear stored keycode after settling");
     
     // Verify that the tap action was processed correctly
-    TEST_ASSERT(mock_processed_record.tap.count == 1, "Should have set tap count to 1");
-    TEST_ASSERT(mock_processed_record.tap.interrupted == true, "Should have marked tap as interrupted");
+    TEST_ASSERT(mock_record_log[0].tap.count == 1, "Should have set tap count to 1");
+    TEST_ASSERT(mock_record_log[0].tap.interrupted == true, "Should have marked tap as interrupted");
+    TEST_ASSERT(logged(0, 0, 2, true) && logged(1, 0, 2, false) && logged(2, 1, 2, true),
+                "Should plumb the tap before the other key");
 }
 
 // Additional test: Non-tap-hold keys should pass through
@@ -256,8 +349,8 @@ void test_non_tap_hold_passthrough(void) {
     bool result = process_record_achordion(keycode, &press_record);
     
     TEST_ASSERT(result, "Non-tap-hold keys should pass through (return true)");
-    TEST_ASSERT(achordion_state == STATE_RELEASED, "State should remain released");
-    TEST_ASSERT(tap_hold_keycode == KC_NO, "Should not store regular keycodes");
+    TEST_ASSERT(achordion_pending_count_for_testing() == 0, "State should remain released");
+    TEST_ASSERT(achordion_pending_keycode_for_testing(0) == KC_NO, "Should not store regular keycodes");
 }
 
 // Additional test: Layer tap keys behavior
@@ -275,21 +368,509 @@ void test_layer_tap_behavior(void) {
     bool result1 = process_record_achordion(keycode, &press_record);
     
     TEST_ASSERT(!result1, "Layer tap key press should be intercepted");
-    TEST_ASSERT(achordion_state == STATE_UNSETTLED, "Should enter unsettled state");
+    TEST_ASSERT(achordion_pending_count_for_testing() == 1, "Should enter unsettled state");
     
     // Press key on opposite hand
     uint16_t other_keycode = KC_J;
-    keyrecord_t other_press = create_keyrecord(other_keycode, true, 6, 2, 150);
+    keyrecord_t other_press = create_keyrecord(other_keycode, true, 0, 8, 150);
     bool result2 = process_record_achordion(other_keycode, &other_press);
     
     TEST_ASSERT(!result2, "Should handle layer tap with chording");
-    TEST_ASSERT(achordion_state == STATE_RELEASED, "Should settle layer tap");
+    TEST_ASSERT(achordion_pending_count_for_testing() == 0, "Should settle layer tap");
+}
+
+// Additional test: Rolling two home row mods settles both, in press order
+void test_rolled_tap_hold_keys(void) {
+    printf("\n=== Additional Test: Rolled Tap-Hold Keys ===\n");
+    
+    reset_mocks();
+    reset_achordion_state();
+    
+    uint16_t ctrl_n = MT(MOD_LCTL, KC_A);
+    uint16_t alt_r = MT(MOD_LALT, KC_S);
+    
+    keyrecord_t n_press = create_tap_hold_record(ctrl_n, true, 1, 2, 100);
+    keyrecord_t r_press = create_tap_hold_record(alt_r, true, 2, 2, 130);
+    process_record_achordion(ctrl_n, &n_press);
+    bool result = process_record_achordion(alt_r, &r_press);
+    
+    TEST_ASSERT(!result, "Second tap-hold key should be intercepted too");
+    TEST_ASSERT(achordion_pending_count_for_testing() == 2, "Both keys should be pending");
+    TEST_ASSERT(achordion_pending_keycode_for_testing(1) == alt_r, "Second key should follow the first");
+    
+    // Release the second key first: a tap, whose press decides the first key
+    keyrecord_t r_release = create_tap_hold_record(alt_r, false, 2, 2, 160);
+    process_record_achordion(alt_r, &r_release);
+    housekeeping_task_achordion();
+    TEST_ASSERT(achordion_pending_count_for_testing() == 0, "Both keys should settle");
+    TEST_ASSERT(mock_record_log_count == 4 && logged(0, 1, 2, true) && logged(1, 1, 2, false) &&
+                logged(2, 2, 2, true) && logged(3, 2, 2, false),
+                "Taps should be plumbed in press order");
+    TEST_ASSERT(mock_record_log[0].tap.interrupted, "Same-hand roll should settle the first key as tap");
+    
+    keyrecord_t n_release = create_tap_hold_record(ctrl_n, false, 1, 2, 180);
+    TEST_ASSERT(!process_record_achordion(ctrl_n, &n_release), "First key's release should be dropped");
+    housekeeping_task_achordion();
+    TEST_ASSERT(mock_record_log_count == 4, "First key's tap should have released it already");
+}
+
+// Additional test: A cross-hand tap-hold key tapped while another is
+// pending decides it right away instead of leaving it to its timeout
+void test_tapped_tap_hold_decides_pending(void) {
+    printf("\n=== Additional Test: Tapped Tap-Hold Key Decides Pending ===\n");
+    
+    reset_mocks();
+    reset_achordion_state();
+    
+    uint16_t ctrl_n = MT(MOD_LCTL, KC_A);
+    uint16_t shift_h = MT(MOD_RSFT, KC_H);
+    keyrecord_t n_press = create_tap_hold_record(ctrl_n, true, 1, 2, 100);
+    keyrecord_t h_press = create_tap_hold_record(shift_h, true, 1, 8, 400);
+    keyrecord_t h_release = create_tap_hold_record(shift_h, false, 1, 8, 700);
+    process_record_achordion(ctrl_n, &n_press);
+    process_record_achordion(shift_h, &h_press);
+    process_record_achordion(shift_h, &h_release);
+    housekeeping_task_achordion();
+    
+    TEST_ASSERT(achordion_pending_count_for_testing() == 0, "Both keys should settle on the release");
+    TEST_ASSERT(mock_record_log_count == 3 && logged(0, 1, 2, true) && mock_record_log[0].tap.count == 0 &&
+                logged(1, 1, 8, true) && logged(2, 1, 8, false),
+                "First key should hold, then the second key tap");
+}
+
+// Additional test: A stack of held mods all settle against the next key
+void test_stacked_mods_hold(void) {
+    printf("\n=== Additional Test: Stacked Mods Hold ===\n");
+    
+    reset_mocks();
+    reset_achordion_state();
+    
+    uint16_t ctrl_n = MT(MOD_LCTL, KC_A);
+    uint16_t alt_r = MT(MOD_LALT, KC_S);
+    
+    keyrecord_t n_press = create_tap_hold_record(ctrl_n, true, 1, 2, 100);
+    keyrecord_t r_press = create_tap_hold_record(alt_r, true, 2, 2, 130);
+    keyrecord_t j_press = create_keyrecord(KC_J, true, 0, 8, 200);
+    process_record_achordion(ctrl_n, &n_press);
+    process_record_achordion(alt_r, &r_press);
+    process_record_achordion(KC_J, &j_press);
+    housekeeping_task_achordion();
+    
+    TEST_ASSERT(achordion_pending_count_for_testing() == 0, "Both mods should settle");
+    TEST_ASSERT(mock_record_log_count == 3 && logged(0, 1, 2, true) && logged(1, 2, 2, true) &&
+                logged(2, 0, 8, true), "Both holds should precede the other key");
+    TEST_ASSERT(mock_record_log[0].tap.count == 0 && mock_record_log[1].tap.count == 0,
+                "Both mods should be plumbed as holds");
+}
+
+// Additional test: A mod pressed while another is held does not start a
+// typing streak, and decides the first one as hold right away, so Ctrl and
+// Shift across hands both hold
+void test_stacked_cross_hand_mods(void) {
+    printf("\n=== Additional Test: Stacked Cross-Hand Mods ===\n");
+    
+    reset_mocks();
+    reset_achordion_state();
+    
+    uint16_t ctrl_n = MT(MOD_LCTL, KC_A);
+    uint16_t shift_h = MT(MOD_RSFT, KC_H);
+    mock_timer = 100;
+    keyrecord_t n_press = create_tap_hold_record(ctrl_n, true, 1, 2, 100);
+    process_record_achordion(ctrl_n, &n_press);
+    mock_timer = 100 + ACHORDION_STREAK_TIMEOUT / 2;
+    keyrecord_t h_press = create_tap_hold_record(shift_h, true, 1, 8, mock_timer);
+    process_record_achordion(shift_h, &h_press);
+    
+    housekeeping_task_achordion();
+    TEST_ASSERT(achordion_pending_count_for_testing() == 1 &&
+                achordion_pending_keycode_for_testing(0) == shift_h,
+                "Second mod should settle the first and wait to be settled");
+    TEST_ASSERT(achordion_get_counters()->streak_taps == 0, "Held first mod should not start a streak");
+    TEST_ASSERT(mock_record_log_count == 1 && logged(0, 1, 2, true) && mock_record_log[0].tap.count == 0,
+                "First mod should hold on the second one's press");
+    
+    mock_timer = 2000;
+    deadline_task();
+    housekeeping_task_achordion();
+    TEST_ASSERT(mock_record_log_count == 2 && logged(0, 1, 2, true) && logged(1, 1, 8, true) &&
+                mock_record_log[0].tap.count == 0 && mock_record_log[1].tap.count == 0,
+                "Both mods should hold");
+}
+
+// Additional test: Overflowing the pending table settles the oldest key
+void test_pending_table_capacity(void) {
+    printf("\n=== Additional Test: Pending Table Capacity ===\n");
+    
+    reset_mocks();
+    reset_achordion_state();
+    
+    uint8_t i;
+    for (i = 0; i <= ACHORDION_MAX_PENDING; ++i) {
+        uint16_t keycode = MT(MOD_LCTL, KC_A + i);
+        keyrecord_t press = create_tap_hold_record(keycode, true, i, 2, 100 + 10 * i);
+        process_record_achordion(keycode, &press);
+    }
+    housekeeping_task_achordion();
+    
+    TEST_ASSERT(achordion_pending_count_for_testing() == ACHORDION_MAX_PENDING,
+                "Table should never exceed its capacity");
+    TEST_ASSERT(logged(0, 0, 2, true) && mock_record_log[0].tap.count == 1,
+                "Oldest key should settle (same hand: tap)");
+    TEST_ASSERT(achordion_pending_keycode_for_testing(0) == MT(MOD_LCTL, KC_A + 1),
+                "Remaining keys should keep their order");
+}
+
+// Additional test: Settled events are replayed from the main loop, in one pass
+void test_deferred_replay(void) {
+    printf("\n=== Additional Test: Deferred Replay ===\n");
+    
+    reset_mocks();
+    reset_achordion_state();
+    
+    uint16_t ctrl_n = MT(MOD_LCTL, KC_A);
+    keyrecord_t n_press = create_tap_hold_record(ctrl_n, true, 1, 2, 100);
+    keyrecord_t s_press = create_keyrecord(KC_S, true, 2, 2, 120);
+    keyrecord_t s_release = create_keyrecord(KC_S, false, 2, 2, 140);
+    keyrecord_t j_press = create_keyrecord(KC_J, true, 0, 8, 150);
+    process_record_achordion(ctrl_n, &n_press);
+    process_record_achordion(KC_S, &s_press);
+    process_record_achordion(KC_S, &s_release);
+    bool result = process_record_achordion(KC_J, &j_press);
+    
+    TEST_ASSERT(!result, "Events behind settled keys should be queued");
+    TEST_ASSERT(mock_record_log_count == 0, "Nothing should be processed inside process_record_achordion");
+    TEST_ASSERT(achordion_buffered_events_for_testing() == 4, "Tap, other key and its release should be buffered");
+    
+    housekeeping_task_achordion();
+    TEST_ASSERT(achordion_buffered_events_for_testing() == 0, "Whole burst should replay in one pass");
+    TEST_ASSERT(mock_record_log_count == 5 && logged(0, 1, 2, true) && logged(1, 1, 2, false) &&
+                logged(2, 2, 2, true) && logged(3, 2, 2, false) && logged(4, 0, 8, true),
+                "Replay should follow timestamp order");
+    
+    keyrecord_t j_release = create_keyrecord(KC_J, false, 0, 8, 200);
+    TEST_ASSERT(process_record_achordion(KC_J, &j_release), "Events pass through once the buffer is empty");
+}
+
+// Additional test: A home row mod pressed mid-word settles as tap at once
+void test_typing_streak(void) {
+    printf("\n=== Additional Test: Typing Streak ===\n");
+    
+    reset_mocks();
+    reset_achordion_state();
+    
+    uint16_t ctrl_n = MT(MOD_LCTL, KC_A);
+    keyrecord_t j_press = create_keyrecord(KC_J, true, 0, 8, 100);
+    keyrecord_t n_press = create_tap_hold_record(ctrl_n, true, 1, 2, 100 + ACHORDION_STREAK_TIMEOUT / 2);
+    process_record_achordion(KC_J, &j_press);
+    bool result = process_record_achordion(ctrl_n, &n_press);
+    housekeeping_task_achordion();
+    
+    TEST_ASSERT(!result, "Streak tap should be intercepted");
+    TEST_ASSERT(achordion_pending_count_for_testing() == 0, "Key in a streak should not wait");
+    TEST_ASSERT(mock_record_log_count == 2 && logged(0, 1, 2, true) && logged(1, 1, 2, false) &&
+                mock_record_log[0].tap.count == 1, "Key in a streak should settle as tap");
+    TEST_ASSERT(achordion_get_counters()->streak_taps == 1, "Streak counter should count the fast path");
+    
+    // The tap already released the key: its physical release, which QMK
+    // would take for a hold release, is dropped.
+    keyrecord_t n_release = create_tap_hold_record(ctrl_n, false, 1, 2, 190);
+    TEST_ASSERT(!process_record_achordion(ctrl_n, &n_release), "Streak tap's release should be dropped");
+    housekeeping_task_achordion();
+    TEST_ASSERT(mock_record_log_count == 2, "Nothing more should be plumbed");
+    
+    // After a pause the same key is unsettled again
+    keyrecord_t n_again = create_tap_hold_record(ctrl_n, true, 1, 2, 200 + 2 * ACHORDION_STREAK_TIMEOUT);
+    process_record_achordion(ctrl_n, &n_again);
+    TEST_ASSERT(achordion_pending_count_for_testing() == 1, "Key after a pause should be unsettled");
+    TEST_ASSERT(achordion_get_counters()->streak_taps == 1, "Streak counter should not change");
+}
+
+// Additional test: A settled hold ends the typing streak
+void test_hold_breaks_streak(void) {
+    printf("\n=== Additional Test: Hold Breaks Streak ===\n");
+    
+    reset_mocks();
+    reset_achordion_state();
+    
+    uint16_t ctrl_n = MT(MOD_LCTL, KC_A);
+    uint16_t alt_r = MT(MOD_LALT, KC_S);
+    keyrecord_t n_press = create_tap_hold_record(ctrl_n, true, 1, 2, 100);
+    keyrecord_t j_press = create_keyrecord(KC_J, true, 0, 8, 300);
+    keyrecord_t r_press = create_tap_hold_record(alt_r, true, 2, 2, 300 + ACHORDION_STREAK_TIMEOUT / 2);
+    process_record_achordion(ctrl_n, &n_press);
+    process_record_achordion(KC_J, &j_press);
+    process_record_achordion(alt_r, &r_press);
+    
+    TEST_ASSERT(achordion_pending_count_for_testing() == 1, "Key pressed while a mod is held should be unsettled");
+    TEST_ASSERT(achordion_get_counters()->streak_taps == 0, "Streak should not fire after a hold");
+}
+
+// Additional test: Eager mods apply on press and are withdrawn on tap
+void test_eager_mods(void) {
+    printf("\n=== Additional Test: Eager Mods ===\n");
+    
+    reset_mocks();
+    reset_achordion_state();
+    
+    uint16_t shift_s = MT(MOD_LSFT, KC_S);
+    keyrecord_t s_press = create_tap_hold_record(shift_s, true, 4, 2, 100);
+    process_record_achordion(shift_s, &s_press);
+    TEST_ASSERT(mock_mods == 0x02 && mock_mods_reports == 1, "Shift should be applied on press");
+    
+    keyrecord_t s_release = create_tap_hold_record(shift_s, false, 4, 2, 150);
+    process_record_achordion(shift_s, &s_release);
+    TEST_ASSERT(mock_mods == 0, "Shift should be withdrawn when settled as tap");
+    
+    // Right Ctrl is eager too, and kept when settled as hold
+    uint16_t ctrl_i = MT(MOD_RCTL, KC_J);
+    keyrecord_t i_press = create_tap_hold_record(ctrl_i, true, 4, 8, 400);
+    keyrecord_t a_press = create_keyrecord(KC_A, true, 1, 2, 600);
+    process_record_achordion(ctrl_i, &i_press);
+    TEST_ASSERT(mock_mods == 0x10, "Right Ctrl should be applied on press");
+    process_record_achordion(KC_A, &a_press);
+    TEST_ASSERT(mock_mods == 0x10, "Right Ctrl should stay when settled as hold");
+}
+
+// Additional test: GUI and Alt keep the deferred behavior
+void test_deferred_mods(void) {
+    printf("\n=== Additional Test: Deferred Mods ===\n");
+    
+    reset_mocks();
+    reset_achordion_state();
+    
+    uint16_t gui_t = MT(MOD_LGUI, KC_A);
+    uint16_t alt_e = MT(MOD_RALT, KC_J);
+    keyrecord_t t_press = create_tap_hold_record(gui_t, true, 3, 2, 100);
+    keyrecord_t e_press = create_tap_hold_record(alt_e, true, 3, 8, 300);
+    process_record_achordion(gui_t, &t_press);
+    process_record_achordion(alt_e, &e_press);
+    
+    TEST_ASSERT(mock_mods == 0 && mock_mods_reports == 0, "GUI and Alt should not be applied early");
+}
+
+// Additional test: Settle-on-release holds when the other key is released first
+void test_settle_on_release_hold(void) {
+    printf("\n=== Additional Test: Settle On Release - Hold ===\n");
+    
+    reset_mocks();
+    reset_achordion_state();
+    
+    keyrecord_t c_press = create_tap_hold_record(RELEASE_POLICY_KEY, true, 1, 2, 100);
+    keyrecord_t j_press = create_keyrecord(KC_J, true, 0, 8, 300);
+    keyrecord_t j_release = create_keyrecord(KC_J, false, 0, 8, 350);
+    process_record_achordion(RELEASE_POLICY_KEY, &c_press);
+    bool result = process_record_achordion(KC_J, &j_press);
+    housekeeping_task_achordion();
+    
+    TEST_ASSERT(!result, "Other key press should be buffered");
+    TEST_ASSERT(achordion_pending_count_for_testing() == 1, "Key should stay unsettled on press");
+    TEST_ASSERT(mock_record_log_count == 0, "Nothing should be replayed yet");
+    
+    process_record_achordion(KC_J, &j_release);
+    housekeeping_task_achordion();
+    TEST_ASSERT(achordion_pending_count_for_testing() == 0, "Other key release should settle it");
+    TEST_ASSERT(mock_record_log_count == 3 && logged(0, 1, 2, true) && mock_record_log[0].tap.count == 0 &&
+                logged(1, 0, 8, true) && logged(2, 0, 8, false), "Should replay hold, then the other key");
+}
+
+// Additional test: Settle-on-release taps when the tap-hold key is released first
+void test_settle_on_release_tap(void) {
+    printf("\n=== Additional Test: Settle On Release - Tap ===\n");
+    
+    reset_mocks();
+    reset_achordion_state();
+    
+    keyrecord_t c_press = create_tap_hold_record(RELEASE_POLICY_KEY, true, 1, 2, 100);
+    keyrecord_t j_press = create_keyrecord(KC_J, true, 0, 8, 300);
+    keyrecord_t c_release = create_tap_hold_record(RELEASE_POLICY_KEY, false, 1, 2, 320);
+    keyrecord_t j_release = create_keyrecord(KC_J, false, 0, 8, 350);
+    process_record_achordion(RELEASE_POLICY_KEY, &c_press);
+    process_record_achordion(KC_J, &j_press);
+    process_record_achordion(RELEASE_POLICY_KEY, &c_release);
+    housekeeping_task_achordion();
+    
+    TEST_ASSERT(mock_record_log_count == 3 && logged(0, 1, 2, true) && mock_record_log[0].tap.count == 1 &&
+                logged(1, 1, 2, false) && logged(2, 0, 8, true), "Rolled keys should replay as tap, then the other key");
+    TEST_ASSERT(process_record_achordion(KC_J, &j_release), "Other key release should then pass through");
+}
+
+// Additional test: A tap-hold key tapped while a settle-on-release key is
+// pending is the release that decides it
+void test_settle_on_release_by_tapped_tap_hold(void) {
+    printf("\n=== Additional Test: Settle On Release - Tapped Tap-Hold Key ===\n");
+    
+    reset_mocks();
+    reset_achordion_state();
+    
+    uint16_t shift_h = MT(MOD_RSFT, KC_H);
+    keyrecord_t c_press = create_tap_hold_record(RELEASE_POLICY_KEY, true, 1, 2, 100);
+    keyrecord_t h_press = create_tap_hold_record(shift_h, true, 1, 8, 300);
+    keyrecord_t h_release = create_tap_hold_record(shift_h, false, 1, 8, 350);
+    process_record_achordion(RELEASE_POLICY_KEY, &c_press);
+    process_record_achordion(shift_h, &h_press);
+    TEST_ASSERT(achordion_pending_count_for_testing() == 2, "Both keys should be unsettled on press");
+    
+    process_record_achordion(shift_h, &h_release);
+    housekeeping_task_achordion();
+    TEST_ASSERT(achordion_pending_count_for_testing() == 0, "Tapped key's release should settle both");
+    TEST_ASSERT(mock_record_log_count == 3 && logged(0, 1, 2, true) && mock_record_log[0].tap.count == 0 &&
+                logged(1, 1, 8, true) && mock_record_log[1].tap.count == 1 && logged(2, 1, 8, false),
+                "Should replay hold, then the tapped key");
+}
+
+// Additional test: The timeout survives the 16-bit timer wrapping around
+void test_timeout_across_timer_wrap(void) {
+    printf("\n=== Additional Test: Timeout Across Timer Wrap ===\n");
+    
+    reset_mocks();
+    reset_achordion_state();
+    
+    uint16_t keycode = MT(MOD_LCTL, KC_A);
+    mock_timer = 0xFF00;
+    keyrecord_t press_record = create_tap_hold_record(keycode, true, 0, 2, 0xFF00);
+    process_record_achordion(keycode, &press_record);
+    
+    mock_timer = 0xFF00 + 500;  // 16-bit timer has wrapped, timeout not reached
+    deadline_task();
+    housekeeping_task_achordion();
+    TEST_ASSERT(achordion_pending_count_for_testing() == 1, "Should not time out early after wraparound");
+    
+    mock_timer = 0xFF00 + 1001;
+    deadline_task();
+    housekeeping_task_achordion();
+    TEST_ASSERT(achordion_pending_count_for_testing() == 0, "Should time out after wraparound");
+    TEST_ASSERT(mock_record_log_count == 1 && mock_record_log[0].tap.count == 0, "Should settle as hold");
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
 // Test Runner
 // ─────────────────────────────────────────────────────────────────────────────
 
+// Additional test: Thumb keys marked '*' go with either hand
+void test_either_hand_thumbs(void) {
+    printf("\n=== Additional Test: Either-Hand Thumbs ===\n");
+#ifdef CHORDAL_HOLD
+    keyrecord_t left = create_keyrecord(KC_A, true, 1, 2, 100);
+    keyrecord_t right = create_keyrecord(KC_J, true, 1, 8, 100);
+    keyrecord_t left_thumb = create_keyrecord(KC_TAB, true, 0, 5, 100);
+    keyrecord_t right_thumb = create_keyrecord(KC_TAB, true, 6, 11, 100);
+    keyrecord_t combo = create_keyrecord(KC_TAB, true, 255, 255, 100);
+
+    TEST_ASSERT(achordion_opposite_hands(&left, &left_thumb), "Left key should chord with the left thumb");
+    TEST_ASSERT(achordion_opposite_hands(&left_thumb, &left), "Left thumb should chord with a left key");
+    TEST_ASSERT(achordion_opposite_hands(&right, &right_thumb), "Right key should chord with the right thumb");
+    TEST_ASSERT(achordion_opposite_hands(&left, &combo), "Combos should chord with either hand");
+
+    // A left thumb layer-tap held with a left-hand key settles as hold
+    reset_achordion_state_for_testing();
+    uint16_t thumb_keycode = LT(1, KC_TAB);
+    keyrecord_t thumb_press = create_tap_hold_record(thumb_keycode, true, 0, 5, 100);
+    process_record_achordion(thumb_keycode, &thumb_press);
+    keyrecord_t a_press = create_keyrecord(KC_A, true, 1, 2, 150);
+    process_record_achordion(KC_A, &a_press);
+    TEST_ASSERT(achordion_pending_count_for_testing() == 0, "Thumb key should settle on the next press");
+    mock_record_log_count = 0;
+    housekeeping_task_achordion();
+    TEST_ASSERT(mock_record_log_count == 2 && mock_record_log[0].tap.count == 0, "Thumb key should settle as hold");
+#else
+    printf("(skipped: build with -DCHORDAL_HOLD)\n");
+#endif
+}
+
+// Additional test: Same-hand chords listed as exceptions settle as hold
+void test_same_hand_exceptions(void) {
+    printf("\n=== Additional Test: Same-Hand Chord Exceptions ===\n");
+#ifdef CHORD_EXCEPTIONS_ENABLE
+    uint16_t gui_keycode = MT(MOD_LGUI, KC_T);
+    keyrecord_t gui_press = create_tap_hold_record(gui_keycode, true, 3, 2, 100);
+    keyrecord_t c_press = create_keyrecord(KC_C, true, 2, 3, 150);
+    keyrecord_t s_press = create_keyrecord(KC_S, true, 4, 2, 150);
+
+    TEST_ASSERT(achordion_chord(gui_keycode, &gui_press, KC_C, &c_press), "GUI + C should be allowed on the same hand");
+    TEST_ASSERT(!achordion_chord(gui_keycode, &gui_press, KC_S, &s_press), "GUI + S should still settle as tap");
+    TEST_ASSERT(!achordion_chord(KC_C, &c_press, gui_keycode, &gui_press), "Exceptions should not apply in reverse");
+
+    reset_achordion_state_for_testing();
+    mock_mods = 0;
+    process_record_achordion(gui_keycode, &gui_press);
+    process_record_achordion(KC_C, &c_press);
+    mock_record_log_count = 0;
+    housekeeping_task_achordion();
+    TEST_ASSERT(mock_record_log_count == 2 && logged(0, 3, 2, true) && mock_record_log[0].tap.count == 0,
+                "GUI should settle as hold before C");
+#else
+    printf("(skipped: build with -DCHORD_EXCEPTIONS_ENABLE)\n");
+#endif
+}
+
+// Additional test: Decision counters and the settle latency histogram
+void test_decision_counters(void) {
+    printf("\n=== Additional Test: Decision Counters ===\n");
+    reset_achordion_state_for_testing();
+    mock_timer = 1000;
+
+    // Tap: pressed and released 40 ms later
+    uint16_t ctrl_keycode = MT(MOD_LCTL, KC_A);
+    keyrecord_t press = create_tap_hold_record(ctrl_keycode, true, 0, 2, 1000);
+    process_record_achordion(ctrl_keycode, &press);
+    mock_timer = 1040;
+    keyrecord_t release = create_tap_hold_record(ctrl_keycode, false, 0, 2, 1040);
+    process_record_achordion(ctrl_keycode, &release);
+    housekeeping_task_achordion();
+
+    // Same-hand rejection, 0 ms after the press
+    mock_timer = 2000;
+    press = create_tap_hold_record(ctrl_keycode, true, 0, 2, 2000);
+    process_record_achordion(ctrl_keycode, &press);
+    keyrecord_t s_press = create_keyrecord(KC_S, true, 1, 2, 2000);
+    process_record_achordion(KC_S, &s_press);
+    housekeeping_task_achordion();
+    release = create_tap_hold_record(ctrl_keycode, false, 0, 2, 2010);
+    process_record_achordion(ctrl_keycode, &release);
+    keyrecord_t s_release = create_keyrecord(KC_S, false, 1, 2, 2010);
+    process_record_achordion(KC_S, &s_release);
+
+    // Timeout: held past 1000 ms
+    mock_timer = 3000;
+    press = create_tap_hold_record(ctrl_keycode, true, 0, 2, 3000);
+    process_record_achordion(ctrl_keycode, &press);
+    mock_timer = 4000;
+    deadline_task();
+    housekeeping_task_achordion();
+
+    const achordion_counters_t* counters = achordion_get_counters();
+    TEST_ASSERT(counters->taps == 2 && counters->holds == 1, "Should count two taps and one hold");
+    TEST_ASSERT(counters->timeouts == 1, "Should count the timeout");
+    TEST_ASSERT(counters->same_hand == 1, "Should count the same-hand rejection");
+    TEST_ASSERT(counters->latency[0] == 1, "0 ms settle should land in bucket 0");
+    TEST_ASSERT(counters->latency[6] == 1, "40 ms settle should land in bucket 6 [32, 64)");
+    TEST_ASSERT(counters->latency[10] == 1, "1000 ms settle should land in bucket 10 [512, 1024)");
+    TEST_ASSERT(achordion_latency_bucket_for_testing(1) == 1 &&
+                achordion_latency_bucket_for_testing(1023) == 10 &&
+                achordion_latency_bucket_for_testing(1024) == 11,
+                "Buckets should split at powers of 2");
+    TEST_ASSERT(achordion_latency_bucket_for_testing(40000) == ACHORDION_LATENCY_BUCKETS - 1,
+                "Latencies past the last bucket should land in it");
+
+    uint8_t report[ACHORDION_STATS_REPORT_SIZE];
+    achordion_stats_pack(ACHORDION_STATS_PAGE_COUNTERS, report);
+    TEST_ASSERT(report[0] == ACHORDION_STATS_EVENT && report[1] == ACHORDION_STATS_PAGE_COUNTERS,
+                "Report should start with the event id and page");
+    TEST_ASSERT(report[2] == 2 && report[6] == 1 && report[10] == 1 && report[14] == 1,
+                "Counters page should hold taps, holds, timeouts and same-hand rejections");
+    achordion_stats_pack(ACHORDION_STATS_PAGE_LATENCY, report);
+    TEST_ASSERT(report[2] == ACHORDION_LATENCY_BUCKETS && report[3] == 1 && report[3 + 2 * 6] == 1,
+                "Latency page should hold the bucket count and buckets");
+
+    uint8_t request[ACHORDION_STATS_REPORT_SIZE] = {ACHORDION_STATS_EVENT, ACHORDION_STATS_PAGE_COUNTERS};
+    TEST_ASSERT(achordion_stats_receive(request, sizeof(request)) &&
+                request[1] == ACHORDION_STATS_PAGE_COUNTERS && request[2] == 2,
+                "A stats request should be answered in place with its page");
+    uint8_t other[ACHORDION_STATS_REPORT_SIZE] = {0x01, ACHORDION_STATS_PAGE_COUNTERS};
+    TEST_ASSERT(!achordion_stats_receive(other, sizeof(other)) && other[0] == 0x01 && other[2] == 0,
+                "Other reports should be left alone");
+}
+
 void run_all_tests(void) {
     printf("=== Achordion Unit Tests ===\n");
     printf("Testing Achordion implementation for QMK Voyager keymap\n\n");
@@ -302,6 +883,23 @@ void run_all_tests(void) {
     test_chording_condition_tap();
     test_non_tap_hold_passthrough();
     test_layer_tap_behavior();
+    test_rolled_tap_hold_keys();
+    test_tapped_tap_hold_decides_pending();
+    test_stacked_mods_hold();
+    test_stacked_cross_hand_mods();
+    test_pending_table_capacity();
+    test_deferred_replay();
+    test_typing_streak();
+    test_hold_breaks_streak();
+    test_eager_mods();
+    test_deferred_mods();
+    test_settle_on_release_hold();
+    test_settle_on_release_tap();
+    test_settle_on_release_by_tapped_tap_hold();
+    test_timeout_across_timer_wrap();
+    test_either_hand_thumbs();
+    test_same_hand_exceptions();
+    test_decision_counters();
     
     // Print summary
     printf("\n=== Test Summary ===\n");
@@ -0,0 +1,151 @@
+// test_deadline.c — Unit tests for the deadline scheduler
+
+#include "quantum.h"
+#include "deadline.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Test Infrastructure
+// ─────────────────────────────────────────────────────────────────────────────
+
+static int test_count = 0;
+static int test_passed = 0;
+static int test_failed = 0;
+
+#define TEST_ASSERT(condition, message) do { \
+    test_count++; \
+    if (condition) { \
+        test_passed++; \
+        printf("✓ Test %d: %s\n", test_count, message); \
+    } else { \
+        test_failed++; \
+        printf("✗ Test %d: %s\n", test_count, message); \
+    } \
+} while(0)
+
+// Mock 32-bit timer
+static uint32_t mock_timer = 0;
+
+uint16_t timer_read(void) {
+    return (uint16_t)mock_timer;
+}
+
+uint32_t timer_read32(void) {
+    return mock_timer;
+}
+
+// Order in which callbacks ran, by their `arg`
+static int fired[DEADLINE_MAX * 2];
+static int fired_count = 0;
+
+static void record_callback(uint32_t deadline, void* arg) {
+    (void)deadline;
+    fired[fired_count++] = (int)(intptr_t)arg;
+}
+
+static void reset(uint32_t now) {
+    mock_timer = now;
+    fired_count = 0;
+    // Drain anything left over from the previous test
+    mock_timer += 0x7FFFFFFF;
+    deadline_task();
+    mock_timer = now;
+    fired_count = 0;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Test Cases
+// ─────────────────────────────────────────────────────────────────────────────
+
+void test_deadlines_fire_in_order(void) {
+    printf("\n=== Test Case 1: Deadlines Fire In Order ===\n");
+    reset(1000);
+
+    deadline_schedule(1300, record_callback, (void*)3);
+    deadline_schedule(1100, record_callback, (void*)1);
+    deadline_schedule(1200, record_callback, (void*)2);
+    TEST_ASSERT(deadline_pending() && deadline_next() == 1100, "Next deadline should be the earliest");
+
+    mock_timer = 1099;
+    deadline_task();
+    TEST_ASSERT(fired_count == 0, "Nothing should fire before its deadline");
+
+    mock_timer = 1250;
+    deadline_task();
+    TEST_ASSERT(fired_count == 2 && fired[0] == 1 && fired[1] == 2, "Due deadlines should fire, earliest first");
+
+    mock_timer = 1300;
+    deadline_task();
+    TEST_ASSERT(fired_count == 3 && fired[2] == 3 && !deadline_pending(), "Last deadline should fire on time");
+}
+
+void test_cancel(void) {
+    printf("\n=== Test Case 2: Cancel ===\n");
+    reset(0);
+
+    deadline_token_t a = deadline_schedule(100, record_callback, (void*)1);
+    deadline_token_t b = deadline_schedule(200, record_callback, (void*)2);
+    TEST_ASSERT(a != DEADLINE_INVALID && b != DEADLINE_INVALID && a != b, "Tokens should be valid and distinct");
+    TEST_ASSERT(deadline_cancel(a), "Cancelling a scheduled deadline should succeed");
+    TEST_ASSERT(!deadline_cancel(a), "Cancelling twice should fail");
+    TEST_ASSERT(deadline_next() == 200, "Next deadline should move on");
+
+    mock_timer = 300;
+    deadline_task();
+    TEST_ASSERT(fired_count == 1 && fired[0] == 2, "Only the remaining deadline should fire");
+    TEST_ASSERT(!deadline_cancel(b), "Cancelling a fired deadline should fail");
+}
+
+void test_capacity(void) {
+    printf("\n=== Test Case 3: Capacity ===\n");
+    reset(0);
+
+    int i;
+    for (i = 0; i < DEADLINE_MAX; ++i) {
+        deadline_schedule(10 + i, record_callback, (void*)(intptr_t)i);
+    }
+    TEST_ASSERT(deadline_schedule(5, record_callback, NULL) == DEADLINE_INVALID, "Full scheduler should refuse");
+
+    mock_timer = 10 + DEADLINE_MAX;
+    deadline_task();
+    TEST_ASSERT(fired_count == DEADLINE_MAX, "All deadlines should fire");
+}
+
+void test_wraparound(void) {
+    printf("\n=== Test Case 4: 32-bit Wraparound ===\n");
+    reset(0xFFFFFF00);
+
+    deadline_schedule_in(0x200, record_callback, (void*)2);
+    deadline_schedule_in(0x80, record_callback, (void*)1);
+    TEST_ASSERT(deadline_next() == 0xFFFFFF80, "Earliest deadline should be before the wrap");
+
+    mock_timer = 0x50;  // Timer wrapped
+    deadline_task();
+    TEST_ASSERT(fired_count == 1 && fired[0] == 1, "Deadline before the wrap should fire");
+
+    mock_timer = 0x100;
+    deadline_task();
+    TEST_ASSERT(fired_count == 2 && fired[1] == 2, "Deadline after the wrap should fire");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Test Runner
+// ─────────────────────────────────────────────────────────────────────────────
+
+int main(void) {
+    printf("=== Deadline Scheduler Unit Tests ===\n");
+
+    test_deadlines_fire_in_order();
+    test_cancel();
+    test_capacity();
+    test_wraparound();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Total tests: %d\n", test_count);
+    printf("Passed: %d\n", test_passed);
+    printf("Failed: %d\n", test_failed);
+
+    return test_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+// test_key_capture.c — Unit tests for keystroke capture
+
+#include "quantum.h"
+#include "key_capture.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Test Infrastructure
+// ─────────────────────────────────────────────────────────────────────────────
+
+static int test_count = 0;
+static int test_passed = 0;
+static int test_failed = 0;
+
+#define TEST_ASSERT(condition, message) do { \
+    test_count++; \
+    if (condition) { \
+        test_passed++; \
+        printf("✓ Test %d: %s\n", test_count, message); \
+    } else { \
+        test_failed++; \
+        printf("✗ Test %d: %s\n", test_count, message); \
+    } \
+} while(0)
+
+// Mock raw HID: keeps the last report
+static uint8_t sent[KEY_CAPTURE_REPORT_SIZE];
+static int sent_count = 0;
+
+void raw_hid_send(uint8_t* data, uint8_t length) {
+    memcpy(sent, data, length);
+    sent_count++;
+}
+
+static void press(uint8_t row, uint8_t col, bool pressed, uint16_t time, uint16_t keycode) {
+    keyrecord_t record = {
+        .event = {
+            .key = {.row = row, .col = col},
+            .time = time,
+            .type = KEY_EVENT,
+            .pressed = pressed,
+        },
+    };
+    key_capture_record(keycode, &record);
+}
+
+static bool command(uint8_t command) {
+    uint8_t request[KEY_CAPTURE_REPORT_SIZE] = {KEY_CAPTURE_EVENT, command};
+    return key_capture_receive(request, sizeof(request));
+}
+
+static void reset(void) {
+    uint8_t report[KEY_CAPTURE_REPORT_SIZE];
+    rawhid_state.paired = true;
+    command(KEY_CAPTURE_START);
+    while (key_capture_pack(report) > 0) {
+    }
+    key_capture_pack(report);  // Clears the dropped count
+    sent_count = 0;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Test Cases
+// ─────────────────────────────────────────────────────────────────────────────
+
+void test_only_while_started_and_paired(void) {
+    printf("\n=== Test Case 1: Only While Started and Paired ===\n");
+
+    rawhid_state.paired = true;
+    press(2, 1, true, 100, KC_A);
+    TEST_ASSERT(key_capture_pending() == 0, "Nothing should be recorded until the host starts capture");
+
+    reset();
+    rawhid_state.paired = false;
+    press(2, 1, true, 100, KC_A);
+    TEST_ASSERT(key_capture_pending() == 0, "Nothing should be recorded while unpaired");
+
+    rawhid_state.paired = true;
+    press(2, 1, true, 100, KC_A);
+    TEST_ASSERT(key_capture_pending() == 1, "Events should be recorded once started and paired");
+
+    TEST_ASSERT(command(KEY_CAPTURE_STOP), "Stop should be taken as a capture request");
+    press(2, 1, false, 150, KC_A);
+    TEST_ASSERT(key_capture_pending() == 1, "Nothing should be recorded after a stop");
+    key_capture_task();
+    TEST_ASSERT(sent_count == 1 && sent[1] == 1, "Events buffered before a stop should still be sent");
+
+    command(KEY_CAPTURE_START);
+    press(2, 1, true, 200, KC_A);
+    rawhid_state.paired = false;
+    key_capture_task();
+    TEST_ASSERT(sent_count == 1 && key_capture_pending() == 0, "Unpairing should discard the buffer unsent");
+    rawhid_state.paired = true;
+    press(2, 1, false, 250, KC_A);
+    TEST_ASSERT(key_capture_pending() == 0, "Unpairing should stop capture until the host starts it again");
+
+    uint8_t other[KEY_CAPTURE_REPORT_SIZE] = {0xAC, KEY_CAPTURE_START};
+    TEST_ASSERT(!key_capture_receive(other, sizeof(other)), "Other reports should be left alone");
+}
+
+void test_report_layout(void) {
+    printf("\n=== Test Case 2: Report Layout ===\n");
+    reset();
+
+    press(8, 3, true, 0x1234, MT(MOD_LSFT, KC_A));
+    press(8, 3, false, 0x1290, MT(MOD_LSFT, KC_A));
+    key_capture_task();
+    TEST_ASSERT(sent_count == 1, "One report should be sent");
+    TEST_ASSERT(sent[0] == KEY_CAPTURE_EVENT && sent[1] == 2 && sent[2] == 0, "Header should hold the id, count and no drops");
+    TEST_ASSERT(sent[3] == 0x34 && sent[4] == 0x12, "Time should be little-endian");
+    TEST_ASSERT(sent[5] == (MT(MOD_LSFT, KC_A) & 0xFF) && sent[6] == MT(MOD_LSFT, KC_A) >> 8, "Keycode should be little-endian");
+    TEST_ASSERT(sent[7] == (8 << 4 | 3 << 1 | 1), "Position and press should share a byte");
+    TEST_ASSERT(sent[12] == (8 << 4 | 3 << 1), "Release should follow");
+
+    key_capture_task();
+    TEST_ASSERT(sent_count == 1, "Nothing should be sent with an empty buffer");
+}
+
+void test_one_report_per_task(void) {
+    printf("\n=== Test Case 3: One Report Per Task ===\n");
+    reset();
+
+    for (int i = 0; i < KEY_CAPTURE_PER_REPORT + 2; ++i) {
+        press(1, 1, i % 2 == 0, i * 10, KC_B);
+    }
+    key_capture_task();
+    TEST_ASSERT(sent_count == 1 && sent[1] == KEY_CAPTURE_PER_REPORT, "First report should be full");
+    key_capture_task();
+    TEST_ASSERT(sent_count == 2 && sent[1] == 2, "Second report should hold the rest");
+    TEST_ASSERT(sent[3] == KEY_CAPTURE_PER_REPORT * 10, "Events should come out in order");
+}
+
+void test_overflow(void) {
+    printf("\n=== Test Case 4: Overflow ===\n");
+    reset();
+
+    for (int i = 0; i < KEY_CAPTURE_BUFFER + 3; ++i) {
+        press(1, 1, true, i, KC_C);
+    }
+    TEST_ASSERT(key_capture_pending() == KEY_CAPTURE_BUFFER, "Buffer should hold its capacity");
+    key_capture_task();
+    TEST_ASSERT(sent[2] == 3, "First report should count the dropped events");
+    TEST_ASSERT(sent[3] == 0, "Oldest events should be kept");
+    key_capture_task();
+    TEST_ASSERT(sent[2] == 0, "Dropped count should reset once reported");
+}
+
+void test_non_matrix_events(void) {
+    printf("\n=== Test Case 5: Non-Matrix Events ===\n");
+    reset();
+
+    keyrecord_t combo = {.event = {.key = {.row = 254, .col = 0}, .type = COMBO_EVENT, .pressed = true}};
+    key_capture_record(KC_ESCAPE, &combo);
+    press(MATRIX_ROWS, 0, true, 0, KC_A);
+    TEST_ASSERT(key_capture_pending() == 0, "Combos and out-of-matrix keys should be skipped");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Test Runner
+// ─────────────────────────────────────────────────────────────────────────────
+
+int main(void) {
+    printf("=== Keystroke Capture Unit Tests ===\n");
+
+    test_only_while_started_and_paired();
+    test_report_layout();
+    test_one_report_per_task();
+    test_overflow();
+    test_non_matrix_events();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Total tests: %d\n", test_count);
+    printf("Passed: %d\n", test_passed);
+    printf("Failed: %d\n", test_failed);
+
+    return test_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+// deadline.h — One deadline scheduler for every timed feature in the keymap
+//
+// Achordion, tap dance and macros register their deadlines here instead of
+// polling their own timers. Deadlines are kept in a small min-heap on the
+// 32-bit timer, so the main loop only pays for one comparison against the
+// earliest deadline, and wraparound is handled by signed differences.
+
+#pragma once
+
+#include "quantum.h"
+
+// Maximum number of deadlines scheduled at the same time.
+#ifndef DEADLINE_MAX
+#define DEADLINE_MAX 10
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Identifies a scheduled deadline. 0 is never a valid token.
+typedef uint8_t deadline_token_t;
+#define DEADLINE_INVALID 0
+
+// Called from deadline_task() once `deadline` has passed.
+typedef void (*deadline_callback_t)(uint32_t deadline, void* arg);
+
+// Schedules `callback` to run at `deadline` (timer_read32() time). Returns
+// DEADLINE_INVALID if the scheduler is full.
+deadline_token_t deadline_schedule(uint32_t deadline, deadline_callback_t callback,
+                                   void* arg);
+
+// Schedules `callback` to run `delay_ms` from now.
+deadline_token_t deadline_schedule_in(uint32_t delay_ms, deadline_callback_t callback,
+                                      void* arg);
+
+// Cancels a scheduled deadline. Returns false if it already ran.
+bool deadline_cancel(deadline_token_t token);
+
+// Returns true if `a` is earlier than `b`, across timer wraparound.
+static inline bool deadline_before(uint32_t a, uint32_t b) {
+  return (int32_t)(a - b) < 0;
+}
+
+// Earliest scheduled deadline. Only meaningful if deadline_pending().
+uint32_t deadline_next(void);
+
+bool deadline_pending(void);
+
+// Main loop hook: runs the callbacks of every deadline that has passed.
+void deadline_task(void);
+
+#ifdef __cplusplus
+}
+#endif
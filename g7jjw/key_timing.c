@@ -0,0 +1,66 @@
+// key_timing.c — Per-key timing tables
+//
+// Generated by tools/gen_key_timing.py from key_timing.json and keymap.c.
+// Do not edit.
+
+#include "key_timing.h"
+
+const key_timing_t key_timing_profiles[] PROGMEM = {
+  // 0: defaults
+  {.tapping_term = TAPPING_TERM},
+  // 1: LT(1,KC_SPACE)
+  {.tapping_term = TAPPING_TERM - 10},
+};
+
+// Profile of every key, KEY_TIMING_TRANSPARENT (255) where it is transparent
+const uint8_t key_timing_map[KEY_TIMING_LAYERS][MATRIX_ROWS][MATRIX_COLS] PROGMEM = {
+  [0] = LAYOUT_voyager(
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   1,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0
+  ),
+  [1] = LAYOUT_voyager(
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    255, 255, 255, 0
+  ),
+  [2] = LAYOUT_voyager(
+    255, 0,   0,   0,   0,   0,   0,   0,   0,   0,   255, 255,
+    255, 0,   0,   0,   0,   0,   0,   0,   0,   0,   255, 255,
+    255, 0,   0,   0,   0,   0,   0,   0,   0,   0,   255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255
+  ),
+  [3] = LAYOUT_voyager(
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    0,   255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255
+  ),
+  [4] = LAYOUT_voyager(
+    255, 255, 255, 255, 255, 255, 255, 255, 0,   255, 255, 255,
+    255, 255, 255, 0,   255, 255, 255, 0,   0,   0,   255, 255,
+    255, 255, 255, 0,   255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255
+  ),
+  [5] = LAYOUT_voyager(
+    255, 255, 255, 255, 0,   255, 255, 0,   0,   0,   255, 255,
+    255, 255, 0,   0,   0,   255, 255, 0,   0,   0,   255, 255,
+    255, 255, 255, 255, 255, 0,   0,   255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255
+  ),
+  [6] = LAYOUT_voyager(
+    255, 255, 255, 255, 255, 255, 255, 0,   0,   0,   0,   255,
+    255, 255, 255, 255, 255, 255, 255, 0,   0,   0,   0,   255,
+    255, 255, 255, 255, 255, 255, 255, 0,   0,   0,   0,   255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255
+  ),
+};
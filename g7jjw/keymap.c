@@ -1,5 +1,9 @@
 #include QMK_KEYBOARD_H
 #include "version.h"
+#include "key_timing.h"
+#include "led_frames.h"
+#include "deadline.h"
+#include "send_string_deferred.h"
 #define MOON_LED_LEVEL LED_LEVEL
 #define ML_SAFE_RANGE SAFE_RANGE
 
@@ -82,12 +86,8 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
 
 
 uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record) {
-    switch (keycode) {
-        case LT(1,KC_SPACE):
-            return TAPPING_TERM -10;
-        default:
-            return TAPPING_TERM;
-    }
+    (void)keycode;
+    return key_timing_tapping_term(record->event);
 }
 
 extern rgb_config_t rgb_matrix_config;
@@ -96,6 +96,10 @@ void keyboard_post_init_user(void) {
   rgb_matrix_enable();
 }
 
+void housekeeping_task_user(void) {
+  deadline_task();
+}
+
 const uint8_t PROGMEM ledmap[][RGB_MATRIX_LED_COUNT][3] = {
     [0] = { {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {87,255,255}, {87,255,255}, {87,255,255}, {87,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {87,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {87,255,255}, {87,255,255}, {87,255,255}, {87,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {87,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255} },
 
@@ -112,51 +116,28 @@ const uint8_t PROGMEM ledmap[][RGB_MATRIX_LED_COUNT][3] = {
 };
 
 void set_layer_color(int layer) {
+  const RGB* frame = led_frames_get(layer);
   for (int i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
-    HSV hsv = {
-      .h = pgm_read_byte(&ledmap[layer][i][0]),
-      .s = pgm_read_byte(&ledmap[layer][i][1]),
-      .v = pgm_read_byte(&ledmap[layer][i][2]),
-    };
-    if (!hsv.h && !hsv.s && !hsv.v) {
-        rgb_matrix_set_color( i, 0, 0, 0 );
-    } else {
-        RGB rgb = hsv_to_rgb( hsv );
-        float f = (float)rgb_matrix_config.hsv.v / UINT8_MAX;
-        rgb_matrix_set_color( i, f * rgb.r, f * rgb.g, f * rgb.b );
-    }
+    rgb_matrix_set_color(i, frame[i].r, frame[i].g, frame[i].b);
   }
 }
 
+layer_state_t layer_state_set_user(layer_state_t state) {
+  led_frames_invalidate();
+  return state;
+}
+
+layer_state_t default_layer_state_set_user(layer_state_t state) {
+  led_frames_invalidate();
+  return state;
+}
+
 bool rgb_matrix_indicators_user(void) {
   if (rawhid_state.rgb_control) {
       return false;
   }
   if (keyboard_config.disable_layer_led) { return false; }
-  switch (biton32(layer_state)) {
-    case 0:
-      set_layer_color(0);
-      break;
-    case 1:
-      set_layer_color(1);
-      break;
-    case 2:
-      set_layer_color(2);
-      break;
-    case 4:
-      set_layer_color(4);
-      break;
-    case 5:
-      set_layer_color(5);
-      break;
-    case 6:
-      set_layer_color(6);
-      break;
-   default:
-    if (rgb_matrix_get_flags() == LED_FLAG_NONE)
-      rgb_matrix_set_color_all(0, 0, 0);
-    break;
-  }
+  led_frames_indicators();
   return true;
 }
 
@@ -164,32 +145,32 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
   switch (keycode) {
     case ST_MACRO_0:
     if (record->event.pressed) {
-      SEND_STRING(SS_LCTL(SS_TAP(X_W)) SS_DELAY(100) SS_TAP(X_S));
+      SEND_STRING_DEFERRED(SS_LCTL(SS_TAP(X_W)) SS_DELAY(100) SS_TAP(X_S));
     }
     break;
     case ST_MACRO_1:
     if (record->event.pressed) {
-      SEND_STRING(SS_LCTL(SS_TAP(X_W)) SS_DELAY(100) SS_TAP(X_V));
+      SEND_STRING_DEFERRED(SS_LCTL(SS_TAP(X_W)) SS_DELAY(100) SS_TAP(X_V));
     }
     break;
     case ST_MACRO_2:
     if (record->event.pressed) {
-      SEND_STRING(SS_LCTL(SS_TAP(X_W)) SS_DELAY(100) SS_TAP(X_UP));
+      SEND_STRING_DEFERRED(SS_LCTL(SS_TAP(X_W)) SS_DELAY(100) SS_TAP(X_UP));
     }
     break;
     case ST_MACRO_3:
     if (record->event.pressed) {
-      SEND_STRING(SS_LCTL(SS_TAP(X_W)) SS_DELAY(100) SS_TAP(X_DOWN));
+      SEND_STRING_DEFERRED(SS_LCTL(SS_TAP(X_W)) SS_DELAY(100) SS_TAP(X_DOWN));
     }
     break;
     case ST_MACRO_4:
     if (record->event.pressed) {
-      SEND_STRING(SS_LCTL(SS_TAP(X_W)) SS_DELAY(100) SS_TAP(X_RIGHT));
+      SEND_STRING_DEFERRED(SS_LCTL(SS_TAP(X_W)) SS_DELAY(100) SS_TAP(X_RIGHT));
     }
     break;
     case ST_MACRO_5:
     if (record->event.pressed) {
-      SEND_STRING(SS_LSFT(SS_TAP(X_QUOTE)) SS_DELAY(100) SS_TAP(X_0) SS_DELAY(100) SS_TAP(X_P));
+      SEND_STRING_DEFERRED(SS_LSFT(SS_TAP(X_QUOTE)) SS_DELAY(100) SS_TAP(X_0) SS_DELAY(100) SS_TAP(X_P));
     }
     break;
 
@@ -219,6 +200,19 @@ enum {
 
 static tap dance_state[10];
 
+static void unregister_code16_deadline(uint32_t deadline, void *arg) {
+    (void)deadline;
+    unregister_code16((uint16_t)(uintptr_t)arg);
+}
+
+// Releases `keycode` 10 ms from now without blocking the matrix scan.
+static void unregister_code16_later(uint16_t keycode) {
+    if (deadline_schedule_in(10, unregister_code16_deadline, (void *)(uintptr_t)keycode) == DEADLINE_INVALID) {
+        wait_ms(10);
+        unregister_code16(keycode);
+    }
+}
+
 uint8_t dance_step(tap_dance_state_t *state);
 
 uint8_t dance_step(tap_dance_state_t *state) {
@@ -239,6 +233,7 @@ void dance_0_finished(tap_dance_state_t *state, void *user_data);
 void dance_0_reset(tap_dance_state_t *state, void *user_data);
 
 void on_dance_0(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     if(state->count == 3) {
         tap_code16(LCTL(KC_C));
         tap_code16(LCTL(KC_C));
@@ -250,6 +245,7 @@ void on_dance_0(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_0_finished(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     dance_state[0].step = dance_step(state);
     switch (dance_state[0].step) {
         case SINGLE_TAP: register_code16(LCTL(KC_C)); break;
@@ -259,11 +255,12 @@ void dance_0_finished(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_0_reset(tap_dance_state_t *state, void *user_data) {
-    wait_ms(10);
+    (void)state;
+    (void)user_data;
     switch (dance_state[0].step) {
-        case SINGLE_TAP: unregister_code16(LCTL(KC_C)); break;
-        case DOUBLE_TAP: unregister_code16(LALT(LCTL(LSFT(KC_C)))); break;
-        case DOUBLE_SINGLE_TAP: unregister_code16(LCTL(KC_C)); break;
+        case SINGLE_TAP: unregister_code16_later(LCTL(KC_C)); break;
+        case DOUBLE_TAP: unregister_code16_later(LALT(LCTL(LSFT(KC_C)))); break;
+        case DOUBLE_SINGLE_TAP: unregister_code16_later(LCTL(KC_C)); break;
     }
     dance_state[0].step = 0;
 }
@@ -272,6 +269,7 @@ void dance_1_finished(tap_dance_state_t *state, void *user_data);
 void dance_1_reset(tap_dance_state_t *state, void *user_data);
 
 void on_dance_1(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     if(state->count == 3) {
         tap_code16(LCTL(KC_V));
         tap_code16(LCTL(KC_V));
@@ -283,6 +281,7 @@ void on_dance_1(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_1_finished(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     dance_state[1].step = dance_step(state);
     switch (dance_state[1].step) {
         case SINGLE_TAP: register_code16(LCTL(KC_V)); break;
@@ -292,11 +291,12 @@ void dance_1_finished(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_1_reset(tap_dance_state_t *state, void *user_data) {
-    wait_ms(10);
+    (void)state;
+    (void)user_data;
     switch (dance_state[1].step) {
-        case SINGLE_TAP: unregister_code16(LCTL(KC_V)); break;
-        case DOUBLE_TAP: unregister_code16(LCTL(LSFT(KC_V))); break;
-        case DOUBLE_SINGLE_TAP: unregister_code16(LCTL(KC_V)); break;
+        case SINGLE_TAP: unregister_code16_later(LCTL(KC_V)); break;
+        case DOUBLE_TAP: unregister_code16_later(LCTL(LSFT(KC_V))); break;
+        case DOUBLE_SINGLE_TAP: unregister_code16_later(LCTL(KC_V)); break;
     }
     dance_state[1].step = 0;
 }
@@ -305,6 +305,7 @@ void dance_2_finished(tap_dance_state_t *state, void *user_data);
 void dance_2_reset(tap_dance_state_t *state, void *user_data);
 
 void on_dance_2(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     if(state->count == 3) {
         tap_code16(LCTL(KC_F));
         tap_code16(LCTL(KC_F));
@@ -316,6 +317,7 @@ void on_dance_2(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_2_finished(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     dance_state[2].step = dance_step(state);
     switch (dance_state[2].step) {
         case SINGLE_TAP: register_code16(LCTL(KC_F)); break;
@@ -325,11 +327,12 @@ void dance_2_finished(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_2_reset(tap_dance_state_t *state, void *user_data) {
-    wait_ms(10);
+    (void)state;
+    (void)user_data;
     switch (dance_state[2].step) {
-        case SINGLE_TAP: unregister_code16(LCTL(KC_F)); break;
-        case DOUBLE_TAP: unregister_code16(LCTL(LSFT(KC_F))); break;
-        case DOUBLE_SINGLE_TAP: unregister_code16(LCTL(KC_F)); break;
+        case SINGLE_TAP: unregister_code16_later(LCTL(KC_F)); break;
+        case DOUBLE_TAP: unregister_code16_later(LCTL(LSFT(KC_F))); break;
+        case DOUBLE_SINGLE_TAP: unregister_code16_later(LCTL(KC_F)); break;
     }
     dance_state[2].step = 0;
 }
@@ -338,6 +341,7 @@ void dance_3_finished(tap_dance_state_t *state, void *user_data);
 void dance_3_reset(tap_dance_state_t *state, void *user_data);
 
 void on_dance_3(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     if(state->count == 3) {
         tap_code16(KC_DLR);
         tap_code16(KC_DLR);
@@ -349,6 +353,7 @@ void on_dance_3(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_3_finished(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     dance_state[3].step = dance_step(state);
     switch (dance_state[3].step) {
         case SINGLE_TAP: register_code16(KC_DLR); break;
@@ -359,12 +364,13 @@ void dance_3_finished(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_3_reset(tap_dance_state_t *state, void *user_data) {
-    wait_ms(10);
+    (void)state;
+    (void)user_data;
     switch (dance_state[3].step) {
-        case SINGLE_TAP: unregister_code16(KC_DLR); break;
-        case SINGLE_HOLD: unregister_code16(KC_LEFT_GUI); break;
-        case DOUBLE_TAP: unregister_code16(KC_DLR); break;
-        case DOUBLE_SINGLE_TAP: unregister_code16(KC_DLR); break;
+        case SINGLE_TAP: unregister_code16_later(KC_DLR); break;
+        case SINGLE_HOLD: unregister_code16_later(KC_LEFT_GUI); break;
+        case DOUBLE_TAP: unregister_code16_later(KC_DLR); break;
+        case DOUBLE_SINGLE_TAP: unregister_code16_later(KC_DLR); break;
     }
     dance_state[3].step = 0;
 }
@@ -373,6 +379,7 @@ void dance_4_finished(tap_dance_state_t *state, void *user_data);
 void dance_4_reset(tap_dance_state_t *state, void *user_data);
 
 void on_dance_4(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     if(state->count == 3) {
         tap_code16(KC_LPRN);
         tap_code16(KC_LPRN);
@@ -384,6 +391,7 @@ void on_dance_4(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_4_finished(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     dance_state[4].step = dance_step(state);
     switch (dance_state[4].step) {
         case SINGLE_TAP: register_code16(KC_LPRN); break;
@@ -394,12 +402,13 @@ void dance_4_finished(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_4_reset(tap_dance_state_t *state, void *user_data) {
-    wait_ms(10);
+    (void)state;
+    (void)user_data;
     switch (dance_state[4].step) {
-        case SINGLE_TAP: unregister_code16(KC_LPRN); break;
-        case SINGLE_HOLD: unregister_code16(KC_LEFT_CTRL); break;
-        case DOUBLE_TAP: unregister_code16(KC_LPRN); break;
-        case DOUBLE_SINGLE_TAP: unregister_code16(KC_LPRN); break;
+        case SINGLE_TAP: unregister_code16_later(KC_LPRN); break;
+        case SINGLE_HOLD: unregister_code16_later(KC_LEFT_CTRL); break;
+        case DOUBLE_TAP: unregister_code16_later(KC_LPRN); break;
+        case DOUBLE_SINGLE_TAP: unregister_code16_later(KC_LPRN); break;
     }
     dance_state[4].step = 0;
 }
@@ -408,6 +417,7 @@ void dance_5_finished(tap_dance_state_t *state, void *user_data);
 void dance_5_reset(tap_dance_state_t *state, void *user_data);
 
 void on_dance_5(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     if(state->count == 3) {
         tap_code16(KC_LCBR);
         tap_code16(KC_LCBR);
@@ -419,6 +429,7 @@ void on_dance_5(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_5_finished(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     dance_state[5].step = dance_step(state);
     switch (dance_state[5].step) {
         case SINGLE_TAP: register_code16(KC_LCBR); break;
@@ -429,12 +440,13 @@ void dance_5_finished(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_5_reset(tap_dance_state_t *state, void *user_data) {
-    wait_ms(10);
+    (void)state;
+    (void)user_data;
     switch (dance_state[5].step) {
-        case SINGLE_TAP: unregister_code16(KC_LCBR); break;
-        case SINGLE_HOLD: unregister_code16(KC_LEFT_SHIFT); break;
-        case DOUBLE_TAP: unregister_code16(KC_LCBR); break;
-        case DOUBLE_SINGLE_TAP: unregister_code16(KC_LCBR); break;
+        case SINGLE_TAP: unregister_code16_later(KC_LCBR); break;
+        case SINGLE_HOLD: unregister_code16_later(KC_LEFT_SHIFT); break;
+        case DOUBLE_TAP: unregister_code16_later(KC_LCBR); break;
+        case DOUBLE_SINGLE_TAP: unregister_code16_later(KC_LCBR); break;
     }
     dance_state[5].step = 0;
 }
@@ -443,6 +455,7 @@ void dance_6_finished(tap_dance_state_t *state, void *user_data);
 void dance_6_reset(tap_dance_state_t *state, void *user_data);
 
 void on_dance_6(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     if(state->count == 3) {
         tap_code16(KC_COLN);
         tap_code16(KC_COLN);
@@ -454,6 +467,7 @@ void on_dance_6(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_6_finished(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     dance_state[6].step = dance_step(state);
     switch (dance_state[6].step) {
         case SINGLE_TAP: register_code16(KC_COLN); break;
@@ -464,12 +478,13 @@ void dance_6_finished(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_6_reset(tap_dance_state_t *state, void *user_data) {
-    wait_ms(10);
+    (void)state;
+    (void)user_data;
     switch (dance_state[6].step) {
-        case SINGLE_TAP: unregister_code16(KC_COLN); break;
-        case SINGLE_HOLD: unregister_code16(KC_RIGHT_CTRL); break;
-        case DOUBLE_TAP: unregister_code16(KC_COLN); break;
-        case DOUBLE_SINGLE_TAP: unregister_code16(KC_COLN); break;
+        case SINGLE_TAP: unregister_code16_later(KC_COLN); break;
+        case SINGLE_HOLD: unregister_code16_later(KC_RIGHT_CTRL); break;
+        case DOUBLE_TAP: unregister_code16_later(KC_COLN); break;
+        case DOUBLE_SINGLE_TAP: unregister_code16_later(KC_COLN); break;
     }
     dance_state[6].step = 0;
 }
@@ -478,6 +493,7 @@ void dance_7_finished(tap_dance_state_t *state, void *user_data);
 void dance_7_reset(tap_dance_state_t *state, void *user_data);
 
 void on_dance_7(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     if(state->count == 3) {
         tap_code16(KC_QUOTE);
         tap_code16(KC_QUOTE);
@@ -489,6 +505,7 @@ void on_dance_7(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_7_finished(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     dance_state[7].step = dance_step(state);
     switch (dance_state[7].step) {
         case SINGLE_TAP: register_code16(KC_QUOTE); break;
@@ -499,12 +516,13 @@ void dance_7_finished(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_7_reset(tap_dance_state_t *state, void *user_data) {
-    wait_ms(10);
+    (void)state;
+    (void)user_data;
     switch (dance_state[7].step) {
-        case SINGLE_TAP: unregister_code16(KC_QUOTE); break;
-        case SINGLE_HOLD: unregister_code16(KC_GRAVE); break;
-        case DOUBLE_TAP: unregister_code16(KC_QUOTE); break;
-        case DOUBLE_SINGLE_TAP: unregister_code16(KC_QUOTE); break;
+        case SINGLE_TAP: unregister_code16_later(KC_QUOTE); break;
+        case SINGLE_HOLD: unregister_code16_later(KC_GRAVE); break;
+        case DOUBLE_TAP: unregister_code16_later(KC_QUOTE); break;
+        case DOUBLE_SINGLE_TAP: unregister_code16_later(KC_QUOTE); break;
     }
     dance_state[7].step = 0;
 }
@@ -513,6 +531,7 @@ void dance_8_finished(tap_dance_state_t *state, void *user_data);
 void dance_8_reset(tap_dance_state_t *state, void *user_data);
 
 void on_dance_8(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     if(state->count == 3) {
         tap_code16(KC_QUES);
         tap_code16(KC_QUES);
@@ -524,6 +543,7 @@ void on_dance_8(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_8_finished(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     dance_state[8].step = dance_step(state);
     switch (dance_state[8].step) {
         case SINGLE_TAP: register_code16(KC_QUES); break;
@@ -534,12 +554,13 @@ void dance_8_finished(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_8_reset(tap_dance_state_t *state, void *user_data) {
-    wait_ms(10);
+    (void)state;
+    (void)user_data;
     switch (dance_state[8].step) {
-        case SINGLE_TAP: unregister_code16(KC_QUES); break;
-        case SINGLE_HOLD: unregister_code16(KC_RIGHT_GUI); break;
-        case DOUBLE_TAP: unregister_code16(KC_QUES); break;
-        case DOUBLE_SINGLE_TAP: unregister_code16(KC_QUES); break;
+        case SINGLE_TAP: unregister_code16_later(KC_QUES); break;
+        case SINGLE_HOLD: unregister_code16_later(KC_RIGHT_GUI); break;
+        case DOUBLE_TAP: unregister_code16_later(KC_QUES); break;
+        case DOUBLE_SINGLE_TAP: unregister_code16_later(KC_QUES); break;
     }
     dance_state[8].step = 0;
 }
@@ -548,6 +569,7 @@ void dance_9_finished(tap_dance_state_t *state, void *user_data);
 void dance_9_reset(tap_dance_state_t *state, void *user_data);
 
 void on_dance_9(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     if(state->count == 3) {
         tap_code16(LCTL(KC_TAB));
         tap_code16(LCTL(KC_TAB));
@@ -559,6 +581,7 @@ void on_dance_9(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_9_finished(tap_dance_state_t *state, void *user_data) {
+    (void)user_data;
     dance_state[9].step = dance_step(state);
     switch (dance_state[9].step) {
         case SINGLE_TAP: register_code16(LCTL(KC_TAB)); break;
@@ -569,12 +592,13 @@ void dance_9_finished(tap_dance_state_t *state, void *user_data) {
 }
 
 void dance_9_reset(tap_dance_state_t *state, void *user_data) {
-    wait_ms(10);
+    (void)state;
+    (void)user_data;
     switch (dance_state[9].step) {
-        case SINGLE_TAP: unregister_code16(LCTL(KC_TAB)); break;
-        case SINGLE_HOLD: unregister_code16(KC_LEFT_CTRL); break;
-        case DOUBLE_TAP: unregister_code16(LCTL(KC_TAB)); break;
-        case DOUBLE_SINGLE_TAP: unregister_code16(LCTL(KC_TAB)); break;
+        case SINGLE_TAP: unregister_code16_later(LCTL(KC_TAB)); break;
+        case SINGLE_HOLD: unregister_code16_later(KC_LEFT_CTRL); break;
+        case DOUBLE_TAP: unregister_code16_later(LCTL(KC_TAB)); break;
+        case DOUBLE_SINGLE_TAP: unregister_code16_later(LCTL(KC_TAB)); break;
     }
     dance_state[9].step = 0;
 }
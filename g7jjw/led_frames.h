@@ -0,0 +1,57 @@
+// led_frames.h — RGB frames of the layer LEDs
+//
+// Generated by tools/gen_led_frames.py from the ledmap in keymap.c or
+// ledmap.json.
+// Do not edit: change the ledmap and run
+//   python3 tools/gen_led_frames.py g7jjw
+
+#pragma once
+
+#include "quantum.h"
+
+#define LED_FRAMES_LAYERS 7
+// Layers the ledmap has a frame for, one bit each
+#define LED_FRAMES_MASK 0x77
+
+static inline bool led_frames_has(uint8_t layer) {
+  return layer < LED_FRAMES_LAYERS && (LED_FRAMES_MASK >> layer) & 1;
+}
+
+// The frame of `layer` at brightness rgb_matrix_config.hsv.v. Scaled on the
+// first call after the layer or the brightness changes, then cached.
+const RGB* led_frames_get(uint8_t layer);
+
+// The active layers of `state` composited, at brightness
+// rgb_matrix_config.hsv.v: each LED from the highest layer that defines it,
+// off where none does. Cached like led_frames_get(), keyed on all of `state`.
+const RGB* led_frames_composite(layer_state_t state);
+
+// Scales every byte x of `bytes` to x * value / 255, rounded down. The words
+// path does four bytes at a time, two per 32-bit multiply in 16-bit lanes,
+// with the Cortex-M4's SIMD extract and add where it has them; the bytes
+// path is for AVR, where 32-bit multiplies are slow. LED_SCALE_WORDS picks
+// which of them led_frames_scale() is: the words path everywhere but AVR.
+void led_frames_scale_bytes(uint8_t* bytes, uint16_t length, uint8_t value);
+void led_frames_scale_words(uint8_t* bytes, uint16_t length, uint8_t value);
+
+#if !defined(LED_SCALE_WORDS) && defined(__AVR__)
+#define LED_SCALE_WORDS 0
+#elif !defined(LED_SCALE_WORDS)
+#define LED_SCALE_WORDS 1
+#endif
+#if LED_SCALE_WORDS
+#define led_frames_scale led_frames_scale_words
+#else
+#define led_frames_scale led_frames_scale_bytes
+#endif
+
+// Marks what the indicators show as stale. Call on every layer change, from
+// layer_state_set_user() and default_layer_state_set_user().
+void led_frames_invalidate(void);
+
+// Paints the active layers composited, or turns every LED off when none of
+// them has a frame or the layer LEDs are disabled and the RGB flags are
+// LED_FLAG_NONE. Which of these is worked out again only after
+// led_frames_invalidate() or a change of brightness, layer LED toggle or
+// flags; any other frame replays it.
+void led_frames_indicators(void);
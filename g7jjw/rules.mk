@@ -8,3 +8,4 @@ TAP_DANCE_ENABLE = yes
 SPACE_CADET_ENABLE = no
 CAPS_WORD_ENABLE = yes
 LAYER_LOCK_ENABLE = yes
+SRC += key_timing.c led_frames.c deadline.c send_string_deferred.c
@@ -1,5 +1,9 @@
 #include QMK_KEYBOARD_H
 #include "version.h"
+#include "key_timing.h"
+#include "led_frames.h"
+#include "deadline.h"
+#include "send_string_deferred.h"
 #define MOON_LED_LEVEL LED_LEVEL
 #ifndef ZSA_SAFE_RANGE
 #define ZSA_SAFE_RANGE SAFE_RANGE
@@ -96,29 +100,21 @@ combo_t key_combos[COMBO_COUNT] = {
 };
 
 uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record) {
-    switch (keycode) {
-        case KC_GRAVE:
-            return TAPPING_TERM -70;
-        case DUAL_FUNC_2:
-            return TAPPING_TERM + 15;
-        default:
-            return TAPPING_TERM;
-    }
+    (void)keycode;
+    return key_timing_tapping_term(record->event);
 }
 
 
 extern rgb_config_t rgb_matrix_config;
 
-RGB hsv_to_rgb_with_value(HSV hsv) {
-  RGB rgb = hsv_to_rgb( hsv );
-  float f = (float)rgb_matrix_config.hsv.v / UINT8_MAX;
-  return (RGB){ f * rgb.r, f * rgb.g, f * rgb.b };
-}
-
 void keyboard_post_init_user(void) {
   rgb_matrix_enable();
 }
 
+void housekeeping_task_user(void) {
+  deadline_task();
+}
+
 const uint8_t PROGMEM ledmap[][RGB_MATRIX_LED_COUNT][3] = {
     [0] = { {20,255,255}, {101,255,255}, {101,255,255}, {101,255,255}, {101,255,255}, {101,255,255}, {20,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {0,245,245}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {0,245,245}, {20,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {0,245,245}, {0,245,245}, {101,255,255}, {101,255,255}, {101,255,255}, {101,255,255}, {101,255,255}, {20,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {20,255,255}, {20,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {20,255,255}, {169,255,255}, {169,255,255}, {169,255,255}, {20,255,255}, {20,255,255}, {20,255,255}, {0,245,245}, {0,245,245} },
 
@@ -137,59 +133,27 @@ const uint8_t PROGMEM ledmap[][RGB_MATRIX_LED_COUNT][3] = {
 };
 
 void set_layer_color(int layer) {
+  const RGB* frame = led_frames_get(layer);
   for (int i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
-    HSV hsv = {
-      .h = pgm_read_byte(&ledmap[layer][i][0]),
-      .s = pgm_read_byte(&ledmap[layer][i][1]),
-      .v = pgm_read_byte(&ledmap[layer][i][2]),
-    };
-    if (!hsv.h && !hsv.s && !hsv.v) {
-        rgb_matrix_set_color( i, 0, 0, 0 );
-    } else {
-        RGB rgb = hsv_to_rgb_with_value(hsv);
-        rgb_matrix_set_color(i, rgb.r, rgb.g, rgb.b);
-    }
+    rgb_matrix_set_color(i, frame[i].r, frame[i].g, frame[i].b);
   }
 }
 
+layer_state_t layer_state_set_user(layer_state_t state) {
+  led_frames_invalidate();
+  return state;
+}
+
+layer_state_t default_layer_state_set_user(layer_state_t state) {
+  led_frames_invalidate();
+  return state;
+}
+
 bool rgb_matrix_indicators_user(void) {
   if (rawhid_state.rgb_control) {
       return false;
   }
-  if (!keyboard_config.disable_layer_led) { 
-    switch (biton32(layer_state)) {
-      case 0:
-        set_layer_color(0);
-        break;
-      case 1:
-        set_layer_color(1);
-        break;
-      case 2:
-        set_layer_color(2);
-        break;
-      case 3:
-        set_layer_color(3);
-        break;
-      case 4:
-        set_layer_color(4);
-        break;
-      case 5:
-        set_layer_color(5);
-        break;
-      case 6:
-        set_layer_color(6);
-        break;
-     default:
-        if (rgb_matrix_get_flags() == LED_FLAG_NONE) {
-          rgb_matrix_set_color_all(0, 0, 0);
-        }
-    }
-  } else {
-    if (rgb_matrix_get_flags() == LED_FLAG_NONE) {
-      rgb_matrix_set_color_all(0, 0, 0);
-    }
-  }
-
+  led_frames_indicators();
   return true;
 }
 
@@ -201,37 +165,37 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
   switch (keycode) {
     case ST_MACRO_0:
     if (record->event.pressed) {
-      SEND_STRING(SS_LSFT(SS_TAP(X_SCLN))SS_DELAY(100)  SS_TAP(X_L)SS_DELAY(100)  SS_TAP(X_S));
+      SEND_STRING_DEFERRED(SS_LSFT(SS_TAP(X_SCLN))SS_DELAY(100)  SS_TAP(X_L)SS_DELAY(100)  SS_TAP(X_S));
     }
     break;
     case ST_MACRO_1:
     if (record->event.pressed) {
-      SEND_STRING(SS_TAP(X_D)SS_DELAY(100)  SS_TAP(X_T)SS_DELAY(100)  SS_TAP(X_I)SS_DELAY(100)  SS_TAP(X_M));
+      SEND_STRING_DEFERRED(SS_TAP(X_D)SS_DELAY(100)  SS_TAP(X_T)SS_DELAY(100)  SS_TAP(X_I)SS_DELAY(100)  SS_TAP(X_M));
     }
     break;
     case ST_MACRO_2:
     if (record->event.pressed) {
-      SEND_STRING(SS_LSFT(SS_TAP(X_SCLN))SS_DELAY(100)  SS_TAP(X_A)SS_DELAY(100)  SS_TAP(X_P)SS_DELAY(100)  SS_TAP(X_U)SS_DELAY(100)  SS_TAP(X_P));
+      SEND_STRING_DEFERRED(SS_LSFT(SS_TAP(X_SCLN))SS_DELAY(100)  SS_TAP(X_A)SS_DELAY(100)  SS_TAP(X_P)SS_DELAY(100)  SS_TAP(X_U)SS_DELAY(100)  SS_TAP(X_P));
     }
     break;
     case ST_MACRO_3:
     if (record->event.pressed) {
-      SEND_STRING(SS_LSFT(SS_TAP(X_SCLN))SS_DELAY(100)  SS_TAP(X_L)SS_DELAY(100)  SS_TAP(X_T)  SS_DELAY(100) SS_TAP(X_ENTER));
+      SEND_STRING_DEFERRED(SS_LSFT(SS_TAP(X_SCLN))SS_DELAY(100)  SS_TAP(X_L)SS_DELAY(100)  SS_TAP(X_T)  SS_DELAY(100) SS_TAP(X_ENTER));
     }
     break;
     case ST_MACRO_4:
     if (record->event.pressed) {
-      SEND_STRING(SS_LSFT(SS_TAP(X_A))SS_DELAY(30)  SS_TAP(X_S)SS_DELAY(30)  SS_TAP(X_Y)SS_DELAY(30)  SS_TAP(X_L)SS_DELAY(30)  SS_TAP(X_U)SS_DELAY(30)  SS_TAP(X_M)SS_DELAY(30)  SS_TAP(X_1)SS_DELAY(30)  SS_TAP(X_3)  SS_DELAY(30) SS_TAP(X_ENTER));
+      SEND_STRING_DEFERRED(SS_LSFT(SS_TAP(X_A))SS_DELAY(30)  SS_TAP(X_S)SS_DELAY(30)  SS_TAP(X_Y)SS_DELAY(30)  SS_TAP(X_L)SS_DELAY(30)  SS_TAP(X_U)SS_DELAY(30)  SS_TAP(X_M)SS_DELAY(30)  SS_TAP(X_1)SS_DELAY(30)  SS_TAP(X_3)  SS_DELAY(30) SS_TAP(X_ENTER));
     }
     break;
     case ST_MACRO_5:
     if (record->event.pressed) {
-      SEND_STRING(SS_LSFT(SS_TAP(X_SCLN))SS_DELAY(100)  SS_TAP(X_Y)SS_DELAY(100)  SS_TAP(X_U)SS_DELAY(100)  SS_TAP(X_P));
+      SEND_STRING_DEFERRED(SS_LSFT(SS_TAP(X_SCLN))SS_DELAY(100)  SS_TAP(X_Y)SS_DELAY(100)  SS_TAP(X_U)SS_DELAY(100)  SS_TAP(X_P));
     }
     break;
     case ST_MACRO_6:
     if (record->event.pressed) {
-      SEND_STRING(SS_TAP(X_D)SS_DELAY(100)  SS_TAP(X_D)SS_DELAY(100)  SS_TAP(X_U)SS_DELAY(100)  SS_TAP(X_S));
+      SEND_STRING_DEFERRED(SS_TAP(X_D)SS_DELAY(100)  SS_TAP(X_D)SS_DELAY(100)  SS_TAP(X_U)SS_DELAY(100)  SS_TAP(X_S));
     }
     break;
 
@@ -0,0 +1,261 @@
+// led_frames.c — RGB frames of the layer LEDs
+//
+// Generated by tools/gen_led_frames.py from the ledmap in keymap.c or
+// ledmap.json.
+// Do not edit.
+
+#include QMK_KEYBOARD_H
+#include "led_frames.h"
+#ifdef __ARM_FEATURE_SIMD32
+#include <arm_acle.h>
+#endif
+
+// Every color of the layers at full brightness; index 0 is off.
+#define LED_PALETTE_SIZE 12
+#define LED_INDEX_BITS 4
+
+static const RGB led_palette[LED_PALETTE_SIZE] PROGMEM = {
+  {0x00, 0x00, 0x00}, {0xff, 0x78, 0x00}, {0x00, 0xff, 0x60}, {0x00, 0x06, 0xff},
+  {0xf5, 0x0a, 0x09}, {0x00, 0xea, 0xff}, {0xb8, 0x71, 0x33}, {0xff, 0xa2, 0x00},
+  {0x95, 0x1d, 0xcc}, {0xe2, 0xb9, 0x16}, {0xfb, 0x5f, 0x5e}, {0xcc, 0x1d, 0x57},
+};
+
+// A layer in led_layer_data: `lit` (LED, palette index) pairs, or one index
+// per LED when `lit` is LED_LAYER_DENSE
+#define LED_LAYER_DENSE UINT8_MAX
+
+typedef struct {
+  uint16_t offset;
+  uint8_t lit;
+} led_layer_t;
+
+static const led_layer_t led_layers[LED_FRAMES_LAYERS] PROGMEM = {
+  [0] = {0, LED_LAYER_DENSE},
+  [1] = {26, LED_LAYER_DENSE},
+  [2] = {52, LED_LAYER_DENSE},
+  [3] = {78, LED_LAYER_DENSE},
+  [4] = {104, 7},
+  [5] = {118, 3},
+  [6] = {124, 1},
+};
+
+static const uint8_t led_layer_data[] PROGMEM = {
+  // Layer 0, dense
+  0x21, 0x22, 0x22, 0x31, 0x33, 0x33, 0x34, 0x33, 0x33, 0x14, 0x33, 0x33,
+  0x44, 0x22, 0x22, 0x12, 0x33, 0x33, 0x11, 0x33, 0x33, 0x13, 0x33, 0x13,
+  0x11, 0x44,
+  // Layer 1, dense
+  0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x06, 0x10, 0x11,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x71, 0x07, 0x00, 0x71, 0x77,
+  0x40, 0x60,
+  // Layer 2, dense
+  0x50, 0x55, 0x55, 0x00, 0x00, 0x00, 0x50, 0x05, 0x50, 0x80, 0x88, 0x50,
+  0x00, 0x55, 0x55, 0x05, 0x00, 0x00, 0x00, 0xa9, 0xab, 0x09, 0xb0, 0xbb,
+  0x00, 0x04,
+  // Layer 3, dense
+  0x00, 0x00, 0x04, 0x40, 0x04, 0x00, 0x00, 0x04, 0x00, 0x40, 0x04, 0x44,
+  0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x40, 0x04, 0x40, 0x00,
+  0x40, 0x00,
+  // Layer 4, 7 lit
+  0x09, 0x03, 0x0a, 0x03, 0x0d, 0x03, 0x10, 0x03, 0x12, 0x06, 0x23, 0x03,
+  0x2e, 0x03,
+  // Layer 5, 3 lit
+  0x01, 0x03, 0x02, 0x03, 0x03, 0x03,
+  // Layer 6, 1 lit
+  0x1f, 0x04,
+};
+
+// LEDs each layer defines, bit i of word w for LED 32 * w + i: its key is not
+// transparent, or the ledmap gives it a color
+#define LED_WORDS ((RGB_MATRIX_LED_COUNT + 31) / 32)
+
+static const uint32_t led_defined[LED_FRAMES_LAYERS][LED_WORDS] PROGMEM = {
+  [0] = {0xffffffff, 0x000fffff},
+  [1] = {0x00e60010, 0x000af1c0},
+  [2] = {0x7cba603e, 0x0004e7c0},
+  [3] = {0x00d84190, 0x00022601},
+  [4] = {0x00052600, 0x00004008},
+  [5] = {0x0000000e, 0x00000000},
+  [6] = {0x80000000, 0x00000000},
+};
+
+static const uint32_t led_all[LED_WORDS] = {0xffffffff, 0x000fffff};
+
+static RGB frame[RGB_MATRIX_LED_COUNT];
+static layer_state_t frame_layers = 0;  // Layers in `frame`, none at first
+static bool frame_composite = false;
+static uint8_t frame_value = 0;
+
+// x * value / 255, rounded down as the float scaling it replaces, without a
+// division
+static inline uint8_t scale(uint8_t x, uint8_t value) {
+  const uint16_t product = (uint16_t)x * value;
+  return (product + 1 + (product >> 8)) >> 8;
+}
+
+void led_frames_scale_bytes(uint8_t* bytes, uint16_t length, uint8_t value) {
+  for (uint16_t i = 0; i < length; ++i) {
+    bytes[i] = scale(bytes[i], value);
+  }
+}
+
+// Bytes 0 and 2 of x as 16-bit lanes; a + those lanes
+#ifdef __ARM_FEATURE_SIMD32
+#define UXTB16(x) __uxtb16(x)
+#define UXTAB16(a, x) __uxtab16((a), (x))
+#else
+#define UXTB16(x) ((x) & 0x00FF00FFu)
+#define UXTAB16(a, x) ((a) + UXTB16(x))
+#endif
+
+// scale() of the four bytes of `word`. A lane holds at most
+// 255 * 255 + 1 + 254 < 2^16, so no lane carries into the next and no
+// saturation is needed.
+static inline uint32_t scale_word(uint32_t word, uint32_t value) {
+  const uint32_t even = UXTB16(word) * value + 0x00010001u;
+  const uint32_t odd = UXTB16(word >> 8) * value + 0x00010001u;
+  const uint32_t even_scaled = UXTAB16(even, even >> 8);
+  const uint32_t odd_scaled = UXTAB16(odd, odd >> 8);
+  return ((even_scaled >> 8) & 0x00FF00FFu) | (odd_scaled & 0xFF00FF00u);
+}
+
+void led_frames_scale_words(uint8_t* bytes, uint16_t length, uint8_t value) {
+  uint16_t i = 0;
+  for (; i + 4 <= length; i += 4) {
+    uint32_t word;
+    memcpy(&word, &bytes[i], sizeof(word));
+    word = scale_word(word, value);
+    memcpy(&bytes[i], &word, sizeof(word));
+  }
+  for (; i < length; ++i) {
+    bytes[i] = scale(bytes[i], value);
+  }
+}
+
+// The palette index of LED `i` of a dense layer
+static inline uint8_t dense_index(const uint8_t* data, uint8_t i) {
+#if LED_INDEX_BITS == 4
+  return (pgm_read_byte(&data[i >> 1]) >> ((i & 1) << 2)) & 0x0F;
+#else
+  return pgm_read_byte(&data[i]);
+#endif
+}
+
+// `palette` at `value`
+static void scale_palette(RGB palette[LED_PALETTE_SIZE], uint8_t value) {
+  const uint8_t* source = (const uint8_t*)led_palette;
+  uint8_t* target = (uint8_t*)palette;
+  for (uint8_t i = 0; i < LED_PALETTE_SIZE * sizeof(RGB); ++i) {
+    target[i] = pgm_read_byte(&source[i]);
+  }
+  led_frames_scale(target, LED_PALETTE_SIZE * sizeof(RGB), value);
+}
+
+// Sets the LEDs of `take` in `frame` to their colors on `layer`. The LEDs of
+// `take` must be off before.
+static void paint_layer(uint8_t layer, const RGB* palette, const uint32_t take[LED_WORDS]) {
+  const uint8_t* data = &led_layer_data[pgm_read_word(&led_layers[layer].offset)];
+  const uint8_t lit = pgm_read_byte(&led_layers[layer].lit);
+  if (lit == LED_LAYER_DENSE) {
+    for (uint8_t w = 0; w < LED_WORDS; ++w) {
+      for (uint32_t bits = take[w]; bits != 0; bits &= bits - 1) {
+        const uint8_t i = w * 32 + __builtin_ctzl(bits);
+        frame[i] = palette[dense_index(data, i)];
+      }
+    }
+  } else {
+    for (uint8_t j = 0; j < lit; ++j) {
+      const uint8_t i = pgm_read_byte(&data[2 * j]);
+      if ((take[i >> 5] >> (i & 31)) & 1) {
+        frame[i] = palette[pgm_read_byte(&data[2 * j + 1])];
+      }
+    }
+  }
+}
+
+const RGB* led_frames_get(uint8_t layer) {
+  const uint8_t value = rgb_matrix_config.hsv.v;
+  const layer_state_t layers = (layer_state_t)1 << layer;
+  if (layers != frame_layers || frame_composite || value != frame_value) {
+    RGB palette[LED_PALETTE_SIZE];
+    scale_palette(palette, value);
+    memset(frame, 0, sizeof(frame));
+    paint_layer(layer, palette, led_all);
+    frame_layers = layers;
+    frame_composite = false;
+    frame_value = value;
+  }
+  return frame;
+}
+
+const RGB* led_frames_composite(layer_state_t state) {
+  const uint8_t value = rgb_matrix_config.hsv.v;
+  if (state != frame_layers || !frame_composite || value != frame_value) {
+    RGB palette[LED_PALETTE_SIZE];
+    scale_palette(palette, value);
+    memset(frame, 0, sizeof(frame));
+
+    // Highest layer first: each takes the LEDs it defines that no layer
+    // above it took.
+    uint32_t taken[LED_WORDS] = {0};
+    for (layer_state_t layers = state & LED_FRAMES_MASK; layers != 0;) {
+      const uint8_t layer = biton32(layers);
+      layers &= ~((layer_state_t)1 << layer);
+      uint32_t take[LED_WORDS];
+      uint32_t any = 0;
+      for (uint8_t w = 0; w < LED_WORDS; ++w) {
+        take[w] = pgm_read_dword(&led_defined[layer][w]) & ~taken[w];
+        taken[w] |= take[w];
+        any |= take[w];
+      }
+      if (any != 0) {
+        paint_layer(layer, palette, take);
+      }
+    }
+    frame_layers = state;
+    frame_composite = true;
+    frame_value = value;
+  }
+  return frame;
+}
+
+// What led_frames_indicators() paints until something it depends on changes
+static enum { SHOW_NOTHING, SHOW_FRAME, SHOW_OFF } shown = SHOW_NOTHING;
+static bool shown_valid = false;
+static layer_state_t shown_layers = 0;
+static uint8_t shown_value = 0;
+static bool shown_disabled = false;
+static led_flags_t shown_flags = LED_FLAG_NONE;
+
+void led_frames_invalidate(void) {
+  shown_valid = false;
+}
+
+void led_frames_indicators(void) {
+  const uint8_t value = rgb_matrix_config.hsv.v;
+  const bool disabled = keyboard_config.disable_layer_led;
+  const led_flags_t flags = rgb_matrix_get_flags();
+  if (!shown_valid || value != shown_value || disabled != shown_disabled || flags != shown_flags) {
+    shown_layers = layer_state | default_layer_state;
+    if (!disabled && (shown_layers & LED_FRAMES_MASK) != 0) {
+      shown = SHOW_FRAME;
+    } else {
+      shown = flags == LED_FLAG_NONE ? SHOW_OFF : SHOW_NOTHING;
+    }
+    shown_valid = true;
+    shown_value = value;
+    shown_disabled = disabled;
+    shown_flags = flags;
+  }
+
+  // The RGB effect repaints every LED before the indicators, so even an
+  // unchanged frame has to be set again.
+  if (shown == SHOW_FRAME) {
+    const RGB* frame = led_frames_composite(shown_layers);
+    for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; ++i) {
+      rgb_matrix_set_color(i, frame[i].r, frame[i].g, frame[i].b);
+    }
+  } else if (shown == SHOW_OFF) {
+    rgb_matrix_set_color_all(0, 0, 0);
+  }
+}
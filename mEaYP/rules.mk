@@ -8,3 +8,4 @@ SPACE_CADET_ENABLE = no
 CAPS_WORD_ENABLE = yes
 REPEAT_KEY_ENABLE = yes
 COMBO_ENABLE = yes
+SRC += key_timing.c led_frames.c deadline.c send_string_deferred.c
@@ -7,3 +7,4 @@ RGB_MATRIX_CUSTOM_KB = yes
 SPACE_CADET_ENABLE = no
 CAPS_WORD_ENABLE = yes
 REPEAT_KEY_ENABLE = yes
+SRC += key_timing.c led_frames.c deadline.c send_string_deferred.c
@@ -0,0 +1,316 @@
+#!/usr/bin/env python3
+"""Reports where a layout build's flash and RAM go, from its linker map.
+
+Reads the GNU ld map QMK writes next to the firmware
+(.build/<keyboard>_<layout>.map) and sums every input section into a
+piece of the layout:
+
+    keymaps                 the keymaps array
+    ledmap                  the ledmap array and its generated frames
+    tap dance handlers      keymap.c's dance functions and tables
+    SEND_STRING macros      keymap.c's string literals and the players
+    Achordion               achordion.c, its stats and chord exceptions
+    <FEATURE>_ENABLE        QMK's code for each feature rules.mk turns on
+    SRC <file>              the layout's other rules.mk sources
+    keymap.c (other)        the rest of keymap.c
+    QMK core and platform   everything else
+
+Flash counts code, constants and the initial values of .data; RAM counts
+.data and .bss, not the stack. Pieces are only as fine as the sections:
+QMK builds with -ffunction-sections -fdata-sections, but with LTO_ENABLE
+code moves into link-time objects and is reported as core.
+
+With --baseline, prints the change of every piece since the stored build;
+with --write, stores this build as the new baseline. Fails when the total
+is over budget: --flash-budget and --ram-budget, else the keyboard's
+(--keyboard), else the flash and RAM regions of the map.
+
+Usage: footprint.py LAYOUT_DIR MAP [--keyboard GEOMETRY]
+                    [--flash-budget BYTES] [--ram-budget BYTES]
+                    [--baseline FILE [--write]]
+"""
+
+import argparse
+import json
+import re
+import sys
+from pathlib import Path
+
+# Flash and RAM the firmware may use, for keyboards whose map does not
+# say: avr-ld's memory regions are the whole AVR address space.
+BUDGETS = {
+    # ATmega32U4 less the 512-byte Teensy HalfKay bootloader
+    "ergodox_ez/m32u4": (32256, 2560),
+    "ergodox_ez/m32u4/glow": (32256, 2560),
+    "ergodox_ez/m32u4/shine": (32256, 2560),
+}
+
+# Objects of QMK's code for each rules.mk feature, by basename
+FEATURE_OBJECTS = {
+    "AUDIO_ENABLE": ["audio", "process_audio", "process_clicky", "process_music"],
+    "AUTO_SHIFT_ENABLE": ["process_auto_shift"],
+    "BOOTMAGIC_ENABLE": ["bootmagic"],
+    "CAPS_WORD_ENABLE": ["caps_word", "process_caps_word"],
+    "COMBO_ENABLE": ["process_combo"],
+    "COMMAND_ENABLE": ["command"],
+    "CONSOLE_ENABLE": ["print", "sendchar"],
+    "DYNAMIC_MACRO_ENABLE": ["process_dynamic_macro"],
+    "KEY_CAPTURE_ENABLE": ["key_capture"],
+    "KEY_OVERRIDE_ENABLE": ["process_key_override"],
+    "LEADER_ENABLE": ["leader", "process_leader"],
+    "MOUSEKEY_ENABLE": ["mousekey", "process_mousekey"],
+    "ORYX_ENABLE": ["oryx"],
+    "RAW_ENABLE": ["raw_hid"],
+    "REPEAT_KEY_ENABLE": ["repeat_key", "process_repeat_key"],
+    "RGB_MATRIX_ENABLE": ["rgb_matrix", "rgb_matrix_drivers", "process_rgb_matrix"],
+    "SPACE_CADET_ENABLE": ["process_space_cadet"],
+    "TAP_DANCE_ENABLE": ["process_tap_dance"],
+    "UNICODE_ENABLE": ["unicode", "process_unicode", "process_unicode_common"],
+}
+
+# keymap.c builds into keymap_introspection.o, which #includes it
+KEYMAP_OBJECTS = {"keymap", "keymap_introspection"}
+ACHORDION_OBJECTS = {"achordion", "achordion_stats", "chord_exceptions"}
+SEND_STRING_OBJECTS = {"send_string", "send_string_deferred"}
+LEDMAP_OBJECTS = {"led_frames"}  # gen_led_frames.py's frames of the ledmap
+TAP_DANCE = re.compile(r"^(on_dance_\d+|dance_\d+_\w+|dance_step|dance_state|tap_dance_actions)$")
+# String literals: GCC's mergeable string sections, and PSTR()'s __c arrays
+STRINGS = re.compile(r"^\.rodata(\.[\w.]*)?\.str\d|^\.progmem\.data(\.__c\.\d+)?$")
+SECTION_PREFIX = re.compile(r"^\.(text|rodata|data|bss|progmem\.data|progmem\.gcc_sw_table)\.")
+
+CORE = "QMK core and platform"
+KEYMAP_OTHER = "keymap.c (other)"
+
+
+def parse_size(text):
+    """Bytes of "28672", "0x7000" or "28K"."""
+    m = re.fullmatch(r"(0x[0-9A-Fa-f]+|\d+)([KkMm]?)", text)
+    if not m:
+        raise argparse.ArgumentTypeError("not a size: %s" % text)
+    return int(m.group(1), 0) * {"": 1, "k": 1024, "m": 1024 * 1024}[m.group(2).lower()]
+
+
+def parse_map(text):
+    """Memory regions, as {name: (origin, length)}, and the allocated input
+    sections, as (output section, input section, address, load address,
+    size, object) tuples."""
+    regions = {}
+    sections = []
+    lines = text.splitlines()
+    i = 0
+    while i < len(lines) and lines[i].strip() != "Memory Configuration":
+        i += 1
+    for line in lines[i + 1:]:
+        if line.startswith("Linker script and memory map"):
+            break
+        fields = line.split()
+        if len(fields) >= 3 and fields[1].startswith("0x") and fields[0] != "*default*":
+            regions[fields[0]] = (int(fields[1], 16), int(fields[2], 16))
+
+    output = None
+    header = False  # The output section's address may be on the next line
+    load_offset = 0
+    pending = None  # Input section name whose address is on the next line
+    for line in lines[i:]:
+        if line.startswith("Cross Reference Table"):
+            break
+        # Output section: ".data  0x20000000  0x100 load address 0x0800f000"
+        load = re.search(r"0x([0-9a-f]+)\s+0x[0-9a-f]+\s+load address 0x([0-9a-f]+)", line)
+        if line and not line[0].isspace():
+            output = line.split()[0]
+            header = True
+            load_offset = 0
+            pending = None
+        if header:
+            if load:
+                load_offset = int(load.group(2), 16) - int(load.group(1), 16)
+            header = not line[0].isspace() and len(line.split()) == 1
+            continue
+        fields = line.split()
+        if (pending is None and len(fields) == 1 and line.startswith(" ") and
+                (fields[0].startswith(".") or fields[0] == "COMMON")):
+            pending = fields[0]
+            continue
+        if pending is not None:
+            fields = [pending] + fields
+            pending = None
+        if (output is None or len(fields) < 4 or not line.startswith(" ") or
+                not (fields[0].startswith(".") or fields[0] == "COMMON") or
+                not fields[1].startswith("0x") or not fields[2].startswith("0x")):
+            continue
+        address, size = int(fields[1], 16), int(fields[2], 16)
+        if size == 0:
+            continue
+        sections.append((output, fields[0], address, address + load_offset, size,
+                         " ".join(fields[3:])))
+    return regions, sections
+
+
+def memory_of(address, output, regions):
+    """"flash", "ram" or None for a section at `address`."""
+    for name, (origin, length) in regions.items():
+        if origin <= address < origin + length:
+            if re.search(r"flash|text|rom", name, re.I):
+                return "flash"
+            if re.search(r"ram|data", name, re.I):
+                return "ram"
+            return None
+    # No regions to go by, as in host builds: by output section name
+    if re.match(r"\.(text|rodata|init|fini|ARM\.ex|vectors)", output):
+        return "flash"
+    if re.match(r"\.(data|bss|noinit)", output):
+        return "ram"
+    return None
+
+
+def object_name(path):
+    """Basename without .o of "dir/x.o" or "lib.a(x.o)"."""
+    m = re.search(r"\(([^)]*)\)$", path)
+    name = Path(m.group(1) if m else path).name
+    return name[:-2] if name.endswith(".o") else name
+
+
+def rules(layout_dir):
+    """Features rules.mk turns on, and its own SRC files."""
+    text = (layout_dir / "rules.mk").read_text()
+    features = [m.group(1) for m in re.finditer(
+        r"^\s*(\w+_ENABLE)\s*[:?]?=\s*yes\b", text, re.M)]
+    sources = []
+    for m in re.finditer(r"^\s*SRC\s*\+=(.*)$", text, re.M):
+        sources += [Path(s).stem for s in m.group(1).split()]
+    return features, sources
+
+
+def piece_of(section, obj, features, sources):
+    symbol = SECTION_PREFIX.sub("", section)
+    name = object_name(obj)
+    if name in KEYMAP_OBJECTS:
+        if symbol == "keymaps":
+            return "keymaps"
+        if symbol == "ledmap":
+            return "ledmap"
+        if TAP_DANCE.match(symbol):
+            return "tap dance handlers"
+        if STRINGS.search(section):
+            return "SEND_STRING macros"
+        return KEYMAP_OTHER
+    if name in SEND_STRING_OBJECTS:
+        return "SEND_STRING macros"
+    if name in LEDMAP_OBJECTS:
+        return "ledmap"
+    if name in ACHORDION_OBJECTS:
+        return "Achordion"
+    for feature in features:
+        if name in FEATURE_OBJECTS.get(feature, []):
+            return feature
+    if name in sources:
+        return "SRC %s.c" % name
+    return CORE
+
+
+def footprint(layout_dir, map_path):
+    """{piece: [flash, ram]} and the map's regions."""
+    features, sources = rules(layout_dir)
+    regions, sections = parse_map(map_path.read_text(errors="replace"))
+    pieces = {"keymaps": [0, 0], "ledmap": [0, 0], "tap dance handlers": [0, 0],
+              "SEND_STRING macros": [0, 0], "Achordion": [0, 0]}
+    pieces.update((f, [0, 0]) for f in features)
+    lto = False
+    for output, section, address, load, size, obj in sections:
+        memory = memory_of(address, output, regions)
+        if memory is None:
+            continue
+        lto = lto or "ltrans" in obj
+        counts = pieces.setdefault(piece_of(section, obj, features, sources), [0, 0])
+        if memory == "flash":
+            counts[0] += size
+        else:
+            counts[1] += size
+            if load != address and memory_of(load, output, regions) == "flash":
+                counts[0] += size  # Initial values of .data
+    if lto:
+        print("footprint: built with LTO, most code is counted as core", file=sys.stderr)
+    return pieces, regions
+
+
+def region_budget(regions, kind):
+    """Length of the largest region of a kind: ChibiOS's ram regions
+    overlap."""
+    sizes = [length for name, (_, length) in regions.items()
+             if re.search(kind, name, re.I)]
+    return max(sizes) if sizes else None
+
+
+def signed(n):
+    return "%+d" % n if n else "0"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("layout", type=Path, help="layout directory")
+    parser.add_argument("map", type=Path, help="linker map of the layout's build")
+    parser.add_argument("--keyboard", help="keyboard geometry, e.g. ergodox_ez/m32u4/glow")
+    parser.add_argument("--flash-budget", type=parse_size, help="flash budget, bytes")
+    parser.add_argument("--ram-budget", type=parse_size, help="RAM budget, bytes")
+    parser.add_argument("--baseline", type=Path, help="footprint of the previous build")
+    parser.add_argument("--write", action="store_true", help="store this build as --baseline")
+    args = parser.parse_args()
+    if args.write and not args.baseline:
+        parser.error("--write needs --baseline")
+
+    try:
+        pieces, regions = footprint(args.layout, args.map)
+    except OSError as e:
+        sys.exit("footprint: %s" % e)
+    previous = {}
+    if args.baseline and args.baseline.exists():
+        previous = json.loads(args.baseline.read_text()).get("pieces", {})
+
+    keyboard = BUDGETS.get(args.keyboard, (None, None))
+    budgets = [
+        args.flash_budget or keyboard[0] or region_budget(regions, "flash|rom"),
+        args.ram_budget or keyboard[1] or region_budget(regions, "ram"),
+    ]
+
+    names = sorted(pieces, key=lambda n: (n in (KEYMAP_OTHER, CORE), n.startswith("SRC"),
+                                          n.endswith("_ENABLE"), -pieces[n][0]))
+    names += [n for n in previous if n not in pieces]
+    width = max(len(n) for n in names + ["total"]) + 2
+    header = ["flash", "RAM"] + (["Δflash", "ΔRAM"] if previous else [])
+    print("Footprint of %s, bytes (%s)" % (args.layout.name, args.map))
+    print("".ljust(width) + "".join(h.rjust(10) for h in header))
+    totals = [0, 0]
+    before = [0, 0]
+    for name in names:
+        counts = pieces.get(name, [0, 0])
+        old = previous.get(name, [0, 0])
+        totals = [t + c for t, c in zip(totals, counts)]
+        before = [b + o for b, o in zip(before, old)]
+        row = [str(c) for c in counts]
+        if previous:
+            row += [signed(c - o) for c, o in zip(counts, old)]
+        print(name.ljust(width) + "".join(r.rjust(10) for r in row))
+    row = [str(t) for t in totals]
+    if previous:
+        row += [signed(t - b) for t, b in zip(totals, before)]
+    print("total".ljust(width) + "".join(r.rjust(10) for r in row))
+
+    over = []
+    for kind, total, budget in zip(["flash", "RAM"], totals, budgets):
+        if budget is None:
+            print("%s budget: none" % kind)
+            continue
+        print("%s budget: %d of %d bytes, %.1f%%" % (kind, total, budget, 100.0 * total / budget))
+        if total > budget:
+            over.append("%s over budget by %d bytes" % (kind, total - budget))
+
+    if args.write:
+        args.baseline.parent.mkdir(parents=True, exist_ok=True)
+        args.baseline.write_text(json.dumps(
+            {"flash": totals[0], "ram": totals[1], "pieces": pieces}, indent=2) + "\n")
+    if over:
+        sys.exit("footprint: " + "; ".join(over))
+
+
+if __name__ == "__main__":
+    main()
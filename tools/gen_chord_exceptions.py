@@ -0,0 +1,233 @@
+#!/usr/bin/env python3
+"""Generates Achordion's hands and same-hand chord exceptions of a layout.
+
+Reads <layout>/chord_exceptions.json and <layout>/keymap.c, and writes
+<layout>/chord_exceptions.h and <layout>/chord_exceptions.c: three PROGMEM
+bitmaps, laid out with the keymap's LAYOUT macro.
+
+The first one holds the hand of every key, one bit per hand, from the
+keymap's chordal_hold_layout. Keys listed in "either_hand" have no bit, so
+they chord with any key in Achordion. QMK's own Chordal Hold still reads
+chordal_hold_layout as written.
+
+Bit i of a key's entry in the second one is set if the key is a tap-hold key
+of exception i; in the third one, if it is an other key of exception i. A
+same-hand chord is allowed if the two entries share a bit.
+
+chord_exceptions.json:
+
+    {
+      "either_hand": [48, 49, 50, 51],
+      "exceptions": [
+        {"name": "GUI + Z/X/C/V",
+         "tap_hold": ["MT(MOD_LGUI, KC_T)"],
+         "other": ["TD(DANCE_0)", "TD(DANCE_1)", "TD(DANCE_2)", "TD(DANCE_3)"]},
+        ...
+      ]
+    }
+
+Keys, in "either_hand" and in the exceptions, are given as one of:
+- a keycode, spelled as in keymap.c or with its #define expanded: every
+  position holding it on any layer;
+- "MT:<MOD>", e.g. "MT:GUI": every mod-tap key whose mods include
+  MOD_LGUI or MOD_RGUI;
+- an integer: a position, as its index in LAYOUT order.
+
+Usage: gen_chord_exceptions.py LAYOUT_DIR... [--check]
+"""
+
+import argparse
+import json
+import re
+import sys
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+from qmk_keymap import Keymap, ROW_LENGTHS, format_layout, normalize  # noqa: E402
+
+# Mask type and PROGMEM reader by the number of exceptions it must hold.
+MASK_TYPES = [
+    (8, "uint8_t", "pgm_read_byte"),
+    (16, "uint16_t", "pgm_read_word"),
+    (32, "uint32_t", "pgm_read_dword"),
+]
+
+_MOD_TAP = re.compile(r"^MT\((.*),\w+\)$")
+
+# Hand bits of the chordal_hold_layout classes; '*' is on neither.
+HANDS = {"L": 0x01, "R": 0x02, "*": 0}
+
+HEADER = """\
+// chord_exceptions.h — Achordion's hands and same-hand chord exceptions
+//
+// Generated by tools/gen_chord_exceptions.py from chord_exceptions.json and
+// keymap.c. Do not edit: change chord_exceptions.json and run
+//   python3 tools/gen_chord_exceptions.py {layout}
+
+#pragma once
+
+#include "quantum.h"
+
+#define CHORD_EXCEPTIONS {count}
+
+#define CHORD_HAND_LEFT 0x01
+#define CHORD_HAND_RIGHT 0x02
+
+// Hand bit of every key; none for keys that go with either hand.
+extern const uint8_t chord_hands[MATRIX_ROWS][MATRIX_COLS] PROGMEM;
+
+// Returns true if both keys are on the same hand. Keys outside the matrix,
+// like combos, are on neither.
+static inline bool chord_same_hand(keypos_t a, keypos_t b) {{
+  if (a.row >= MATRIX_ROWS || a.col >= MATRIX_COLS ||
+      b.row >= MATRIX_ROWS || b.col >= MATRIX_COLS) {{
+    return false;
+  }}
+  return (pgm_read_byte(&chord_hands[a.row][a.col]) &
+          pgm_read_byte(&chord_hands[b.row][b.col])) != 0;
+}}
+
+typedef {ctype} chord_exception_mask_t;
+
+// Bit i is set if the key is a tap-hold key of exception i.
+extern const chord_exception_mask_t chord_exception_tap_hold[MATRIX_ROWS][MATRIX_COLS] PROGMEM;
+// Bit i is set if the key is an other key of exception i.
+extern const chord_exception_mask_t chord_exception_other[MATRIX_ROWS][MATRIX_COLS] PROGMEM;
+
+// Returns true if a chord of the two keys is an exception, allowed to
+// settle as hold even on the same hand.
+static inline bool chord_exception(keypos_t tap_hold, keypos_t other) {{
+  if (tap_hold.row >= MATRIX_ROWS || tap_hold.col >= MATRIX_COLS ||
+      other.row >= MATRIX_ROWS || other.col >= MATRIX_COLS) {{
+    return false;
+  }}
+  return ({read}(&chord_exception_tap_hold[tap_hold.row][tap_hold.col]) &
+          {read}(&chord_exception_other[other.row][other.col])) != 0;
+}}
+"""
+
+SOURCE = """\
+// chord_exceptions.c — Achordion's hands and same-hand chord exceptions
+//
+// Generated by tools/gen_chord_exceptions.py from chord_exceptions.json and
+// keymap.c. Do not edit.
+//
+{legend}
+
+#include "chord_exceptions.h"
+
+const uint8_t chord_hands[MATRIX_ROWS][MATRIX_COLS] PROGMEM = {hands};
+
+const chord_exception_mask_t chord_exception_tap_hold[MATRIX_ROWS][MATRIX_COLS] PROGMEM = {tap_hold};
+
+const chord_exception_mask_t chord_exception_other[MATRIX_ROWS][MATRIX_COLS] PROGMEM = {other};
+"""
+
+
+class SpecError(Exception):
+    pass
+
+
+def positions_of(entry, keymap):
+    """Returns the set of LAYOUT indices that `entry` designates."""
+    if isinstance(entry, int):
+        if not 0 <= entry < keymap.key_count:
+            raise SpecError("position %d is not in the keymap" % entry)
+        return {entry}
+
+    found = set()
+    if entry.startswith("MT:"):
+        mod = entry[3:].upper()
+        for keycodes in keymap.layers:
+            for key, keycode in enumerate(keycodes):
+                m = _MOD_TAP.match(keymap.expand(keycode))
+                if m and re.search(r"MOD_[LR]%s\b" % mod, m.group(1)):
+                    found.add(key)
+    else:
+        wanted = normalize(entry)
+        for keycodes in keymap.layers:
+            for key, keycode in enumerate(keycodes):
+                if wanted in (keycode, keymap.expand(keycode)):
+                    found.add(key)
+    if not found:
+        raise SpecError("%s is not in the keymap" % entry)
+    return found
+
+
+def is_tap_hold(keycode):
+    return re.match(r"^(MT|LT|[LR](CTL|SFT|ALT|GUI)_T)\(", keycode) is not None
+
+
+def generate(layout_dir):
+    layout_dir = Path(layout_dir)
+    spec = json.loads((layout_dir / "chord_exceptions.json").read_text())
+    keymap = Keymap(layout_dir / "keymap.c")
+    exceptions = spec.get("exceptions", [])
+
+    bits, ctype, read = next((t for t in MASK_TYPES if t[0] >= len(exceptions)), (None,) * 3)
+    if bits is None:
+        raise SpecError("more than 32 exceptions")
+
+    classes = [c.strip("'") for c in keymap.layout_array("chordal_hold_layout")]
+    if len(classes) != keymap.key_count or not set(classes) <= set(HANDS):
+        raise SpecError("chordal_hold_layout must give 'L', 'R' or '*' for every key")
+    hands = [HANDS[c] for c in classes]
+    for key in set().union(*(positions_of(e, keymap) for e in spec.get("either_hand", []))):
+        hands[key] = 0
+
+    tap_hold = [0] * keymap.key_count
+    other = [0] * keymap.key_count
+    legend = []
+    for i, exception in enumerate(exceptions):
+        for key in set().union(*(positions_of(e, keymap) for e in exception["tap_hold"])):
+            if not any(is_tap_hold(keymap.expand(layer[key])) for layer in keymap.layers):
+                raise SpecError("%s: key %d is not a tap-hold key" % (exception["name"], key))
+            tap_hold[key] |= 1 << i
+        for key in set().union(*(positions_of(e, keymap) for e in exception["other"])):
+            other[key] |= 1 << i
+        legend.append("// Bit %d: %s" % (i, exception["name"]))
+
+    row_lengths = ROW_LENGTHS.get(keymap.key_count, [keymap.key_count])
+
+    def table(masks, bits=bits):
+        values = ["0x%0*X" % (bits // 4, m) if m else "0" for m in masks]
+        return format_layout(keymap.layout_macro, values, row_lengths, "  ", 2 + bits // 4 + 2)
+
+    header = HEADER.format(layout=layout_dir.name, count=len(exceptions), ctype=ctype, read=read)
+    source = SOURCE.format(
+        legend="\n".join(legend),
+        hands=table(hands, 8),
+        tap_hold=table(tap_hold),
+        other=table(other),
+    )
+    return {layout_dir / "chord_exceptions.h": header, layout_dir / "chord_exceptions.c": source}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("layouts", nargs="+", help="layout directories")
+    parser.add_argument(
+        "--check", action="store_true", help="fail if the generated files are out of date"
+    )
+    args = parser.parse_args()
+
+    stale = []
+    for layout in args.layouts:
+        try:
+            outputs = generate(layout)
+        except (SpecError, KeyError, ValueError, OSError) as e:
+            sys.exit("%s: %s" % (layout, e))
+        for path, text in outputs.items():
+            if path.exists() and path.read_text() == text:
+                continue
+            if args.check:
+                stale.append(str(path))
+            else:
+                path.write_text(text)
+                print("wrote %s" % path)
+    if stale:
+        sys.exit("out of date, run tools/gen_chord_exceptions.py: %s" % ", ".join(stale))
+
+
+if __name__ == "__main__":
+    main()
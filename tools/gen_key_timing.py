@@ -0,0 +1,254 @@
+#!/usr/bin/env python3
+"""Generates the per-key timing tables of a layout.
+
+Reads <layout>/key_timing.json and <layout>/keymap.c, and writes
+<layout>/key_timing.h and <layout>/key_timing.c: a table of distinct timing
+profiles, and a PROGMEM map from (layer, row, col) to a profile index, laid
+out with the keymap's own LAYOUT macro so the C preprocessor does the
+matrix mapping.
+
+key_timing.json:
+
+    {
+      "includes": ["achordion.h"],              # extra headers for the values
+      "defaults": {"tapping_term": "TAPPING_TERM", ...},
+      "keys": {"KC_GRAVE": {"tapping_term": "TAPPING_TERM - 70"}, ...},
+      "positions": [{"layer": 1, "key": 44, "tapping_term": 150}, ...]
+    }
+
+`defaults` lists every parameter and its value; values are C expressions.
+`keys` overrides them by keycode, spelled as in keymap.c or with its
+#define expanded. `positions` overrides them for one key on one layer, `key`
+being the index in LAYOUT order. Transparent keys are marked as such in the
+map, and take the timing of the key below them on the layer QMK takes their
+keycode from.
+
+Usage: gen_key_timing.py LAYOUT_DIR... [--check]
+"""
+
+import argparse
+import json
+import sys
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+from qmk_keymap import Keymap, ROW_LENGTHS, format_layout, normalize  # noqa: E402
+
+# C type and PROGMEM reader of each parameter; the rest are uint16_t.
+FIELD_TYPES = {
+    "achordion_settle_policy": ("uint8_t", "pgm_read_byte"),
+}
+DEFAULT_TYPE = ("uint16_t", "pgm_read_word")
+
+# Map entry of a transparent key, KEY_TIMING_TRANSPARENT
+TRANSPARENT = 0xFF
+
+HEADER = """\
+// key_timing.h — Per-key timing tables
+//
+// Generated by tools/gen_key_timing.py from key_timing.json and keymap.c.
+// Do not edit: change key_timing.json and run
+//   python3 tools/gen_key_timing.py {layout}
+
+#pragma once
+
+#include "quantum.h"
+
+#define KEY_TIMING_LAYERS {layers}
+{has}
+
+// Map entry of a transparent key
+#define KEY_TIMING_TRANSPARENT 0xFF
+
+typedef struct {{
+{fields}
+}} key_timing_t;
+
+extern const key_timing_t key_timing_profiles[] PROGMEM;
+extern const uint8_t key_timing_map[KEY_TIMING_LAYERS][MATRIX_ROWS][MATRIX_COLS] PROGMEM;
+
+// Timing of the key of `event` on the layer its keycode comes from, like
+// QMK's get_event_keycode(): for a press the highest active layer where it is
+// not transparent, for a release the layer its press took it from, however
+// the layers have changed since. Positions outside the matrix, like combos,
+// get the defaults.
+static inline const key_timing_t* key_timing_get(keyevent_t event) {{
+  const keypos_t key = event.key;
+  if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {{
+    return &key_timing_profiles[0];
+  }}
+#if !defined(NO_ACTION_LAYER) && !defined(STRICT_LAYER_RELEASE)
+  const uint8_t layer = event.pressed ? layer_switch_get_layer(key) : read_source_layers_cache(key);
+#else
+  const uint8_t layer = layer_switch_get_layer(key);
+#endif
+  uint8_t profile = KEY_TIMING_TRANSPARENT;
+  if (layer < KEY_TIMING_LAYERS) {{
+    profile = pgm_read_byte(&key_timing_map[layer][key.row][key.col]);
+  }}
+  if (profile == KEY_TIMING_TRANSPARENT) {{
+    profile = pgm_read_byte(&key_timing_map[0][key.row][key.col]);
+  }}
+  return &key_timing_profiles[profile];
+}}
+{accessors}"""
+
+ACCESSOR = """
+static inline {ctype} key_timing_{name}(keyevent_t event) {{
+  return {read}(&key_timing_get(event)->{name});
+}}
+"""
+
+SOURCE = """\
+// key_timing.c — Per-key timing tables
+//
+// Generated by tools/gen_key_timing.py from key_timing.json and keymap.c.
+// Do not edit.
+
+#include "key_timing.h"
+{includes}
+const key_timing_t key_timing_profiles[] PROGMEM = {{
+{profiles}
+}};
+
+// Profile of every key, KEY_TIMING_TRANSPARENT (255) where it is transparent
+const uint8_t key_timing_map[KEY_TIMING_LAYERS][MATRIX_ROWS][MATRIX_COLS] PROGMEM = {{
+{layers}
+}};
+"""
+
+
+class SpecError(Exception):
+    pass
+
+
+def resolve(spec, keymap):
+    """Returns the list of profiles (value tuples, defaults first), their
+    users for comments, and the profile index of every key on every layer."""
+    fields = list(spec["defaults"])
+    defaults = spec["defaults"]
+
+    by_keycode = {}
+    for keycode, values in spec.get("keys", {}).items():
+        unknown = set(values) - set(fields)
+        if unknown:
+            raise SpecError("%s: unknown parameters %s" % (keycode, sorted(unknown)))
+        by_keycode[normalize(keycode)] = values
+
+    by_position = {}
+    for entry in spec.get("positions", []):
+        entry = dict(entry)
+        layer, key = entry.pop("layer"), entry.pop("key")
+        if not (0 <= layer < len(keymap.layers) and 0 <= key < keymap.key_count):
+            raise SpecError("position %d/%d is not in the keymap" % (layer, key))
+        unknown = set(entry) - set(fields)
+        if unknown:
+            raise SpecError("position %d/%d: unknown parameters %s" % (layer, key, sorted(unknown)))
+        by_position[(layer, key)] = entry
+
+    profiles = [tuple(str(defaults[f]) for f in fields)]
+    users = [["defaults"]]
+
+    def profile_of(values, user):
+        merged = tuple(str(values.get(f, defaults[f])) for f in fields)
+        if merged not in profiles:
+            profiles.append(merged)
+            users.append([])
+        i = profiles.index(merged)
+        if i and user not in users[i]:
+            users[i].append(user)
+        return i
+
+    used_keycodes = set()
+    table = []
+    for layer, keycodes in enumerate(keymap.layers):
+        row = []
+        for key, keycode in enumerate(keycodes):
+            if (layer, key) in by_position:
+                values = dict(by_keycode.get(keycode, {}))
+                values.update(by_position[(layer, key)])
+                row.append(profile_of(values, "%s on layer %d" % (keycode, layer)))
+            elif layer > 0 and keymap.is_transparent(keycode):
+                row.append(TRANSPARENT)
+            else:
+                match = keycode if keycode in by_keycode else keymap.expand(keycode)
+                values = by_keycode.get(match)
+                if values is not None:
+                    used_keycodes.add(match)
+                row.append(profile_of(values, keycode) if values else 0)
+        table.append(row)
+
+    unused = set(by_keycode) - used_keycodes
+    if unused:
+        raise SpecError("keys not in the keymap: %s" % ", ".join(sorted(unused)))
+    if len(profiles) > TRANSPARENT:
+        raise SpecError("more than %d distinct timing profiles" % TRANSPARENT)
+    return fields, profiles, users, table
+
+
+def generate(layout_dir):
+    layout_dir = Path(layout_dir)
+    spec = json.loads((layout_dir / "key_timing.json").read_text())
+    keymap = Keymap(layout_dir / "keymap.c")
+    fields, profiles, users, table = resolve(spec, keymap)
+    row_lengths = ROW_LENGTHS.get(keymap.key_count, [keymap.key_count])
+
+    types = {f: FIELD_TYPES.get(f, DEFAULT_TYPE) for f in fields}
+    header = HEADER.format(
+        layout=layout_dir.name,
+        layers=len(table),
+        has="\n".join("#define KEY_TIMING_HAS_%s" % f.upper() for f in fields),
+        fields="\n".join("  %s %s;" % (types[f][0], f) for f in fields),
+        accessors="".join(
+            ACCESSOR.format(ctype=types[f][0], read=types[f][1], name=f) for f in fields
+        ),
+    )
+
+    profile_lines = []
+    for i, (values, who) in enumerate(zip(profiles, users)):
+        shown = ", ".join(who[:4]) + (", ..." if len(who) > 4 else "")
+        profile_lines.append("  // %d: %s" % (i, shown))
+        profile_lines.append(
+            "  {%s}," % ", ".join(".%s = %s" % (f, v) for f, v in zip(fields, values))
+        )
+
+    layer_lines = [
+        "  [%d] = %s," % (i, format_layout(keymap.layout_macro, row, row_lengths))
+        for i, row in enumerate(table)
+    ]
+    source = SOURCE.format(
+        includes="".join('#include "%s"\n' % h for h in spec.get("includes", [])),
+        profiles="\n".join(profile_lines),
+        layers="\n".join(layer_lines),
+    )
+    return {layout_dir / "key_timing.h": header, layout_dir / "key_timing.c": source}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("layouts", nargs="+", help="layout directories")
+    parser.add_argument(
+        "--check", action="store_true", help="fail if the generated files are out of date"
+    )
+    args = parser.parse_args()
+
+    stale = []
+    for layout in args.layouts:
+        try:
+            outputs = generate(layout)
+        except (SpecError, KeyError, ValueError, OSError) as e:
+            sys.exit("%s: %s" % (layout, e))
+        for path, text in outputs.items():
+            if path.exists() and path.read_text() == text:
+                continue
+            if args.check:
+                stale.append(str(path))
+            else:
+                path.write_text(text)
+                print("wrote %s" % path)
+    if stale:
+        sys.exit("out of date, run tools/gen_key_timing.py: %s" % ", ".join(stale))
+
+
+if __name__ == "__main__":
+    main()
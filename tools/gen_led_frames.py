@@ -0,0 +1,470 @@
+#!/usr/bin/env python3
+"""Generates the RGB frames of a layout's layer LEDs.
+
+Reads the `ledmap` Oryx writes into <layout>/keymap.c, one HSV color per LED
+per layer, or <layout>/ledmap.json where keymap.c no longer carries it, and
+writes <layout>/led_frames.h and <layout>/led_frames.c: every
+layer converted to RGB at full brightness with QMK's own integer
+hsv_to_rgb(), so the keyboard only has to scale a frame to the current
+brightness, once per layer or brightness change, instead of converting
+every LED of every frame with float math.
+
+The frames are stored compressed: a palette of every color the layers use,
+each layer either as one 4-bit palette index per LED, or, when few of its
+LEDs are lit, as a list of the lit LEDs and their indices, whichever is
+smaller. Indices take a byte when the palette outgrows 4 bits. Decoding a
+layer scales the palette once and is one step per LED.
+
+led_frames_indicators() paints them for rgb_matrix_indicators_user(),
+working out what to show only when the layers, the brightness or the layer
+LED toggle change. Active layers are composited the way keys are looked
+up: each LED shows the highest active layer that defines it, one whose key
+there is not transparent or whose ledmap gives it a color, from per-layer
+masks of defined LEDs.
+
+ledmap.json holds the same colors by layer:
+
+    {"0": [[169, 255, 255], [87, 255, 255], ...], "1": [...]}
+
+Usage: gen_led_frames.py LAYOUT_DIR... [--check]
+"""
+
+import argparse
+import json
+import sys
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+from qmk_keymap import LEDS, Keymap  # noqa: E402
+
+HEADER = """\
+// led_frames.h — RGB frames of the layer LEDs
+//
+// Generated by tools/gen_led_frames.py from the ledmap in keymap.c or
+// ledmap.json.
+// Do not edit: change the ledmap and run
+//   python3 tools/gen_led_frames.py {layout}
+
+#pragma once
+
+#include "quantum.h"
+
+#define LED_FRAMES_LAYERS {layers}
+// Layers the ledmap has a frame for, one bit each
+#define LED_FRAMES_MASK {mask:#x}
+
+static inline bool led_frames_has(uint8_t layer) {{
+  return layer < LED_FRAMES_LAYERS && (LED_FRAMES_MASK >> layer) & 1;
+}}
+
+// The frame of `layer` at brightness rgb_matrix_config.hsv.v. Scaled on the
+// first call after the layer or the brightness changes, then cached.
+const RGB* led_frames_get(uint8_t layer);
+
+// The active layers of `state` composited, at brightness
+// rgb_matrix_config.hsv.v: each LED from the highest layer that defines it,
+// off where none does. Cached like led_frames_get(), keyed on all of `state`.
+const RGB* led_frames_composite(layer_state_t state);
+
+// Scales every byte x of `bytes` to x * value / 255, rounded down. The words
+// path does four bytes at a time, two per 32-bit multiply in 16-bit lanes,
+// with the Cortex-M4's SIMD extract and add where it has them; the bytes
+// path is for AVR, where 32-bit multiplies are slow. LED_SCALE_WORDS picks
+// which of them led_frames_scale() is: the words path everywhere but AVR.
+void led_frames_scale_bytes(uint8_t* bytes, uint16_t length, uint8_t value);
+void led_frames_scale_words(uint8_t* bytes, uint16_t length, uint8_t value);
+
+#if !defined(LED_SCALE_WORDS) && defined(__AVR__)
+#define LED_SCALE_WORDS 0
+#elif !defined(LED_SCALE_WORDS)
+#define LED_SCALE_WORDS 1
+#endif
+#if LED_SCALE_WORDS
+#define led_frames_scale led_frames_scale_words
+#else
+#define led_frames_scale led_frames_scale_bytes
+#endif
+
+// Marks what the indicators show as stale. Call on every layer change, from
+// layer_state_set_user() and default_layer_state_set_user().
+void led_frames_invalidate(void);
+
+// Paints the active layers composited, or turns every LED off when none of
+// them has a frame or the layer LEDs are disabled and the RGB flags are
+// LED_FLAG_NONE. Which of these is worked out again only after
+// led_frames_invalidate() or a change of brightness, layer LED toggle or
+// flags; any other frame replays it.
+void led_frames_indicators(void);
+"""
+
+SOURCE = """\
+// led_frames.c — RGB frames of the layer LEDs
+//
+// Generated by tools/gen_led_frames.py from the ledmap in keymap.c or
+// ledmap.json.
+// Do not edit.
+
+#include QMK_KEYBOARD_H
+#include "led_frames.h"
+#ifdef __ARM_FEATURE_SIMD32
+#include <arm_acle.h>
+#endif
+
+// Every color of the layers at full brightness; index 0 is off.
+#define LED_PALETTE_SIZE {palette_size}
+#define LED_INDEX_BITS {index_bits}
+
+static const RGB led_palette[LED_PALETTE_SIZE] PROGMEM = {{
+{palette}
+}};
+
+// A layer in led_layer_data: `lit` (LED, palette index) pairs, or one index
+// per LED when `lit` is LED_LAYER_DENSE
+#define LED_LAYER_DENSE UINT8_MAX
+
+typedef struct {{
+  uint16_t offset;
+  uint8_t lit;
+}} led_layer_t;
+
+static const led_layer_t led_layers[LED_FRAMES_LAYERS] PROGMEM = {{
+{layers}
+}};
+
+static const uint8_t led_layer_data[] PROGMEM = {{
+{data}
+}};
+
+// LEDs each layer defines, bit i of word w for LED 32 * w + i: its key is not
+// transparent, or the ledmap gives it a color
+#define LED_WORDS ((RGB_MATRIX_LED_COUNT + 31) / 32)
+
+static const uint32_t led_defined[LED_FRAMES_LAYERS][LED_WORDS] PROGMEM = {{
+{defined}
+}};
+
+static const uint32_t led_all[LED_WORDS] = {{{all}}};
+
+static RGB frame[RGB_MATRIX_LED_COUNT];
+static layer_state_t frame_layers = 0;  // Layers in `frame`, none at first
+static bool frame_composite = false;
+static uint8_t frame_value = 0;
+
+// x * value / 255, rounded down as the float scaling it replaces, without a
+// division
+static inline uint8_t scale(uint8_t x, uint8_t value) {{
+  const uint16_t product = (uint16_t)x * value;
+  return (product + 1 + (product >> 8)) >> 8;
+}}
+
+void led_frames_scale_bytes(uint8_t* bytes, uint16_t length, uint8_t value) {{
+  for (uint16_t i = 0; i < length; ++i) {{
+    bytes[i] = scale(bytes[i], value);
+  }}
+}}
+
+// Bytes 0 and 2 of x as 16-bit lanes; a + those lanes
+#ifdef __ARM_FEATURE_SIMD32
+#define UXTB16(x) __uxtb16(x)
+#define UXTAB16(a, x) __uxtab16((a), (x))
+#else
+#define UXTB16(x) ((x) & 0x00FF00FFu)
+#define UXTAB16(a, x) ((a) + UXTB16(x))
+#endif
+
+// scale() of the four bytes of `word`. A lane holds at most
+// 255 * 255 + 1 + 254 < 2^16, so no lane carries into the next and no
+// saturation is needed.
+static inline uint32_t scale_word(uint32_t word, uint32_t value) {{
+  const uint32_t even = UXTB16(word) * value + 0x00010001u;
+  const uint32_t odd = UXTB16(word >> 8) * value + 0x00010001u;
+  const uint32_t even_scaled = UXTAB16(even, even >> 8);
+  const uint32_t odd_scaled = UXTAB16(odd, odd >> 8);
+  return ((even_scaled >> 8) & 0x00FF00FFu) | (odd_scaled & 0xFF00FF00u);
+}}
+
+void led_frames_scale_words(uint8_t* bytes, uint16_t length, uint8_t value) {{
+  uint16_t i = 0;
+  for (; i + 4 <= length; i += 4) {{
+    uint32_t word;
+    memcpy(&word, &bytes[i], sizeof(word));
+    word = scale_word(word, value);
+    memcpy(&bytes[i], &word, sizeof(word));
+  }}
+  for (; i < length; ++i) {{
+    bytes[i] = scale(bytes[i], value);
+  }}
+}}
+
+// The palette index of LED `i` of a dense layer
+static inline uint8_t dense_index(const uint8_t* data, uint8_t i) {{
+#if LED_INDEX_BITS == 4
+  return (pgm_read_byte(&data[i >> 1]) >> ((i & 1) << 2)) & 0x0F;
+#else
+  return pgm_read_byte(&data[i]);
+#endif
+}}
+
+// `palette` at `value`
+static void scale_palette(RGB palette[LED_PALETTE_SIZE], uint8_t value) {{
+  const uint8_t* source = (const uint8_t*)led_palette;
+  uint8_t* target = (uint8_t*)palette;
+  for (uint8_t i = 0; i < LED_PALETTE_SIZE * sizeof(RGB); ++i) {{
+    target[i] = pgm_read_byte(&source[i]);
+  }}
+  led_frames_scale(target, LED_PALETTE_SIZE * sizeof(RGB), value);
+}}
+
+// Sets the LEDs of `take` in `frame` to their colors on `layer`. The LEDs of
+// `take` must be off before.
+static void paint_layer(uint8_t layer, const RGB* palette, const uint32_t take[LED_WORDS]) {{
+  const uint8_t* data = &led_layer_data[pgm_read_word(&led_layers[layer].offset)];
+  const uint8_t lit = pgm_read_byte(&led_layers[layer].lit);
+  if (lit == LED_LAYER_DENSE) {{
+    for (uint8_t w = 0; w < LED_WORDS; ++w) {{
+      for (uint32_t bits = take[w]; bits != 0; bits &= bits - 1) {{
+        const uint8_t i = w * 32 + __builtin_ctzl(bits);
+        frame[i] = palette[dense_index(data, i)];
+      }}
+    }}
+  }} else {{
+    for (uint8_t j = 0; j < lit; ++j) {{
+      const uint8_t i = pgm_read_byte(&data[2 * j]);
+      if ((take[i >> 5] >> (i & 31)) & 1) {{
+        frame[i] = palette[pgm_read_byte(&data[2 * j + 1])];
+      }}
+    }}
+  }}
+}}
+
+const RGB* led_frames_get(uint8_t layer) {{
+  const uint8_t value = rgb_matrix_config.hsv.v;
+  const layer_state_t layers = (layer_state_t)1 << layer;
+  if (layers != frame_layers || frame_composite || value != frame_value) {{
+    RGB palette[LED_PALETTE_SIZE];
+    scale_palette(palette, value);
+    memset(frame, 0, sizeof(frame));
+    paint_layer(layer, palette, led_all);
+    frame_layers = layers;
+    frame_composite = false;
+    frame_value = value;
+  }}
+  return frame;
+}}
+
+const RGB* led_frames_composite(layer_state_t state) {{
+  const uint8_t value = rgb_matrix_config.hsv.v;
+  if (state != frame_layers || !frame_composite || value != frame_value) {{
+    RGB palette[LED_PALETTE_SIZE];
+    scale_palette(palette, value);
+    memset(frame, 0, sizeof(frame));
+
+    // Highest layer first: each takes the LEDs it defines that no layer
+    // above it took.
+    uint32_t taken[LED_WORDS] = {{0}};
+    for (layer_state_t layers = state & LED_FRAMES_MASK; layers != 0;) {{
+      const uint8_t layer = biton32(layers);
+      layers &= ~((layer_state_t)1 << layer);
+      uint32_t take[LED_WORDS];
+      uint32_t any = 0;
+      for (uint8_t w = 0; w < LED_WORDS; ++w) {{
+        take[w] = pgm_read_dword(&led_defined[layer][w]) & ~taken[w];
+        taken[w] |= take[w];
+        any |= take[w];
+      }}
+      if (any != 0) {{
+        paint_layer(layer, palette, take);
+      }}
+    }}
+    frame_layers = state;
+    frame_composite = true;
+    frame_value = value;
+  }}
+  return frame;
+}}
+
+// What led_frames_indicators() paints until something it depends on changes
+static enum {{ SHOW_NOTHING, SHOW_FRAME, SHOW_OFF }} shown = SHOW_NOTHING;
+static bool shown_valid = false;
+static layer_state_t shown_layers = 0;
+static uint8_t shown_value = 0;
+static bool shown_disabled = false;
+static led_flags_t shown_flags = LED_FLAG_NONE;
+
+void led_frames_invalidate(void) {{
+  shown_valid = false;
+}}
+
+void led_frames_indicators(void) {{
+  const uint8_t value = rgb_matrix_config.hsv.v;
+  const bool disabled = keyboard_config.disable_layer_led;
+  const led_flags_t flags = rgb_matrix_get_flags();
+  if (!shown_valid || value != shown_value || disabled != shown_disabled || flags != shown_flags) {{
+    shown_layers = layer_state | default_layer_state;
+    if (!disabled && (shown_layers & LED_FRAMES_MASK) != 0) {{
+      shown = SHOW_FRAME;
+    }} else {{
+      shown = flags == LED_FLAG_NONE ? SHOW_OFF : SHOW_NOTHING;
+    }}
+    shown_valid = true;
+    shown_value = value;
+    shown_disabled = disabled;
+    shown_flags = flags;
+  }}
+
+  // The RGB effect repaints every LED before the indicators, so even an
+  // unchanged frame has to be set again.
+  if (shown == SHOW_FRAME) {{
+    const RGB* frame = led_frames_composite(shown_layers);
+    for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; ++i) {{
+      rgb_matrix_set_color(i, frame[i].r, frame[i].g, frame[i].b);
+    }}
+  }} else if (shown == SHOW_OFF) {{
+    rgb_matrix_set_color_all(0, 0, 0);
+  }}
+}}
+"""
+
+
+def hsv_to_rgb(h, s, v):
+    """QMK's color.c hsv_to_rgb(), with its 8-bit wraparound."""
+    if s == 0:
+        return v, v, v
+    region = h * 6 // 255
+    remainder = ((h * 2 - region * 85) * 3) & 0xFF
+    p = (v * (255 - s)) >> 8
+    q = (v * (255 - ((s * remainder) >> 8))) >> 8
+    t = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8
+    return {
+        0: (v, t, p),
+        1: (q, v, p),
+        2: (p, v, t),
+        3: (p, q, v),
+        4: (t, p, v),
+        6: (v, t, p),
+    }.get(region, (v, p, q))
+
+
+def rows(values, per_row, indent="  "):
+    """C initializer lines of `values`, `per_row` to a line."""
+    return [indent + " ".join(values[i : i + per_row]) for i in range(0, len(values), per_row)]
+
+
+def encode(colors, palette, index_bits):
+    """A layer's (lit, bytes): dense indices, or the lit LEDs if smaller."""
+    indices = [palette.index(c) for c in colors]
+    if index_bits == 4:
+        dense = [indices[i] | (indices[i + 1] if i + 1 < len(indices) else 0) << 4
+                 for i in range(0, len(indices), 2)]
+    else:
+        dense = indices
+    sparse = [b for led, index in enumerate(indices) if index for b in (led, index)]
+    if len(sparse) < len(dense):
+        return len(sparse) // 2, sparse
+    return None, dense
+
+
+def read_ledmap(layout_dir, keymap):
+    """The layout's ledmap, {layer: [(h, s, v), ...]}: Oryx's in keymap.c,
+    else ledmap.json's."""
+    try:
+        return keymap.ledmap()
+    except KeyError:
+        path = layout_dir / "ledmap.json"
+        if not path.exists():
+            raise ValueError("no ledmap in keymap.c and no %s" % path)
+    with open(path) as f:
+        layers = json.load(f)
+    return {int(layer): [tuple(hsv) for hsv in leds] for layer, leds in layers.items()}
+
+
+def generate(layout_dir):
+    layout_dir = Path(layout_dir)
+    keymap = Keymap(layout_dir / "keymap.c")
+    ledmap = read_ledmap(layout_dir, keymap)
+    if keymap.layout_macro not in LEDS:
+        raise ValueError("no LED order for %s" % keymap.layout_macro)
+    leds = LEDS[keymap.layout_macro]
+    layers = max(ledmap) + 1
+    mask = sum(1 << layer for layer in ledmap)
+
+    colors = {layer: [hsv_to_rgb(*hsv) for hsv in ledmap[layer]] for layer in ledmap}
+    palette = [(0, 0, 0)]
+    for layer in sorted(colors):
+        for color in colors[layer]:
+            if color not in palette:
+                palette.append(color)
+    if len(palette) > 256:
+        raise ValueError("%d colors do not fit a byte index" % len(palette))
+    index_bits = 4 if len(palette) <= 16 else 8
+
+    table, data, offset = [], [], 0
+    for layer in range(layers):
+        if layer not in colors:
+            table.append("  [%d] = {0, 0},  // No frame" % layer)
+            continue
+        lit, encoded = encode(colors[layer], palette, index_bits)
+        table.append("  [%d] = {%d, %s}," % (
+            layer, offset, "LED_LAYER_DENSE" if lit is None else lit))
+        data.append("  // Layer %d, %s" % (layer, "dense" if lit is None else "%d lit" % lit))
+        data += rows(["0x%02x," % b for b in encoded], 12)
+        offset += len(encoded)
+
+    count = len(leds)
+    words = (count + 31) // 32
+    defined = []
+    for layer in range(layers):
+        bits = 0
+        if layer in colors:
+            keys = keymap.layers[layer] if layer < len(keymap.layers) else []
+            for key, led in enumerate(leds):
+                if key < len(keys) and not keymap.is_transparent(keys[key]):
+                    bits |= 1 << led
+            for led, color in enumerate(colors[layer]):
+                if color != (0, 0, 0):
+                    bits |= 1 << led
+        defined.append("  [%d] = {%s}," % (layer, ", ".join(
+            "0x%08x" % (bits >> (32 * w) & 0xFFFFFFFF) for w in range(words))))
+    every = (1 << count) - 1
+
+    header = HEADER.format(layout=layout_dir.name, layers=layers, mask=mask)
+    source = SOURCE.format(
+        palette_size=len(palette),
+        index_bits=index_bits,
+        palette="\n".join(rows(["{0x%02x, 0x%02x, 0x%02x}," % c for c in palette], 4)),
+        layers="\n".join(table),
+        data="\n".join(data),
+        defined="\n".join(defined),
+        all=", ".join("0x%08x" % (every >> (32 * w) & 0xFFFFFFFF) for w in range(words)),
+    )
+    return {layout_dir / "led_frames.h": header, layout_dir / "led_frames.c": source}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("layouts", nargs="+", help="layout directories")
+    parser.add_argument(
+        "--check", action="store_true", help="fail if the generated files are out of date"
+    )
+    args = parser.parse_args()
+
+    stale = []
+    for layout in args.layouts:
+        try:
+            outputs = generate(layout)
+        except (KeyError, ValueError, OSError) as e:
+            sys.exit("%s: %s" % (layout, e))
+        for path, text in outputs.items():
+            if path.exists() and path.read_text() == text:
+                continue
+            if args.check:
+                stale.append(str(path))
+            else:
+                path.write_text(text)
+                print("wrote %s" % path)
+    if stale:
+        sys.exit("out of date, run tools/gen_led_frames.py: %s" % ", ".join(stale))
+
+
+if __name__ == "__main__":
+    main()
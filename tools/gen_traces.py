@@ -0,0 +1,385 @@
+#!/usr/bin/env python3
+"""Generates synthetic keystroke traces from text corpora and a layout's keymap.
+
+Types each corpus on the layout's actual keymap, read from <layout>/keymap.c
+(or keymap.json): every character goes to the key that produces it, on
+layer 0 when possible. Upper case and shifted symbols hold a Shift key, a
+home row mod-tap on the other hand if there is one; symbols on other layers
+hold the layer-tap or MO() key for that layer, so mod-taps and layer-taps are
+pressed as a person would, and kept held across runs of characters that need
+them. Characters the keymap cannot type are skipped and counted.
+
+Timing is sampled per keystroke: the interval to the next press follows a
+log-normal distribution scaled by the finger and by whether it is the same
+finger, the same hand or the other hand, and each key is held for a
+log-normal dwell time. A dwell longer than the next interval rolls the keys
+over, as in fast typing.
+
+The corpus is split into chunks typed in parallel, one process per core, and
+the output is written in order: a binary trace (see W7EL4/host/trace_file.h)
+if OUT ends in .ktr, the text format of host/replay otherwise. --repeat
+types the corpus again with new timings, for traces of hundreds of millions
+of events. --annotate notes on every mod-tap and layer-tap press of a text
+trace whether it was meant as `tap` or `hold`, the ground truth host/report
+checks the keyboard's decisions against.
+
+Usage: gen_traces.py LAYOUT_DIR CORPUS... -o OUT [--repeat N] [--wpm WPM]
+                     [--seed N] [--jobs N] [--annotate]
+"""
+
+import argparse
+import math
+import multiprocessing
+import os
+import random
+import struct
+import sys
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+import qmk_keycodes as kc  # noqa: E402
+from qmk_keymap import MATRIX, ROW_LENGTHS, load  # noqa: E402
+
+CHUNK_CHARS = 1 << 16
+START_TIME = 1000  # ms
+CHUNK_GAP = 1000  # ms between chunks, like a pause between paragraphs
+
+# Interval factor by finger, and dwell time mean, ms
+FINGER_SPEED = {"thumb": 0.9, "index": 0.95, "middle": 1.0, "ring": 1.1, "pinky": 1.2}
+DWELL = {"thumb": 100, "index": 85, "middle": 85, "ring": 90, "pinky": 95}
+# Interval factor by the previous key: same key, same finger, same hand,
+# other hand
+SAME_KEY, SAME_FINGER, SAME_HAND, OTHER_HAND = 1.3, 1.5, 1.0, 0.75
+SIGMA = 0.35  # Of the log-normal distributions
+HOLD_LEAD = 110  # Mean ms from a Shift or layer key press to the key it modifies
+HOLD_TAIL = 60  # Mean ms from the last modified key release to its release
+PAUSE = {"\n": 3.0, ".": 2.0, "?": 2.0, "!": 2.0, ",": 1.3}  # Interval factor after
+
+TRACE_MAGIC = b"AKTR"
+TRACE_VERSION = 1
+
+
+class KeymapError(Exception):
+    pass
+
+
+def finger_of(index, row_lengths):
+    """Finger pressing the key at LAYOUT `index`: a short last row is the
+    thumb cluster, other rows split in halves, pinky on the outside."""
+    start = 0
+    for row, n in enumerate(row_lengths):
+        if index < start + n:
+            if row == len(row_lengths) - 1 and len(row_lengths) > 1 and n <= 6:
+                return "thumb"
+            p, half = index - start, max(n // 2, 1)
+            from_edge = p if p < half else n - 1 - p
+            return ["pinky", "pinky", "ring", "middle", "index", "index"][
+                min(from_edge * 6 // half, 5)
+            ]
+        start += n
+    return "index"
+
+
+class Layout:
+    """Everything a worker needs to type on a layout; picklable."""
+
+    def __init__(self, layout_dir):
+        keymap = load(layout_dir)
+        matrix = MATRIX.get(keymap.layout_macro)
+        if matrix is None or len(matrix) != keymap.key_count:
+            raise KeymapError("no matrix positions for %s" % keymap.layout_macro)
+        row_lengths = ROW_LENGTHS.get(keymap.key_count, [keymap.key_count])
+        rows = max(r for r, _ in matrix) + 1
+        try:
+            hands = [h.strip("'") for h in keymap.layout_array("chordal_hold_layout")]
+        except KeyError:
+            hands = ["*"] * keymap.key_count
+        hands = [
+            h if h in "LR" else ("L" if matrix[i][0] < rows // 2 else "R")
+            for i, h in enumerate(hands)
+        ]
+
+        self.keys = [
+            (matrix[i][0], matrix[i][1], hands[i], finger_of(i, row_lengths))
+            for i in range(keymap.key_count)
+        ]
+        values = []
+        for layer in keymap.layers:
+            values.append(
+                [
+                    kc.value(keymap.expand(layer[i] if not keymap.is_transparent(layer[i])
+                                           else keymap.layers[0][i]))
+                    for i in range(keymap.key_count)
+                ]
+            )
+        base = values[0]
+        self.base_values = base
+        self.shift_keys = [i for i, v in enumerate(base) if kc.held_mods(v) & kc.MOD_SHIFT]
+        layer_keys = {}
+        for i, v in enumerate(base):
+            layer = kc.held_layer(v)
+            if layer is not None and 0 < layer < len(values):
+                layer_keys.setdefault(layer, []).append(i)
+        self.layer_keys = layer_keys
+
+        # char -> (key, keycode, layer, shift), cheapest first
+        best = {}
+        for layer, layer_values in enumerate(values):
+            if layer > 0 and layer not in layer_keys:
+                continue
+            for i, v in enumerate(layer_values):
+                for shift in (False, True):
+                    if shift and not self.shift_keys:
+                        continue
+                    c = kc.char_of(v, shift)
+                    if c is None or (shift and c == kc.char_of(v)):
+                        continue
+                    cost = 2 * (layer > 0) + shift
+                    if c not in best or cost < best[c][0]:
+                        best[c] = (cost, (i, v, layer, shift))
+        self.chars = {c: plan for c, (_, plan) in best.items()}
+
+
+def intent(keycode, meaning):
+    """Note for a press of `keycode` meant as `meaning`, tap or hold: only
+    tap-hold keys have one."""
+    return meaning if kc.is_mod_tap(keycode) or kc.is_layer_tap(keycode) else ""
+
+
+class Typist:
+    """Types text on a Layout, producing (time, seq, row, col, pressed,
+    keycode, note) events."""
+
+    def __init__(self, layout, wpm, rng):
+        self.layout = layout
+        self.rng = rng
+        self.interval = 60000.0 / (wpm * 5)
+        self.events = []
+        self.time = 0.0  # Of the last press
+        self.released = {}  # key -> release time
+        self.previous = None  # Last key typed
+        self.held = {}  # Holder key -> keycode
+        self.hold_end = 0.0  # Release time of the last key typed under holders
+        self.skipped = 0
+
+    def lognormal(self, mean):
+        return mean * math.exp(self.rng.gauss(0, SIGMA) - SIGMA * SIGMA / 2)
+
+    def emit(self, time, key, pressed, keycode, note=""):
+        row, col = self.layout.keys[key][:2]
+        self.events.append((int(time), len(self.events), row, col, pressed, keycode, note))
+
+    def next_press(self, key, factor=1.0):
+        if self.previous is None:
+            return self.time
+        _, _, hand, finger = self.layout.keys[key]
+        _, _, last_hand, last_finger = self.layout.keys[self.previous]
+        if key == self.previous:
+            relation = SAME_KEY
+        elif hand == last_hand and finger == last_finger:
+            relation = SAME_FINGER
+        elif hand == last_hand:
+            relation = SAME_HAND
+        else:
+            relation = OTHER_HAND
+        t = self.time + max(15.0, self.lognormal(self.interval * relation * factor * FINGER_SPEED[finger]))
+        # A key cannot go down again before it came up.
+        return max(t, self.released.get(key, -1e9) + 10)
+
+    def tap(self, key, keycode, at):
+        release = at + max(20.0, self.lognormal(DWELL[self.layout.keys[key][3]]))
+        self.emit(at, key, True, keycode, intent(keycode, "tap"))
+        self.emit(release, key, False, keycode)
+        self.time = at
+        self.released[key] = release
+        self.previous = key
+        return release
+
+    def holders_for(self, key, layer, shift):
+        """Keys to hold for `key`: the layer key and Shift, preferably on the
+        other hand, keeping the ones already held."""
+        hand = self.layout.keys[key][2]
+        wanted = []
+        for candidates in (self.layout.layer_keys.get(layer, []) if layer else [],
+                           self.layout.shift_keys if shift else []):
+            candidates = [k for k in candidates if k != key]
+            if not candidates:
+                continue
+            held = [k for k in candidates if k in self.held]
+            other = [k for k in candidates if self.layout.keys[k][2] != hand]
+            wanted.append((held or other or candidates)[0])
+        return wanted
+
+    def release_holders(self, keep=()):
+        for k in [k for k in self.held if k not in keep]:
+            at = max(self.hold_end, self.time) + self.lognormal(HOLD_TAIL)
+            self.emit(at, k, False, self.held.pop(k))
+            self.released[k] = at
+
+    def type_char(self, c, factor):
+        plan = self.layout.chars.get(c)
+        if plan is None:
+            self.skipped += 1
+            return
+        key, keycode, layer, shift = plan
+        holders = self.holders_for(key, layer, shift)
+        self.release_holders(keep=holders)
+
+        new = [k for k in holders if k not in self.held]
+        at = self.next_press(new[0] if new else key, factor)
+        for k in new:
+            v = self.layout.base_values[k]
+            self.emit(at, k, True, v, intent(v, "hold"))
+            self.held[k] = v
+            self.time, self.previous = at, k
+            at += self.lognormal(HOLD_LEAD / len(new))
+        release = self.tap(key, keycode, max(at, self.next_press(key)) if new else at)
+        if holders:
+            self.hold_end = release
+
+    def type_text(self, text):
+        """Types `text`; returns its events in time order, the first at 0."""
+        factor = 1.0
+        for c in text:
+            self.type_char(c, factor)
+            factor = PAUSE.get(c, 1.0)
+        self.release_holders()
+        self.events.sort()
+        if self.events:
+            first = self.events[0][0]
+            self.events = [(e[0] - first,) + e[1:] for e in self.events]
+        return self.events
+
+
+# ─────────────────────────────────────────────────────────────────────────────
+# Output
+# ─────────────────────────────────────────────────────────────────────────────
+
+
+def varint(word):
+    out = bytearray()
+    while True:
+        byte = word & 0x7F
+        word >>= 7
+        if word:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def encode(events):
+    """Binary records of `events`, the first with a delta of 0."""
+    out = bytearray()
+    keycodes = {}
+    last = events[0][0] if events else 0
+    for time, _, row, col, pressed, keycode, _ in events:
+        has_keycode = keycodes.get((row, col)) != keycode
+        out += varint((time - last) << 2 | has_keycode << 1 | pressed)
+        out.append(row << 4 | col)
+        if has_keycode:
+            out += struct.pack("<H", keycode)
+            keycodes[(row, col)] = keycode
+        last = time
+    return bytes(out)
+
+
+def rebase(body, delta):
+    """Sets the time delta of the first record of `body`."""
+    word, i = 0, 0
+    while True:
+        word |= (body[i] & 0x7F) << (7 * i)
+        i += 1
+        if not body[i - 1] & 0x80:
+            break
+    return varint(delta << 2 | (word & 3)) + body[i:]
+
+
+def type_chunk(task):
+    """Worker: types one chunk, returns (output, events, duration, skipped)."""
+    layout, text, wpm, seed, binary = task
+    typist = Typist(layout, wpm, random.Random(seed))
+    events = typist.type_text(text)
+    duration = events[-1][0] if events else 0
+    if binary:
+        output = encode(events)
+    else:
+        output = [(e[0], e[2], e[3], e[4], e[5], e[6]) for e in events]
+    return output, len(events), duration, typist.skipped
+
+
+def chunks_of(text):
+    """Splits `text` into chunks of about CHUNK_CHARS, at whitespace."""
+    start = 0
+    while start < len(text):
+        end = min(start + CHUNK_CHARS, len(text))
+        if end < len(text):
+            space = text.rfind(" ", start, end)
+            end = space + 1 if space > start else end
+        yield text[start:end]
+        start = end
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("layout", help="layout directory")
+    parser.add_argument("corpus", nargs="+", help="text files to type")
+    parser.add_argument("-o", "--output", required=True, help="trace to write, .ktr for binary")
+    parser.add_argument("--repeat", type=int, default=1, help="times to type the corpus")
+    parser.add_argument("--wpm", type=float, default=70, help="typing speed, words per minute")
+    parser.add_argument("--seed", type=int, default=1, help="random seed")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count(), help="worker processes")
+    parser.add_argument("--annotate", action="store_true", help="note the intent of tap-hold presses")
+    args = parser.parse_args()
+    binary = args.output.endswith(".ktr")
+    if args.annotate and binary:
+        parser.error("--annotate needs a text trace")
+
+    try:
+        layout = Layout(args.layout)
+        text = "".join(Path(c).read_text() for c in args.corpus)
+    except (KeymapError, KeyError, ValueError, OSError) as e:
+        sys.exit("%s: %s" % (args.layout, e))
+    chunks = list(chunks_of(text))
+    tasks = (
+        (layout, chunk, args.wpm, args.seed * 1000003 + n * len(chunks) + i, binary)
+        for n in range(args.repeat)
+        for i, chunk in enumerate(chunks)
+    )
+
+    total = skipped = 0
+    time = START_TIME
+    with open(args.output, "wb") as out, multiprocessing.Pool(args.jobs) as pool:
+        if binary:
+            out.write(TRACE_MAGIC + struct.pack("<BBHII", TRACE_VERSION, 0, 0, 0, START_TIME))
+        for output, events, duration, chunk_skipped in pool.imap(type_chunk, tasks):
+            skipped += chunk_skipped
+            if not events:
+                continue
+            if binary:
+                out.write(rebase(output, time - START_TIME if total == 0 else CHUNK_GAP))
+            else:
+                out.write(
+                    "".join(
+                        "%d %d %d %s 0x%04X%s\n"
+                        % (time + t, row, col, "d" if pressed else "u", keycode,
+                           " " + note if note and args.annotate else "")
+                        for t, row, col, pressed, keycode, note in output
+                    ).encode()
+                )
+            total += events
+            time += duration + CHUNK_GAP
+            if time > 0xFFFFFFFF:
+                time &= 0xFFFFFFFF  # The harness clock wraps, like the keyboard's
+        if binary:
+            out.seek(8)
+            out.write(struct.pack("<I", total))
+
+    print(
+        "wrote %s: %d events, %d characters skipped" % (args.output, total, skipped),
+        file=sys.stderr,
+    )
+
+
+if __name__ == "__main__":
+    main()
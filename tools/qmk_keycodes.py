@@ -0,0 +1,176 @@
+"""Numeric values of QMK keycode expressions, and the characters they type.
+
+Covers what the keymaps in this repository use for typing: basic keycodes
+and their aliases, modifier wrappers such as LSFT(), mod-taps, layer-taps,
+MO() and TD(). Values follow QMK's keycodes.h; anything else is None.
+"""
+
+import re
+
+from qmk_keymap import split_args
+
+# Basic keycodes, HID usage ids
+BASIC = {"KC_NO": 0x00, "KC_TRANSPARENT": 0x01}
+BASIC.update({"KC_%s" % chr(ord("A") + i): 0x04 + i for i in range(26)})
+BASIC.update({"KC_%d" % ((i + 1) % 10): 0x1E + i for i in range(10)})
+BASIC.update({"KC_F%d" % (i + 1): 0x3A + i for i in range(12)})
+BASIC.update({"KC_F%d" % (i + 13): 0x68 + i for i in range(12)})
+BASIC.update({"KC_KP_%d" % ((i + 1) % 10): 0x59 + i for i in range(10)})
+BASIC.update(
+    {
+        "KC_ENTER": 0x28, "KC_ESCAPE": 0x29, "KC_BACKSPACE": 0x2A, "KC_TAB": 0x2B,
+        "KC_SPACE": 0x2C, "KC_MINUS": 0x2D, "KC_EQUAL": 0x2E, "KC_LEFT_BRACKET": 0x2F,
+        "KC_RIGHT_BRACKET": 0x30, "KC_BACKSLASH": 0x31, "KC_SEMICOLON": 0x33,
+        "KC_QUOTE": 0x34, "KC_GRAVE": 0x35, "KC_COMMA": 0x36, "KC_DOT": 0x37,
+        "KC_SLASH": 0x38, "KC_CAPS_LOCK": 0x39, "KC_DELETE": 0x4C, "KC_RIGHT": 0x4F,
+        "KC_LEFT": 0x50, "KC_DOWN": 0x51, "KC_UP": 0x52, "KC_KP_SLASH": 0x54,
+        "KC_KP_ASTERISK": 0x55, "KC_KP_MINUS": 0x56, "KC_KP_PLUS": 0x57,
+        "KC_KP_ENTER": 0x58, "KC_KP_DOT": 0x63, "KC_KP_EQUAL": 0x67,
+        "KC_LEFT_CTRL": 0xE0, "KC_LEFT_SHIFT": 0xE1, "KC_LEFT_ALT": 0xE2,
+        "KC_LEFT_GUI": 0xE3, "KC_RIGHT_CTRL": 0xE4, "KC_RIGHT_SHIFT": 0xE5,
+        "KC_RIGHT_ALT": 0xE6, "KC_RIGHT_GUI": 0xE7,
+    }
+)
+
+ALIASES = {
+    "KC_ENT": "KC_ENTER", "KC_ESC": "KC_ESCAPE", "KC_BSPC": "KC_BACKSPACE",
+    "KC_SPC": "KC_SPACE", "KC_MINS": "KC_MINUS", "KC_EQL": "KC_EQUAL",
+    "KC_LBRC": "KC_LEFT_BRACKET", "KC_RBRC": "KC_RIGHT_BRACKET",
+    "KC_BSLS": "KC_BACKSLASH", "KC_SCLN": "KC_SEMICOLON", "KC_QUOT": "KC_QUOTE",
+    "KC_GRV": "KC_GRAVE", "KC_COMM": "KC_COMMA", "KC_SLSH": "KC_SLASH",
+    "KC_CAPS": "KC_CAPS_LOCK", "KC_DEL": "KC_DELETE", "KC_TRNS": "KC_TRANSPARENT",
+    "_______": "KC_TRANSPARENT", "XXXXXXX": "KC_NO",
+    "KC_LCTL": "KC_LEFT_CTRL", "KC_LSFT": "KC_LEFT_SHIFT", "KC_LALT": "KC_LEFT_ALT",
+    "KC_LGUI": "KC_LEFT_GUI", "KC_RCTL": "KC_RIGHT_CTRL", "KC_RSFT": "KC_RIGHT_SHIFT",
+    "KC_RALT": "KC_RIGHT_ALT", "KC_RGUI": "KC_RIGHT_GUI",
+    "KC_PSLS": "KC_KP_SLASH", "KC_PAST": "KC_KP_ASTERISK", "KC_PMNS": "KC_KP_MINUS",
+    "KC_PPLS": "KC_KP_PLUS", "KC_PEQL": "KC_KP_EQUAL",
+}
+
+# Shifted aliases, e.g. KC_LPRN = LSFT(KC_9)
+SHIFTED = {
+    "KC_TILD": "KC_GRAVE", "KC_EXLM": "KC_1", "KC_AT": "KC_2", "KC_HASH": "KC_3",
+    "KC_DLR": "KC_4", "KC_PERC": "KC_5", "KC_CIRC": "KC_6", "KC_AMPR": "KC_7",
+    "KC_ASTR": "KC_8", "KC_LPRN": "KC_9", "KC_RPRN": "KC_0", "KC_UNDS": "KC_MINUS",
+    "KC_PLUS": "KC_EQUAL", "KC_LCBR": "KC_LEFT_BRACKET", "KC_RCBR": "KC_RIGHT_BRACKET",
+    "KC_PIPE": "KC_BACKSLASH", "KC_COLN": "KC_SEMICOLON", "KC_DQUO": "KC_QUOTE",
+    "KC_LABK": "KC_COMMA", "KC_RABK": "KC_DOT", "KC_QUES": "KC_SLASH",
+}
+
+MOD_BITS = {
+    "MOD_LCTL": 0x01, "MOD_LSFT": 0x02, "MOD_LALT": 0x04, "MOD_LGUI": 0x08,
+    "MOD_RCTL": 0x11, "MOD_RSFT": 0x12, "MOD_RALT": 0x14, "MOD_RGUI": 0x18,
+    "MOD_MEH": 0x07, "MOD_HYPR": 0x0F,
+}
+MOD_SHIFT = 0x02
+
+# Modifier wrappers, as the mod bits they add to the keycode's high byte
+WRAPPERS = {
+    "LCTL": 0x01, "LSFT": 0x02, "LALT": 0x04, "LGUI": 0x08, "S": 0x02,
+    "RCTL": 0x11, "RSFT": 0x12, "RALT": 0x14, "RGUI": 0x18,
+}
+
+QK_MOD_TAP = 0x2000
+QK_LAYER_TAP = 0x4000
+QK_MOMENTARY = 0x5220
+QK_TAP_DANCE = 0x5700
+
+# Characters typed by basic keycodes: (unshifted, shifted)
+CHARS = {
+    "KC_SPACE": (" ", " "), "KC_ENTER": ("\n", "\n"), "KC_TAB": ("\t", "\t"),
+    "KC_MINUS": ("-", "_"), "KC_EQUAL": ("=", "+"), "KC_LEFT_BRACKET": ("[", "{"),
+    "KC_RIGHT_BRACKET": ("]", "}"), "KC_BACKSLASH": ("\\", "|"),
+    "KC_SEMICOLON": (";", ":"), "KC_QUOTE": ("'", '"'), "KC_GRAVE": ("`", "~"),
+    "KC_COMMA": (",", "<"), "KC_DOT": (".", ">"), "KC_SLASH": ("/", "?"),
+    "KC_KP_SLASH": ("/", "/"), "KC_KP_ASTERISK": ("*", "*"), "KC_KP_MINUS": ("-", "-"),
+    "KC_KP_PLUS": ("+", "+"), "KC_KP_EQUAL": ("=", "="), "KC_KP_DOT": (".", "."),
+}
+CHARS.update({"KC_%s" % chr(ord("A") + i): (chr(ord("a") + i), chr(ord("A") + i)) for i in range(26)})
+CHARS.update({"KC_%d" % d: (str(d), s) for d, s in zip(range(10), ")!@#$%^&*(")})
+CHARS.update({"KC_KP_%d" % d: (str(d), str(d)) for d in range(10)})
+_CHARS_BY_VALUE = {BASIC[k]: v for k, v in CHARS.items()}
+
+_CALL = re.compile(r"^(\w+)\((.*)\)$")
+
+
+def value(keycode):
+    """Returns the 16-bit value of a keycode expression, or None."""
+    keycode = ALIASES.get(keycode, keycode)
+    if keycode in BASIC:
+        return BASIC[keycode]
+    if keycode in SHIFTED:
+        return MOD_SHIFT << 8 | BASIC[SHIFTED[keycode]]
+    if re.match(r"^(0x[0-9A-Fa-f]+|\d+)$", keycode):
+        return int(keycode, 0)
+    m = _CALL.match(keycode)
+    if not m:
+        return None
+    name, args = m.group(1), split_args(m.group(2))
+    inner = [value(a) for a in args]
+    if name in WRAPPERS and len(args) == 1 and inner[0] is not None:
+        return inner[0] | WRAPPERS[name] << 8
+    if name == "MT" and len(args) == 2 and inner[1] is not None:
+        mods = mods_of(args[0])
+        return None if mods is None else QK_MOD_TAP | (mods & 0x1F) << 8 | (inner[1] & 0xFF)
+    if name == "LT" and len(args) == 2 and inner[1] is not None:
+        return QK_LAYER_TAP | (int(args[0], 0) & 0xF) << 8 | (inner[1] & 0xFF)
+    if name == "MO" and len(args) == 1:
+        return QK_MOMENTARY | (int(args[0], 0) & 0x1F)
+    if name == "TD" and len(args) == 1:
+        return QK_TAP_DANCE | (inner[0] if inner[0] is not None else 0) & 0xFF
+    return None
+
+
+def mods_of(expression):
+    """Mod bits of an expression such as `MOD_LCTL | MOD_LSFT`."""
+    bits = 0
+    for term in expression.split("|"):
+        if term.strip() not in MOD_BITS:
+            return None
+        bits |= MOD_BITS[term.strip()]
+    return bits
+
+
+def is_mod_tap(v):
+    return v is not None and v & 0xE000 == QK_MOD_TAP
+
+
+def is_layer_tap(v):
+    return v is not None and v & 0xF000 == QK_LAYER_TAP
+
+
+def tap_keycode(v):
+    """The keycode a tap of `v` sends: the tap of a mod-tap or layer-tap,
+    else `v` itself."""
+    return v & 0xFF if is_mod_tap(v) or is_layer_tap(v) else v
+
+
+def held_layer(v):
+    """The layer holding `v` activates, or None."""
+    if is_layer_tap(v):
+        return (v >> 8) & 0xF
+    if v is not None and v & 0xFFE0 == QK_MOMENTARY:
+        return v & 0x1F
+    return None
+
+
+def held_mods(v):
+    """The mods holding `v` applies, or 0."""
+    if is_mod_tap(v):
+        return (v >> 8) & 0x1F
+    if v is not None and 0xE0 <= v <= 0xE7:
+        return (1 << (v - 0xE0)) if v < 0xE4 else 0x10 | (1 << (v - 0xE4))
+    return 0
+
+
+def char_of(v, shift=False):
+    """The character a tap of `v` types, with Shift held by another key if
+    `shift`, or None."""
+    if v is None:
+        return None
+    v = tap_keycode(v)
+    mods = (v >> 8) & 0x1F
+    chars = _CHARS_BY_VALUE.get(v & 0xFF)
+    if chars is None or mods & ~0x12:  # Only Shift may wrap it
+        return None
+    return chars[1] if mods or shift else chars[0]
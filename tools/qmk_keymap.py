@@ -0,0 +1,204 @@
+"""Minimal reader for the Oryx-generated keymap.c files in this repository.
+
+Only understands what Oryx emits: `#define` aliases and arrays filled with
+LAYOUT macros, such as `keymaps` and `chordal_hold_layout`. Good enough for
+the generators in this directory; not a C parser. QMK keymap.json files are
+read too, for layouts kept in that form.
+"""
+
+import json
+import re
+from pathlib import Path
+
+TRANSPARENT = {"KC_TRANSPARENT", "KC_TRNS", "_______"}
+
+_COMMENT = re.compile(r"//[^\n]*|/\*.*?\*/", re.S)
+_DEFINE = re.compile(r"^\s*#define\s+(\w+)\s+(.+?)\s*$", re.M)
+_LAYER = re.compile(r"\[\s*(\w+)\s*\]\s*=\s*(LAYOUT\w*)\s*\(")
+
+
+def normalize(keycode):
+    """Canonical spelling of a keycode expression: no whitespace."""
+    return re.sub(r"\s+", "", keycode)
+
+
+def split_args(text):
+    """Splits `text` on the commas that are not nested in parentheses."""
+    args, depth, start = [], 0, 0
+    for i, c in enumerate(text):
+        if c in "([{":
+            depth += 1
+        elif c in ")]}":
+            depth -= 1
+        elif c == "," and depth == 0:
+            args.append(text[start:i].strip())
+            start = i + 1
+    last = text[start:].strip()
+    if last:
+        args.append(last)
+    return args
+
+
+def _call_args(text, open_paren):
+    """Returns the text between the parenthesis at `open_paren` and its match."""
+    depth = 0
+    for i in range(open_paren, len(text)):
+        if text[i] == "(":
+            depth += 1
+        elif text[i] == ")":
+            depth -= 1
+            if depth == 0:
+                return text[open_paren + 1 : i], i
+    raise ValueError("unbalanced parentheses")
+
+
+def _initializer(text, name):
+    """Returns the initializer of the array `name`, without its braces."""
+    m = re.search(r"\b%s\s*(\[[^=]*\])*[^=;]*=\s*" % re.escape(name), text)
+    if not m:
+        raise KeyError(name)
+    start = m.end()
+    if text[start] == "{":
+        depth = 0
+        for i in range(start, len(text)):
+            if text[i] == "{":
+                depth += 1
+            elif text[i] == "}":
+                depth -= 1
+                if depth == 0:
+                    return text[start + 1 : i]
+        raise ValueError("unbalanced braces in %s" % name)
+    return text[start : text.index(";", start)]
+
+
+class Keymap:
+    """The parts of a keymap.c the generators need."""
+
+    def __init__(self, path):
+        self.path = Path(path)
+        self.source = _COMMENT.sub("", self.path.read_text())
+        self.defines = {m.group(1): m.group(2) for m in _DEFINE.finditer(self.source)}
+        self.layout_macro, self.layers = self._layers()
+
+    def _layers(self):
+        body = _initializer(self.source, "keymaps")
+        layers, macro = [], None
+        for m in _LAYER.finditer(body):
+            index = int(m.group(1), 0)
+            args, _ = _call_args(body, m.end() - 1)
+            macro = m.group(2)
+            while len(layers) <= index:
+                layers.append(None)
+            layers[index] = [normalize(a) for a in split_args(args)]
+        if not layers or None in layers:
+            raise ValueError("%s: could not read keymaps" % self.path)
+        return macro, layers
+
+    @property
+    def key_count(self):
+        return len(self.layers[0])
+
+    def expand(self, keycode):
+        """Expands `#define` aliases such as DUAL_FUNC_1."""
+        seen = set()
+        while keycode in self.defines and keycode not in seen:
+            seen.add(keycode)
+            keycode = normalize(self.defines[keycode])
+        return keycode
+
+    @classmethod
+    def from_json(cls, path):
+        """Reads a QMK keymap.json: `layout` and `layers` only."""
+        keymap = cls.__new__(cls)
+        keymap.path = Path(path)
+        data = json.loads(keymap.path.read_text())
+        keymap.source, keymap.defines = "", {}
+        keymap.layout_macro = data["layout"]
+        keymap.layers = [[normalize(k) for k in layer] for layer in data["layers"]]
+        if not keymap.layers:
+            raise ValueError("%s: no layers" % path)
+        return keymap
+
+    def is_transparent(self, keycode):
+        return self.expand(keycode) in TRANSPARENT
+
+    def layout_array(self, name):
+        """Reads an array initialized with a single LAYOUT macro, e.g.
+        chordal_hold_layout, in LAYOUT argument order."""
+        init = _initializer(self.source, name)
+        m = re.search(r"LAYOUT\w*\s*\(", init)
+        if not m:
+            raise KeyError(name)
+        args, _ = _call_args(init, m.end() - 1)
+        return split_args(args)
+
+    def ledmap(self, name="ledmap"):
+        """Reads Oryx's ledmap: {layer: [(h, s, v), ...]}, one entry per LED,
+        for the layers it lists."""
+        init = _initializer(self.source, name)
+        layers = {}
+        for m in re.finditer(r"\[\s*(\w+)\s*\]\s*=\s*\{((?:\s*\{[^{}]*\}\s*,?)*)\s*\}", init):
+            layers[int(m.group(1), 0)] = [
+                tuple(int(v, 0) for v in split_args(c))
+                for c in re.findall(r"\{([^{}]*)\}", m.group(2))
+            ]
+        if not layers:
+            raise ValueError("%s: could not read %s" % (self.path, name))
+        return layers
+
+
+def load(layout_dir):
+    """The keymap of a layout directory: keymap.c, else keymap.json."""
+    layout_dir = Path(layout_dir)
+    if (layout_dir / "keymap.c").exists():
+        return Keymap(layout_dir / "keymap.c")
+    return Keymap.from_json(layout_dir / "keymap.json")
+
+
+def format_layout(macro, values, row_lengths, indent="    ", width=4):
+    """Formats `values` as a call to the LAYOUT macro `macro`, one physical
+    row per line."""
+    lines, i = [], 0
+    for n in row_lengths:
+        row = values[i : i + n]
+        lines.append(indent + " ".join(("%s," % v).ljust(width) for v in row))
+        i += n
+    lines[-1] = lines[-1].rstrip().rstrip(",")
+    return "%s(\n%s\n%s)" % (macro, "\n".join(l.rstrip() for l in lines), indent[:-2])
+
+
+# Keys per physical row for the layouts in this repository.
+ROW_LENGTHS = {
+    52: [12, 12, 12, 12, 4],  # ZSA Voyager
+}
+
+
+def _voyager_matrix():
+    positions = []
+    for row in range(4):
+        positions += [(row, col) for col in range(1, 7)]
+        positions += [(row + 6, col) for col in range(0, 6)]
+    return positions + [(4, 4), (5, 0), (11, 6), (10, 2)]
+
+
+# (row, col) in the matrix of each key, in LAYOUT order, as in the
+# keyboard's info.json; for tools that need positions without the C
+# preprocessor.
+MATRIX = {
+    "LAYOUT_voyager": _voyager_matrix(),
+}
+
+
+def _voyager_leds():
+    leds = []
+    for row in range(4):
+        leds += [row * 6 + col for col in range(6)]
+        leds += [26 + row * 6 + col for col in range(6)]
+    return leds + [24, 25, 50, 51]
+
+
+# RGB matrix LED index of each key, in LAYOUT order, as in the keyboard's
+# g_led_config: the left half's rows then its thumbs, then the right half's.
+LEDS = {
+    "LAYOUT_voyager": _voyager_leds(),
+}
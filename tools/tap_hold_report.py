@@ -0,0 +1,210 @@
+#!/usr/bin/env python3
+"""Compares the tap-hold behavior of layouts over the same typing.
+
+Types the corpus on every layout with gen_traces.py, noting which mod-tap
+and layer-tap presses were meant as taps and which as holds, and replays
+each trace through W7EL4/host/report: QMK's tap-hold decision as the layout
+configures it (per-key TAPPING_TERM, PERMISSIVE_HOLD, FLOW_TAP_TERM,
+QUICK_TAP_TERM, CHORDAL_HOLD) followed by the real achordion.c, for layouts
+that build it. Prints the added latency of key presses, the presses that
+settled the other way than meant, and the worst stalls, one column per
+layout.
+
+Per-key timing comes from each layout's key_timing.json, on the base layer;
+CHORDAL_HOLD hands from its chordal_hold_layout. Chord exceptions are not
+applied, so Achordion is compared on hands alone.
+
+Usage: tap_hold_report.py CORPUS... [--layouts DIR...] [--wpm WPM] [--seed N]
+"""
+
+import argparse
+import concurrent.futures
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+import qmk_keycodes as kc  # noqa: E402
+from gen_key_timing import resolve  # noqa: E402
+from qmk_keymap import MATRIX, load  # noqa: E402
+
+ROOT = Path(__file__).resolve().parent.parent
+HOST = ROOT / "W7EL4" / "host"
+
+QMK_TAPPING_TERM = 200
+# Values of the names key_timing.json expressions use, as achordion.h has
+# them
+NAMES = {
+    "ACHORDION_STREAK_TIMEOUT": 100,
+    "ACHORDION_SETTLE_ON_PRESS": 0,
+    "ACHORDION_SETTLE_ON_RELEASE": 1,
+}
+# Timing fields in host/report's order, and their values when a layout's
+# key_timing.json leaves them out
+FIELDS = [
+    ("tapping_term", "TAPPING_TERM"),
+    ("achordion_timeout", "1000"),
+    ("achordion_streak_timeout", "ACHORDION_STREAK_TIMEOUT"),
+    ("achordion_settle_policy", "ACHORDION_SETTLE_ON_PRESS"),
+]
+
+_DEFINE = re.compile(r"^\s*#define\s+(\w+)(?:\s+(.*?))?\s*$", re.M)
+_NAME = re.compile(r"[A-Za-z_]\w*")
+
+
+def evaluate(expression, names):
+    """Value of an integer C expression over `names`."""
+    python = _NAME.sub(lambda m: str(names[m.group(0)]), str(expression))
+    return int(eval(python.replace("/", "//"), {"__builtins__": {}}))
+
+
+def describe(layout_dir, overrides=None, timeouts=None):
+    """host/report's CONFIG for a layout directory, and whether it builds
+    Achordion. `overrides` replaces config.h defines, such as TAPPING_TERM,
+    with numbers; `timeouts` the Achordion timeout of keys, by LAYOUT index.
+    """
+    defines = {
+        m.group(1): m.group(2) or ""
+        for m in _DEFINE.finditer((layout_dir / "config.h").read_text())
+    }
+    defines.update((name, str(value)) for name, value in (overrides or {}).items())
+    names = dict(NAMES)
+    names["TAPPING_TERM"] = evaluate(defines.get("TAPPING_TERM", QMK_TAPPING_TERM), names)
+    achordion = re.search(r"^\s*SRC\s*\+=.*\bachordion\.c\b",
+                          (layout_dir / "rules.mk").read_text(), re.M) is not None
+
+    keymap = load(layout_dir)
+    matrix = MATRIX[keymap.layout_macro]
+    spec = json.loads((layout_dir / "key_timing.json").read_text())
+    fields, profiles, _, table = resolve(spec, keymap)
+
+    def timing(profile):
+        values = dict(zip(fields, profiles[profile]))
+        return [evaluate(values.get(f, default), names) for f, default in FIELDS]
+
+    try:
+        hands = [h.strip("'") for h in keymap.layout_array("chordal_hold_layout")]
+    except KeyError:
+        # QMK's default for a split keyboard: by half of the matrix
+        rows = max(r for r, _ in matrix) + 1
+        hands = ["L" if r < rows // 2 else "R" for r, _ in matrix]
+
+    lines = [
+        "# %s" % layout_dir.name,
+        "achordion %d" % achordion,
+        "permissive_hold %d" % ("PERMISSIVE_HOLD" in defines),
+        "chordal_hold %d" % ("CHORDAL_HOLD" in defines),
+        "flow_tap_term %d" % evaluate(defines.get("FLOW_TAP_TERM", "0"), names),
+        "quick_tap_term %d" % evaluate(defines.get("QUICK_TAP_TERM", "TAPPING_TERM"), names),
+        "default %d %d %d %d" % tuple(timing(0)),
+    ]
+    for i, (row, col) in enumerate(matrix):
+        keycode = kc.value(keymap.expand(keymap.layers[0][i])) or 0
+        values = timing(table[0][i])
+        if timeouts and i in timeouts:
+            values[1] = timeouts[i]
+        lines.append("key %d %d %s 0x%04X %d %d %d %d"
+                     % ((row, col, hands[i] if hands[i] in "LR" else "*", keycode)
+                        + tuple(values)))
+    return "\n".join(lines) + "\n", achordion
+
+
+def generate_trace(layout_dir, corpus, path, wpm, seed, jobs):
+    """Types `corpus` on the layout into an annotated text trace."""
+    subprocess.run(
+        [sys.executable, str(Path(__file__).resolve().parent / "gen_traces.py"),
+         str(layout_dir), *corpus, "-o", str(path), "--annotate",
+         "--wpm", str(wpm), "--seed", str(seed), "--jobs", str(jobs)],
+        check=True, stderr=subprocess.DEVNULL,
+    )
+
+
+def run_report(config, traces):
+    """Runs host/report with `config` over each trace; returns the metrics,
+    as strings, of each."""
+    with tempfile.NamedTemporaryFile("w", suffix=".config") as file:
+        file.write(config)
+        file.flush()
+        results = []
+        for trace in traces:
+            out = subprocess.run(
+                [str(HOST / "report"), "-c", file.name, str(trace)],
+                check=True, capture_output=True, text=True,
+            ).stdout
+            metrics = {"stalls": []}
+            for line in out.splitlines():
+                name, _, value = line.partition(" ")
+                if name == "stall":
+                    metrics["stalls"].append(value)
+                else:
+                    metrics[name] = value
+            results.append(metrics)
+    return results
+
+
+def run_layout(layout_dir, corpus, args, workdir, jobs):
+    """Generates the layout's trace and reports on it; returns its metrics."""
+    config, achordion = describe(layout_dir)
+    trace_path = workdir / ("%s.trace" % layout_dir.name)
+    generate_trace(layout_dir, corpus, trace_path, args.wpm, args.seed, jobs)
+    metrics = run_report(config, [trace_path])[0]
+    metrics["achordion"] = "yes" if achordion else "no"
+    return metrics
+
+
+ROWS = [
+    ("Achordion", "achordion"),
+    ("Keystrokes", "keystrokes"),
+    ("Latency mean, ms", "latency_mean"),
+    ("Latency p50, ms", "latency_p50"),
+    ("Latency p90, ms", "latency_p90"),
+    ("Latency p99, ms", "latency_p99"),
+    ("Latency max, ms", "latency_max"),
+    ("Tap-hold presses", "tap_hold_presses"),
+    ("Misfired holds", "misfired_holds"),
+    ("Misfired taps", "misfired_taps"),
+]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("corpus", nargs="+", help="text files to type")
+    parser.add_argument("--layouts", nargs="+", type=Path,
+                        default=sorted(p.parent for p in ROOT.glob("*/config.h")),
+                        help="layout directories, all of them by default")
+    parser.add_argument("--wpm", type=float, default=70, help="typing speed, words per minute")
+    parser.add_argument("--seed", type=int, default=1, help="random seed")
+    args = parser.parse_args()
+
+    subprocess.run(["make", "-s", "-C", str(HOST), "report"], check=True)
+    jobs = max(1, (os.cpu_count() or 1) // len(args.layouts))
+    with tempfile.TemporaryDirectory() as workdir, \
+            concurrent.futures.ThreadPoolExecutor(len(args.layouts)) as pool:
+        futures = [
+            pool.submit(run_layout, layout, args.corpus, args, Path(workdir), jobs)
+            for layout in args.layouts
+        ]
+        try:
+            results = [f.result() for f in futures]
+        except (subprocess.CalledProcessError, OSError, KeyError, ValueError) as e:
+            sys.exit("tap_hold_report: %s" % e)
+
+    names = [layout.name for layout in args.layouts]
+    width = max(len(label) for label, _ in ROWS) + 2
+    column = max(10, max(len(n) for n in names) + 2)
+    print("".ljust(width) + "".join(n.rjust(column) for n in names))
+    for label, key in ROWS:
+        print(label.ljust(width) + "".join(r.get(key, "-").rjust(column) for r in results))
+    print()
+    print("Worst stalls, added latency of a key press:")
+    for name, result in zip(names, results):
+        for stall in result["stalls"]:
+            print("  %s: %s" % (name, stall))
+
+
+if __name__ == "__main__":
+    main()
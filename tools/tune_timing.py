@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""Searches a layout's tap-hold timing for the least misfires and latency.
+
+Replays annotated traces (gen_traces.py --annotate, or captures noted by
+hand) through W7EL4/host/report for every candidate timing, in one process
+per core, and scores each on
+
+    added latency of key presses, ms + MISFIRE_COST * misfires
+
+where a misfire is a tap-hold press that settled the other way than its
+note says. The search is a grid over TAPPING_TERM, FLOW_TAP_TERM and
+QUICK_TAP_TERM, then, for layouts that build Achordion, one pass of
+coordinate descent over the achordion_timeout of each tap-hold key on the
+base layer. Per-key tapping terms keep their offsets from TAPPING_TERM in
+key_timing.json.
+
+Prints the recommended config.h block and the `keys` of key_timing.json
+with the tuned timeouts merged in. DEBOUNCE is reported as is: traces are
+recorded after debouncing, so they cannot tell what it filters out.
+
+Usage: tune_timing.py LAYOUT_DIR [--corpus FILE...] [--traces TRACE...]
+                      [--misfire-cost MS] [--jobs N] [--wpm WPM] [--seed N]
+"""
+
+import argparse
+import json
+import multiprocessing
+import os
+import re
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+import qmk_keycodes as kc  # noqa: E402
+from qmk_keymap import load  # noqa: E402
+from tap_hold_report import HOST, describe, generate_trace, run_report  # noqa: E402
+
+TAPPING_TERMS = range(120, 321, 20)
+FLOW_TAP_TERMS = [0, 50, 75, 100, 125, 150]
+QUICK_TAP_FRACTIONS = [0, 0.5, 1]  # Of TAPPING_TERM, which caps it
+ACHORDION_TIMEOUTS = [200, 300, 400, 500, 700, 1000]
+
+
+def score(results, misfire_cost):
+    """Total cost and the numbers behind it, over every trace."""
+    keystrokes = latency = misfires = 0
+    for r in results:
+        keystrokes += int(r["keystrokes"])
+        latency += float(r["latency_mean"]) * int(r["keystrokes"])
+        misfires += int(r["misfired_holds"]) + int(r["misfired_taps"])
+    return latency + misfire_cost * misfires, keystrokes, latency, misfires
+
+
+def evaluate(task):
+    """Worker: scores one candidate."""
+    layout_dir, overrides, timeouts, traces, misfire_cost = task
+    config, _ = describe(layout_dir, overrides, timeouts)
+    return score(run_report(config, traces), misfire_cost)
+
+
+def grid():
+    for tt in TAPPING_TERMS:
+        for ftt in FLOW_TAP_TERMS:
+            for fraction in QUICK_TAP_FRACTIONS:
+                yield {"TAPPING_TERM": tt, "FLOW_TAP_TERM": ftt,
+                       "QUICK_TAP_TERM": int(tt * fraction)}
+
+
+def summary(name, result):
+    cost, keystrokes, latency, misfires = result
+    return "%s: %.1f ms added per keystroke, %d misfires, cost %.0f" % (
+        name, latency / max(keystrokes, 1), misfires, cost)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("layout", type=Path, help="layout directory")
+    parser.add_argument("--corpus", nargs="+", default=[], help="text files to type into traces")
+    parser.add_argument("--traces", nargs="+", default=[], help="annotated text traces")
+    parser.add_argument("--misfire-cost", type=float, default=500,
+                        help="ms of added latency one misfire is worth")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count(), help="worker processes")
+    parser.add_argument("--wpm", type=float, default=70, help="typing speed of --corpus")
+    parser.add_argument("--seed", type=int, default=1, help="random seed of --corpus")
+    args = parser.parse_args()
+    if not args.corpus and not args.traces:
+        parser.error("give a --corpus or --traces")
+
+    subprocess.run(["make", "-s", "-C", str(HOST), "report"], check=True)
+    with tempfile.TemporaryDirectory() as workdir, multiprocessing.Pool(args.jobs) as pool:
+        traces = list(args.traces)
+        if args.corpus:
+            traces.append(Path(workdir) / "corpus.trace")
+            generate_trace(args.layout, args.corpus, traces[-1], args.wpm, args.seed, args.jobs)
+
+        def run(candidates):
+            return pool.map(evaluate, [
+                (args.layout, overrides, timeouts, traces, args.misfire_cost)
+                for overrides, timeouts in candidates
+            ])
+
+        try:
+            _, achordion = describe(args.layout)
+            current = run([({}, {})])[0]
+            candidates = list(grid())
+            results = run((c, {}) for c in candidates)
+            best = min(range(len(candidates)), key=lambda i: results[i][0])
+            overrides, best_result = candidates[best], results[best]
+
+            timeouts = {}
+            if achordion:
+                keymap = load(args.layout)
+                tap_hold = [i for i, k in enumerate(keymap.layers[0])
+                            if kc.is_mod_tap(kc.value(keymap.expand(k)))
+                            or kc.is_layer_tap(kc.value(keymap.expand(k)))]
+                tries = [(i, t) for i in tap_hold for t in ACHORDION_TIMEOUTS]
+                results = run((overrides, {i: t}) for i, t in tries)
+                for (i, t), result in zip(tries, results):
+                    if result[0] < best_result[0] and (
+                            i not in timeouts or result[0] < timeouts[i][1]):
+                        timeouts[i] = (t, result[0])
+                timeouts = {i: t for i, (t, _) in timeouts.items()}
+                if timeouts:
+                    combined = run([(overrides, timeouts)])[0]
+                    if combined[0] < best_result[0]:
+                        best_result = combined
+                    else:
+                        timeouts = {}
+        except (subprocess.CalledProcessError, OSError, KeyError, ValueError) as e:
+            sys.exit("tune_timing: %s" % e)
+
+    print(summary("// Current", current))
+    print(summary("// Tuned", best_result))
+    print("// Recommended for %s by tools/tune_timing.py" % args.layout.name)
+    for name, value in overrides.items():
+        if name == "FLOW_TAP_TERM" and value == 0:
+            print("// FLOW_TAP_TERM: off")
+        else:
+            print("#define %s %d" % (name, value))
+    debounce = re.search(r"^\s*#define\s+DEBOUNCE\s+(\S+)",
+                         (args.layout / "config.h").read_text(), re.M)
+    print("// DEBOUNCE %s: kept, traces are recorded after debouncing"
+          % (debounce.group(1) if debounce else "default"))
+
+    if timeouts:
+        spec = json.loads((args.layout / "key_timing.json").read_text())
+        keys = spec.get("keys", {})
+        for i, timeout in sorted(timeouts.items()):
+            keys.setdefault(keymap.layers[0][i], {})["achordion_timeout"] = timeout
+        print()
+        print("key_timing.json keys:")
+        print(json.dumps(keys, indent=2))
+
+
+if __name__ == "__main__":
+    main()